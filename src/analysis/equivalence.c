@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../rpn_evaluator/word_evaluation.h"
+#include "../table_builders_for_webpage/table_builders.h"
+#include "../utils/parallel_scan.h"
+
+#include "equivalence.h"
+
+/**
+ * Context of the scanning threads, the two expressions compiled over the same variables
+ */
+typedef struct
+{
+    const compiled_expression *first;
+    const compiled_expression *second;
+} equivalence_context;
+
+static uint64_t difference_scanner(const void *context, int64_t word_index, uint64_t *scratch)
+{
+    const equivalence_context *expressions = (const equivalence_context *)context;
+    uint64_t first = evaluate_word(expressions->first, word_index, scratch);
+    uint64_t second = evaluate_word(expressions->second, word_index, scratch);
+    return first ^ second;
+}
+
+equivalence_result *check_equivalence(const char *first_expression, const char *second_expression)
+{
+    // Compile each expression on its own first to find the variables it uses
+    compiled_expression *first_alone = compile_expression(first_expression, NULL);
+    compiled_expression *second_alone = compile_expression(second_expression, NULL);
+    if (first_alone == NULL || second_alone == NULL)
+    {
+        fprintf(stderr, "Invalid expression in %s at line %d\n", __FILE__, __LINE__);
+        free_compiled_expression(first_alone);
+        free_compiled_expression(second_alone);
+        return (equivalence_result *)NULL;
+    }
+
+    equivalence_result *result = (equivalence_result *)calloc(1, sizeof(equivalence_result));
+    if (result == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for equivalence result in %s at line %d\n", __FILE__, __LINE__);
+        free_compiled_expression(first_alone);
+        free_compiled_expression(second_alone);
+        return (equivalence_result *)NULL;
+    }
+
+    // Unify the variables, keeping the first expression's columns in front
+    int number_of_variables = first_alone->number_of_variables;
+    memcpy(result->variables, first_alone->variables, number_of_variables);
+    for (int i = 0; i < second_alone->number_of_variables; i++)
+    {
+        if (strchr(result->variables, second_alone->variables[i]) == NULL)
+        {
+            result->variables[number_of_variables++] = second_alone->variables[i];
+        }
+    }
+    result->variables[number_of_variables] = '\0';
+    free_compiled_expression(first_alone);
+    free_compiled_expression(second_alone);
+
+    compiled_expression *first = compile_expression(first_expression, result->variables);
+    compiled_expression *second = compile_expression(second_expression, result->variables);
+    if (first == NULL || second == NULL)
+    {
+        fprintf(stderr, "Failed to compile expressions over unified variables in %s at line %d\n", __FILE__, __LINE__);
+        free_compiled_expression(first);
+        free_compiled_expression(second);
+        free(result);
+        return (equivalence_result *)NULL;
+    }
+
+    equivalence_context context = {first, second};
+    int scratch_size = first->scratch_words > second->scratch_words ? first->scratch_words : second->scratch_words;
+    result->first_difference = parallel_find_first_row(number_of_variables, difference_scanner, &context, scratch_size);
+    result->equivalent = (result->first_difference == -1);
+
+    free_compiled_expression(first);
+    free_compiled_expression(second);
+    if (result->first_difference < -1)
+    {
+        free(result);
+        return (equivalence_result *)NULL;
+    }
+    return result;
+}
+
+int64_t project_row(int64_t row, const char *unified_variables, const char *variables)
+{
+    int unified_count = strlen(unified_variables);
+    int count = strlen(variables);
+    int64_t projected = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const char *column = strchr(unified_variables, variables[i]);
+        if (column == NULL)
+        {
+            return -1;
+        }
+        int64_t bit = (row >> (unified_count - 1 - (column - unified_variables))) & 1;
+        projected |= bit << (count - 1 - i);
+    }
+    return projected;
+}
+
+/**
+ * Generates the header, separator and the row of the table of an expression matching a unified row
+ */
+static char *expression_table_row(const char *expression, int64_t unified_row, const char *unified_variables)
+{
+    compiled_expression *compiled = compile_expression(expression, NULL);
+    if (compiled == NULL)
+    {
+        return (char *)NULL;
+    }
+    int64_t row_number = project_row(unified_row, unified_variables, compiled->variables);
+    free_compiled_expression(compiled);
+    if (row_number < 0)
+    {
+        return (char *)NULL;
+    }
+    return generate_single_row_table(expression, row_number);
+}
+
+char *generate_counterexample(const char *first_expression, const char *second_expression, const equivalence_result *result)
+{
+    if (result == NULL || result->equivalent)
+    {
+        return (char *)NULL;
+    }
+
+    char *first_row = expression_table_row(first_expression, result->first_difference, result->variables);
+    char *second_row = expression_table_row(second_expression, result->first_difference, result->variables);
+    if (first_row == NULL || second_row == NULL)
+    {
+        fprintf(stderr, "Failed to generate counterexample rows in %s at line %d\n", __FILE__, __LINE__);
+        free(first_row);
+        free(second_row);
+        return (char *)NULL;
+    }
+
+    int length = strlen(first_row) + strlen(second_row);
+    char *counterexample = (char *)malloc(length + 1);
+    if (counterexample == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for counterexample in %s at line %d\n", __FILE__, __LINE__);
+    }
+    else
+    {
+        snprintf(counterexample, length + 1, "%s%s", first_row, second_row);
+    }
+    free(first_row);
+    free(second_row);
+    return counterexample;
+}
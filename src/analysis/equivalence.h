@@ -0,0 +1,47 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Result of comparing two expressions
+ */
+typedef struct
+{
+    bool equivalent;
+    int64_t first_difference; // First row where the expressions differ, -1 when equivalent
+    char variables[27];       // Union of the variables of both expressions, in column order
+} equivalence_result;
+
+/**
+ * Function to check whether two expressions (each either infix or postfix) have the same truth table.
+ * The variables of both expressions are unified, the first expression's variables first followed by
+ * the ones only the second expression uses, and both tables are compared 64 rows at a time by parallel
+ * threads which stop at the first differing row.
+ * Caller is responsible for freeing the result.
+ * @param first_expression The first expression being compared
+ * @param second_expression The second expression being compared
+ * @return The result of the comparison, or NULL if either expression is invalid
+ */
+equivalence_result *check_equivalence(const char *first_expression, const char *second_expression);
+
+/**
+ * Function to generate a counterexample for two expressions that are not equivalent.
+ * For each expression it contains its header, separator and the row of its own table
+ * matching the unified row where the expressions differ.
+ * Caller is responsible for freeing the memory allocated for the counterexample.
+ * @param first_expression The first expression that was compared
+ * @param second_expression The second expression that was compared
+ * @param result The result of check_equivalence for the two expressions
+ * @return The counterexample, or NULL if the expressions are equivalent or it can't be generated
+ */
+char *generate_counterexample(const char *first_expression, const char *second_expression, const equivalence_result *result);
+
+/**
+ * Function to map a row of a table over unified variables onto the matching row of a table
+ * over a subset of those variables.
+ * @param row The row in the table over the unified variables
+ * @param unified_variables The unified variables in column order
+ * @param variables The variables of the smaller table in column order
+ * @return The row of the smaller table with the same variable values, or -1 if a variable is missing
+ */
+int64_t project_row(int64_t row, const char *unified_variables, const char *variables);
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../utils/parallel_scan.h"
+
+#include "sampling.h"
+
+// Number of words whose true rows are counted together, a sample evaluates at most this many words
+#define SAMPLE_BLOCK_WORDS 64
+// Smallest number of blocks worth handing to a thread
+#define SAMPLE_GRAIN 64
+
+/**
+ * Context shared by the threads counting the true rows of each block
+ */
+typedef struct
+{
+    const compiled_expression *compiled;
+    int64_t number_of_words;
+    uint64_t mask;
+    int64_t *block_counts;
+} count_context;
+
+/**
+ * Next number of a splitmix64 generator
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Uniform number in [0, bound), rejecting the draws that would favour the low numbers
+ */
+static int64_t random_below(uint64_t *state, int64_t bound)
+{
+    uint64_t limit = UINT64_MAX - UINT64_MAX % (uint64_t)bound;
+    uint64_t draw;
+    do
+    {
+        draw = next_random(state);
+    } while (draw >= limit);
+    return draw % (uint64_t)bound;
+}
+
+int64_t *sample_rows(int number_of_variables, int number_of_samples, uint64_t seed)
+{
+    int64_t *rows = (int64_t *)malloc((number_of_samples + 1) * sizeof(int64_t));
+    if (rows == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for samples in %s at line %d\n", __FILE__, __LINE__);
+        return (int64_t *)NULL;
+    }
+    uint64_t state = seed;
+    for (int i = 0; i < number_of_samples; i++)
+    {
+        rows[i] = random_below(&state, (int64_t)1 << number_of_variables);
+    }
+    return rows;
+}
+
+static void count_task(void *arg, int64_t start, int64_t end)
+{
+    count_context *context = (count_context *)arg;
+    uint64_t *stack = (uint64_t *)malloc((context->compiled->scratch_words + 1) * sizeof(uint64_t));
+    if (stack == NULL)
+    {
+        fprintf(stderr, "Failed to allocate evaluation stack in %s at line %d\n", __FILE__, __LINE__);
+        exit(EXIT_FAILURE);
+    }
+    for (int64_t block = start; block < end; block++)
+    {
+        int64_t count = 0;
+        int64_t last_word = (block + 1) * SAMPLE_BLOCK_WORDS;
+        for (int64_t word = block * SAMPLE_BLOCK_WORDS; word < last_word && word < context->number_of_words; word++)
+        {
+            count += __builtin_popcountll(evaluate_word(context->compiled, word, stack) & context->mask);
+        }
+        context->block_counts[block] = count;
+    }
+    free(stack);
+}
+
+/**
+ * Finds the row of the true row of rank rank in a block, rank counting from the first true row of the block
+ */
+static int64_t select_in_block(const compiled_expression *compiled, int64_t block, int64_t rank, uint64_t mask, uint64_t *stack)
+{
+    for (int64_t word = block * SAMPLE_BLOCK_WORDS;; word++)
+    {
+        uint64_t true_rows = evaluate_word(compiled, word, stack) & mask;
+        int count = __builtin_popcountll(true_rows);
+        if (rank < count)
+        {
+            for (; rank > 0; rank--)
+            {
+                true_rows &= true_rows - 1;
+            }
+            return word * 64 + __builtin_ctzll(true_rows);
+        }
+        rank -= count;
+    }
+}
+
+int64_t *sample_true_rows(const compiled_expression *compiled, int number_of_samples, uint64_t seed, int64_t *number_of_true_rows)
+{
+    int64_t words = number_of_words(compiled->number_of_variables);
+    int64_t number_of_blocks = (words + SAMPLE_BLOCK_WORDS - 1) / SAMPLE_BLOCK_WORDS;
+    int64_t *rows = (int64_t *)malloc((number_of_samples + 1) * sizeof(int64_t));
+    // Turned into the number of true rows before each block, plus the total
+    int64_t *block_counts = (int64_t *)malloc((number_of_blocks + 1) * sizeof(int64_t));
+    uint64_t *stack = (uint64_t *)malloc((compiled->scratch_words + 1) * sizeof(uint64_t));
+    if (rows == NULL || block_counts == NULL || stack == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for samples in %s at line %d\n", __FILE__, __LINE__);
+        free(rows);
+        free(block_counts);
+        free(stack);
+        return (int64_t *)NULL;
+    }
+
+    count_context context = {compiled, words, valid_rows_mask(compiled->number_of_variables), block_counts};
+    parallel_for_range(number_of_blocks, SAMPLE_GRAIN, count_task, &context);
+    int64_t total = 0;
+    for (int64_t block = 0; block < number_of_blocks; block++)
+    {
+        int64_t count = block_counts[block];
+        block_counts[block] = total;
+        total += count;
+    }
+    block_counts[number_of_blocks] = total;
+    *number_of_true_rows = total;
+
+    uint64_t state = seed;
+    for (int i = 0; i < number_of_samples && total > 0; i++)
+    {
+        int64_t rank = random_below(&state, total);
+        // Last block starting at or before the rank
+        int64_t low = 0;
+        int64_t high = number_of_blocks - 1;
+        while (low < high)
+        {
+            int64_t middle = (low + high + 1) / 2;
+            if (block_counts[middle] <= rank)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle - 1;
+            }
+        }
+        rows[i] = select_in_block(compiled, low, rank - block_counts[low], context.mask, stack);
+    }
+    free(block_counts);
+    free(stack);
+    return rows;
+}
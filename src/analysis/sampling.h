@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+
+#include "../rpn_evaluator/word_evaluation.h"
+
+/**
+ * Function to draw rows of a truth table uniformly at random, each row independently of the others
+ * so the same row can be drawn more than once.
+ * Caller is responsible for freeing the rows.
+ * @param number_of_variables The number of variables of the table
+ * @param number_of_samples The number of rows to draw
+ * @param seed The seed of the random generator, the same seed drawing the same rows
+ * @return The rows drawn, or NULL on allocation failure
+ */
+int64_t *sample_rows(int number_of_variables, int number_of_samples, uint64_t seed);
+
+/**
+ * Function to draw true rows (satisfying assignments) of an expression uniformly at random, each
+ * independently of the others. The true rows of each block of the table are counted by parallel
+ * threads, then every sample picks a rank among all true rows and only evaluates the words of the
+ * block holding it, so no row of the table is ever formatted.
+ * Caller is responsible for freeing the rows.
+ * @param compiled The compiled expression
+ * @param number_of_samples The number of rows to draw
+ * @param seed The seed of the random generator, the same seed drawing the same rows
+ * @param number_of_true_rows Receives the number of true rows of the table, no row is drawn when it is 0
+ * @return The rows drawn, or NULL on allocation failure
+ */
+int64_t *sample_true_rows(const compiled_expression *compiled, int number_of_samples, uint64_t seed, int64_t *number_of_true_rows);
@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../rpn_evaluator/word_evaluation.h"
+#include "../utils/parallel_scan.h"
+
+#include "satisfiability.h"
+
+static uint64_t true_rows_scanner(const void *context, int64_t word_index, uint64_t *scratch)
+{
+    return evaluate_word((const compiled_expression *)context, word_index, scratch);
+}
+
+static uint64_t false_rows_scanner(const void *context, int64_t word_index, uint64_t *scratch)
+{
+    return ~evaluate_word((const compiled_expression *)context, word_index, scratch);
+}
+
+static int64_t find_first_row(const char *expression, word_scanner scanner)
+{
+    compiled_expression *compiled = compile_expression(expression, NULL);
+    if (compiled == NULL)
+    {
+        fprintf(stderr, "Invalid expression in %s at line %d\n", __FILE__, __LINE__);
+        return -2;
+    }
+    int64_t row = parallel_find_first_row(compiled->number_of_variables, scanner, compiled, compiled->scratch_words);
+    free_compiled_expression(compiled);
+    return row;
+}
+
+int64_t find_first_true_row(const char *expression)
+{
+    return find_first_row(expression, true_rows_scanner);
+}
+
+int64_t find_first_false_row(const char *expression)
+{
+    return find_first_row(expression, false_rows_scanner);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Function to find the first row of the truth table where an expression is true.
+ * The table is scanned 64 rows at a time by parallel threads, which all stop as soon as
+ * a true row is found before the rows they still have to scan, so a satisfiable expression
+ * rarely needs the whole table.
+ * @param expression The infix or postfix expression
+ * @return The first true row, -1 if the expression is unsatisfiable, or -2 if the expression is invalid
+ */
+int64_t find_first_true_row(const char *expression);
+
+/**
+ * Function to find the first row of the truth table where an expression is false, stopping
+ * all scanning threads as soon as the answer is known.
+ * @param expression The infix or postfix expression
+ * @return The first false row, -1 if the expression is a tautology, or -2 if the expression is invalid
+ */
+int64_t find_first_false_row(const char *expression);
@@ -0,0 +1,458 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../utils/parallel_scan.h"
+
+#include "transforms.h"
+
+// Stages whose butterflies stay inside a block run block by block, the rest one stage at a time across all threads
+#define MOBIUS_BLOCK_WORDS 4096 // 32KB of words
+#define WALSH_BLOCK_SIZE 16384  // 64KB of coefficients
+// Smallest number of words or pairs worth handing to a thread
+#define TRANSFORM_GRAIN 8192
+
+typedef uint64_t uint64x4 __attribute__((vector_size(32)));
+typedef int32_t int32x8 __attribute__((vector_size(32)));
+
+/**
+ * Context shared by the threads generating a truth vector
+ */
+typedef struct
+{
+    const compiled_expression *compiled;
+    uint64_t *words;
+    uint64_t mask;
+} truth_vector_context;
+
+/**
+ * Context shared by the threads quantifying a truth vector
+ */
+typedef struct
+{
+    uint64_t *words;
+    uint64_t *quantified_words; // Truth vector over the remaining variables
+    int64_t row_stride;         // Rows between the two values of the variable being quantified
+    bool universal;
+    int number_of_variables;
+    int number_remaining;
+    int64_t quantified_rows;    // Bits of the row numbers that belong to quantified variables
+} quantify_context;
+
+/**
+ * Context shared by the threads running a transform
+ */
+typedef struct
+{
+    uint64_t *words;      // Truth vector or Möbius coefficients
+    int32_t *spectrum;    // Walsh coefficients
+    int64_t size;         // Number of words (Möbius) or coefficients (Walsh)
+    int64_t block_size;   // Number of words or coefficients handled by a block task
+    int stride_log;       // Stride of the current stage for stage tasks
+    int number_of_variables;
+} transform_context;
+
+static void truth_vector_task(void *arg, int64_t start, int64_t end)
+{
+    truth_vector_context *context = (truth_vector_context *)arg;
+    uint64_t *stack = (uint64_t *)malloc((context->compiled->scratch_words + 1) * sizeof(uint64_t));
+    if (stack == NULL)
+    {
+        fprintf(stderr, "Failed to allocate evaluation stack in %s at line %d\n", __FILE__, __LINE__);
+        exit(EXIT_FAILURE);
+    }
+    for (int64_t word = start; word < end; word++)
+    {
+        context->words[word] = evaluate_word(context->compiled, word, stack) & context->mask;
+    }
+    free(stack);
+}
+
+uint64_t *generate_truth_vector(const compiled_expression *compiled)
+{
+    int64_t words = number_of_words(compiled->number_of_variables);
+    // Rounded up to whole cache lines so the butterflies can use aligned vectors
+    size_t bytes = ((words * sizeof(uint64_t) + 63) / 64) * 64;
+    uint64_t *truth_vector = (uint64_t *)aligned_alloc(64, bytes);
+    if (truth_vector == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for truth vector in %s at line %d\n", __FILE__, __LINE__);
+        return (uint64_t *)NULL;
+    }
+
+    truth_vector_context context = {compiled, truth_vector, valid_rows_mask(compiled->number_of_variables)};
+    parallel_for_range(words, TRANSFORM_GRAIN, truth_vector_task, &context);
+    return truth_vector;
+}
+
+/**
+ * XORs lo into hi, 4 words at a time
+ */
+static void xor_butterfly_run(uint64_t *lo, uint64_t *hi, int64_t length)
+{
+    int64_t k = 0;
+    for (; k + 4 <= length; k += 4)
+    {
+        uint64x4 low, high;
+        memcpy(&low, lo + k, sizeof(low));
+        memcpy(&high, hi + k, sizeof(high));
+        high ^= low;
+        memcpy(hi + k, &high, sizeof(high));
+    }
+    for (; k < length; k++)
+    {
+        hi[k] ^= lo[k];
+    }
+}
+
+/**
+ * Replaces (lo, hi) with (lo + hi, lo - hi), 8 coefficients at a time
+ */
+static void walsh_butterfly_run(int32_t *lo, int32_t *hi, int64_t length)
+{
+    int64_t k = 0;
+    for (; k + 8 <= length; k += 8)
+    {
+        int32x8 low, high;
+        memcpy(&low, lo + k, sizeof(low));
+        memcpy(&high, hi + k, sizeof(high));
+        int32x8 sum = low + high;
+        int32x8 difference = low - high;
+        memcpy(lo + k, &sum, sizeof(sum));
+        memcpy(hi + k, &difference, sizeof(difference));
+    }
+    for (; k < length; k++)
+    {
+        int32_t low = lo[k];
+        lo[k] = low + hi[k];
+        hi[k] = low - hi[k];
+    }
+}
+
+/**
+ * Runs every stage of the Möbius transform whose butterflies stay inside one block of words
+ */
+static void mobius_block_task(void *arg, int64_t start, int64_t end)
+{
+    transform_context *context = (transform_context *)arg;
+    int in_word_stages = context->number_of_variables < 6 ? context->number_of_variables : 6;
+
+    for (int64_t block = start; block < end; block++)
+    {
+        uint64_t *words = context->words + block * context->block_size;
+
+        // Stages between rows of the same word: row x takes row x - 2^k for rows with bit k set
+        for (int64_t w = 0; w < context->block_size; w++)
+        {
+            uint64_t value = words[w];
+            for (int k = 0; k < in_word_stages; k++)
+            {
+                uint64_t rows_with_bit_k = variable_word(context->number_of_variables - 1 - k, context->number_of_variables, 0);
+                value ^= (value << (1 << k)) & rows_with_bit_k;
+            }
+            words[w] = value;
+        }
+
+        // Stages between words of the same block
+        for (int64_t stride = 1; stride < context->block_size; stride <<= 1)
+        {
+            for (int64_t lo = 0; lo < context->block_size; lo += 2 * stride)
+            {
+                xor_butterfly_run(words + lo, words + lo + stride, stride);
+            }
+        }
+    }
+}
+
+/**
+ * Runs the butterflies [start, end) of a Möbius stage whose stride spans several blocks
+ */
+static void mobius_stage_task(void *arg, int64_t start, int64_t end)
+{
+    transform_context *context = (transform_context *)arg;
+    int64_t stride = (int64_t)1 << context->stride_log;
+    int64_t pair = start;
+    while (pair < end)
+    {
+        // Butterflies are numbered so consecutive ones touch consecutive words
+        int64_t offset = pair & (stride - 1);
+        int64_t run = stride - offset;
+        if (run > end - pair)
+        {
+            run = end - pair;
+        }
+        uint64_t *lo = context->words + ((pair >> context->stride_log) << (context->stride_log + 1)) + offset;
+        xor_butterfly_run(lo, lo + stride, run);
+        pair += run;
+    }
+}
+
+void mobius_transform(uint64_t *truth_vector, int number_of_variables)
+{
+    transform_context context;
+    context.words = truth_vector;
+    context.size = number_of_words(number_of_variables);
+    context.block_size = context.size < MOBIUS_BLOCK_WORDS ? context.size : MOBIUS_BLOCK_WORDS;
+    context.number_of_variables = number_of_variables;
+
+    parallel_for_range(context.size / context.block_size, 1, mobius_block_task, &context);
+    for (context.stride_log = __builtin_ctzll(context.block_size); ((int64_t)1 << context.stride_log) < context.size; context.stride_log++)
+    {
+        parallel_for_range(context.size / 2, TRANSFORM_GRAIN, mobius_stage_task, &context);
+    }
+}
+
+/**
+ * Fills a block with +1/-1 from the truth vector and runs every Walsh stage that stays inside the block
+ */
+static void walsh_block_task(void *arg, int64_t start, int64_t end)
+{
+    transform_context *context = (transform_context *)arg;
+    for (int64_t block = start; block < end; block++)
+    {
+        int64_t first = block * context->block_size;
+        int32_t *coefficients = context->spectrum + first;
+        for (int64_t x = 0; x < context->block_size; x++)
+        {
+            int64_t row = first + x;
+            coefficients[x] = ((context->words[row >> 6] >> (row & 63)) & 1) ? -1 : 1;
+        }
+
+        for (int64_t stride = 1; stride < context->block_size; stride <<= 1)
+        {
+            for (int64_t lo = 0; lo < context->block_size; lo += 2 * stride)
+            {
+                walsh_butterfly_run(coefficients + lo, coefficients + lo + stride, stride);
+            }
+        }
+    }
+}
+
+/**
+ * Runs the butterflies [start, end) of a Walsh stage whose stride spans several blocks
+ */
+static void walsh_stage_task(void *arg, int64_t start, int64_t end)
+{
+    transform_context *context = (transform_context *)arg;
+    int64_t stride = (int64_t)1 << context->stride_log;
+    int64_t pair = start;
+    while (pair < end)
+    {
+        int64_t offset = pair & (stride - 1);
+        int64_t run = stride - offset;
+        if (run > end - pair)
+        {
+            run = end - pair;
+        }
+        int32_t *lo = context->spectrum + ((pair >> context->stride_log) << (context->stride_log + 1)) + offset;
+        walsh_butterfly_run(lo, lo + stride, run);
+        pair += run;
+    }
+}
+
+int32_t *walsh_hadamard_spectrum(const uint64_t *truth_vector, int number_of_variables)
+{
+    int64_t size = (int64_t)1 << number_of_variables;
+    size_t bytes = ((size * sizeof(int32_t) + 63) / 64) * 64;
+    int32_t *spectrum = (int32_t *)aligned_alloc(64, bytes);
+    if (spectrum == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for Walsh spectrum in %s at line %d\n", __FILE__, __LINE__);
+        return (int32_t *)NULL;
+    }
+
+    transform_context context;
+    context.words = (uint64_t *)truth_vector;
+    context.spectrum = spectrum;
+    context.size = size;
+    context.block_size = size < WALSH_BLOCK_SIZE ? size : WALSH_BLOCK_SIZE;
+    context.number_of_variables = number_of_variables;
+
+    parallel_for_range(size / context.block_size, 1, walsh_block_task, &context);
+    for (context.stride_log = __builtin_ctzll(context.block_size); ((int64_t)1 << context.stride_log) < size; context.stride_log++)
+    {
+        parallel_for_range(size / 2, TRANSFORM_GRAIN, walsh_stage_task, &context);
+    }
+    return spectrum;
+}
+
+/**
+ * Combines the half of every block where the variable is 1 into the half where it is 0
+ */
+static void quantify_stage_task(void *arg, int64_t start, int64_t end)
+{
+    quantify_context *context = (quantify_context *)arg;
+    uint64_t *words = context->words;
+    if (context->row_stride >= 64)
+    {
+        int64_t word_stride = context->row_stride / 64;
+        for (int64_t pair = start; pair < end; pair++)
+        {
+            int64_t low = (pair / word_stride) * 2 * word_stride + pair % word_stride;
+            words[low] = context->universal ? words[low] & words[low + word_stride] : words[low] | words[low + word_stride];
+        }
+        return;
+    }
+    // Blocks inside a word, the bits where the variable is 1 are shifted onto those where it is 0
+    int stride = context->row_stride;
+    uint64_t low_half = UINT64_MAX / ((1ULL << stride) + 1); // 0x5555... for stride 1, 0x3333... for 2, ...
+    for (int64_t word = start; word < end; word++)
+    {
+        uint64_t high = (words[word] >> stride) & low_half;
+        words[word] = context->universal ? words[word] & high : words[word] | high;
+    }
+}
+
+/**
+ * Gathers the rows where every quantified variable is 0 into the truth vector of the remaining variables
+ */
+static void quantify_gather_task(void *arg, int64_t start, int64_t end)
+{
+    quantify_context *context = (quantify_context *)arg;
+    int64_t rows_in_word = context->number_remaining >= 6 ? 64 : (int64_t)1 << context->number_remaining;
+    for (int64_t word = start; word < end; word++)
+    {
+        // Row of the full table that row 64 * word of the quantified table comes from
+        int64_t row = 0;
+        int64_t quantified_row = word * 64;
+        for (int bit = 0; bit < context->number_of_variables; bit++)
+        {
+            if ((context->quantified_rows >> bit) & 1)
+            {
+                continue;
+            }
+            row |= (quantified_row & 1) << bit;
+            quantified_row >>= 1;
+        }
+        if ((context->quantified_rows & 63) == 0 && context->number_of_variables >= 6)
+        {
+            context->quantified_words[word] = context->words[row / 64];
+            continue;
+        }
+        uint64_t result = 0;
+        for (int64_t bit = 0; bit < rows_in_word; bit++)
+        {
+            result |= ((context->words[row / 64] >> (row % 64)) & 1) << bit;
+            // Next row whose quantified bits are 0
+            row = ((row | context->quantified_rows) + 1) & ~context->quantified_rows;
+        }
+        context->quantified_words[word] = result;
+    }
+}
+
+uint64_t *quantify_truth_vector(const uint64_t *truth_vector, const char *variables, const char *quantified, bool universal, char *remaining_variables)
+{
+    int number_of_variables = strlen(variables);
+    int64_t quantified_rows = 0;
+    int number_remaining = 0;
+    for (int i = 0; quantified[i] != '\0'; i++)
+    {
+        const char *position = strchr(variables, quantified[i]);
+        if (position == NULL)
+        {
+            fprintf(stderr, "Variable %c is not in the expression\n", quantified[i]);
+            return (uint64_t *)NULL;
+        }
+        quantified_rows |= (int64_t)1 << (number_of_variables - 1 - (position - variables));
+    }
+    for (int i = 0; i < number_of_variables; i++)
+    {
+        if (((quantified_rows >> (number_of_variables - 1 - i)) & 1) == 0)
+        {
+            remaining_variables[number_remaining++] = variables[i];
+        }
+    }
+    remaining_variables[number_remaining] = '\0';
+
+    int64_t words = number_of_words(number_of_variables);
+    uint64_t *copy = (uint64_t *)malloc(words * sizeof(uint64_t));
+    uint64_t *result = (uint64_t *)malloc(number_of_words(number_remaining) * sizeof(uint64_t));
+    if (copy == NULL || result == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for truth vector in %s at line %d\n", __FILE__, __LINE__);
+        free(copy);
+        free(result);
+        return (uint64_t *)NULL;
+    }
+    memcpy(copy, truth_vector, words * sizeof(uint64_t));
+
+    quantify_context context = {copy, result, 0, universal, number_of_variables, number_remaining, quantified_rows};
+    for (int bit = 0; bit < number_of_variables; bit++)
+    {
+        if ((quantified_rows >> bit) & 1)
+        {
+            context.row_stride = (int64_t)1 << bit;
+            parallel_for_range(context.row_stride >= 64 ? words / 2 : words, TRANSFORM_GRAIN, quantify_stage_task, &context);
+        }
+    }
+    parallel_for_range(number_of_words(number_remaining), TRANSFORM_GRAIN, quantify_gather_task, &context);
+    free(copy);
+    return result;
+}
+
+void write_algebraic_normal_form(FILE *file, const uint64_t *coefficients, const char *variables)
+{
+    int number_of_variables = strlen(variables);
+    int64_t size = (int64_t)1 << number_of_variables;
+    char term[2 * 26 + 1];
+    bool first_term = true;
+
+    for (int64_t u = 0; u < size; u++)
+    {
+        if (((coefficients[u >> 6] >> (u & 63)) & 1) == 0)
+        {
+            continue;
+        }
+        int length = 0;
+        for (int i = 0; i < number_of_variables; i++)
+        {
+            if ((u >> (number_of_variables - 1 - i)) & 1)
+            {
+                if (length > 0)
+                {
+                    term[length++] = '&';
+                }
+                term[length++] = variables[i];
+            }
+        }
+        if (length == 0)
+        {
+            term[length++] = '1'; // Constant term
+        }
+        term[length] = '\0';
+        fprintf(file, first_term ? "%s" : " # %s", term);
+        first_term = false;
+    }
+    fprintf(file, first_term ? "0\n" : "\n");
+}
+
+void write_walsh_spectrum(FILE *file, const int32_t *spectrum, const char *variables)
+{
+    int number_of_variables = strlen(variables);
+    int64_t size = (int64_t)1 << number_of_variables;
+
+    for (int i = 0; i < number_of_variables; i++)
+    {
+        fprintf(file, "%c ", variables[i]);
+    }
+    fprintf(file, ": Walsh\n");
+    for (int i = 0; i < number_of_variables * 2 + 7; i++)
+    {
+        fputc('=', file);
+    }
+    fputc('\n', file);
+
+    char row[2 * 26 + 3];
+    for (int64_t u = 0; u < size; u++)
+    {
+        for (int i = 0; i < number_of_variables; i++)
+        {
+            row[2 * i] = ((u >> (number_of_variables - 1 - i)) & 1) + '0';
+            row[2 * i + 1] = ' ';
+        }
+        row[number_of_variables * 2] = ':';
+        row[number_of_variables * 2 + 1] = ' ';
+        row[number_of_variables * 2 + 2] = '\0';
+        fprintf(file, "%s%d\n", row, spectrum[u]);
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../rpn_evaluator/word_evaluation.h"
+
+/**
+ * Function to generate the packed truth vector of a compiled expression, row r of the table being
+ * bit (r % 64) of word (r / 64). Words are evaluated by parallel threads.
+ * Bits past the last row of tables with less than 6 variables are 0.
+ * Caller is responsible for freeing the truth vector.
+ * @param compiled The compiled expression
+ * @return The truth vector, number_of_words(compiled->number_of_variables) words long
+ */
+uint64_t *generate_truth_vector(const compiled_expression *compiled);
+
+/**
+ * Function to turn a truth vector into the coefficients of the algebraic normal form (Möbius transform)
+ * in place. Afterwards bit u is set if the monomial made of the variables whose bits are set in u
+ * (same bit layout as the row numbers) appears in the XOR of AND terms equal to the expression.
+ * Runs in O(n * 2^n) using word level butterflies, parallelised across threads for large tables.
+ * @param truth_vector The truth vector, overwritten by the coefficients
+ * @param number_of_variables The number of variables of the table
+ */
+void mobius_transform(uint64_t *truth_vector, int number_of_variables);
+
+/**
+ * Function to compute the Walsh-Hadamard spectrum of an expression from its truth vector,
+ * W(u) = sum over rows x of (-1)^(f(x) xor u.x), in O(n * 2^n) using vectorised butterflies
+ * parallelised across threads for large tables.
+ * Caller is responsible for freeing the spectrum.
+ * @param truth_vector The truth vector of the expression
+ * @param number_of_variables The number of variables of the table
+ * @return The 2^n coefficients of the spectrum, or NULL on allocation failure
+ */
+int32_t *walsh_hadamard_spectrum(const uint64_t *truth_vector, int number_of_variables);
+
+/**
+ * Function to quantify variables of an expression away from its truth vector, giving the truth vector
+ * of the function of the remaining variables that is 1 when the expression is 1 for some (exists) or
+ * all (forall) values of the quantified variables. Each variable is a word level OR or AND of the
+ * two halves of every block of rows the variable splits, parallelised across threads for large tables.
+ * Caller is responsible for freeing the result.
+ * @param truth_vector The truth vector of the expression
+ * @param variables The variables of the truth vector in column order
+ * @param quantified The variables being quantified
+ * @param universal Whether the quantifier is forall rather than exists
+ * @param remaining_variables Receives the variables left, in column order, at least 27 characters
+ * @return The truth vector over the remaining variables, or NULL if a quantified variable isn't one of variables
+ */
+uint64_t *quantify_truth_vector(const uint64_t *truth_vector, const char *variables, const char *quantified, bool universal, char *remaining_variables);
+
+/**
+ * Function to write an algebraic normal form as an XOR (#) of AND (&) terms, in the order of
+ * the rows the terms correspond to. The constant term is written as 1 and the zero function as 0.
+ * @param file The file the algebraic normal form is written to
+ * @param coefficients The coefficients from mobius_transform
+ * @param variables The variables in column order
+ */
+void write_algebraic_normal_form(FILE *file, const uint64_t *coefficients, const char *variables);
+
+/**
+ * Function to write a Walsh-Hadamard spectrum as a table, one row per u with the bits of u
+ * laid out like the variable columns of a truth table.
+ * @param file The file the spectrum is written to
+ * @param spectrum The spectrum from walsh_hadamard_spectrum
+ * @param variables The variables in column order
+ */
+void write_walsh_spectrum(FILE *file, const int32_t *spectrum, const char *variables);
@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "../rpn_evaluator/word_evaluation.h"
+#include "../table_builders_for_webpage/table_builders.h"
+#include "expression_parser.h"
+
+#include "c_emitter.h"
+
+static bool is_c_identifier(const char *name)
+{
+    if (name[0] == '\0' || isdigit(name[0]))
+    {
+        return false;
+    }
+    for (int i = 0; name[i] != '\0'; i++)
+    {
+        if (!isalnum(name[i]) && name[i] != '_')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void emit_string_literal(FILE *file, const char *text, int length)
+{
+    fputc('"', file);
+    for (int i = 0; i < length; i++)
+    {
+        if (text[i] == '\n')
+        {
+            fputs("\\n", file);
+        }
+        else
+        {
+            if (text[i] == '"' || text[i] == '\\')
+            {
+                fputc('\\', file);
+            }
+            fputc(text[i], file);
+        }
+    }
+    fputc('"', file);
+}
+
+/**
+ * Writes the value of a variable over the 64 rows of word_index as a C expression
+ */
+static void emit_variable_word(FILE *file, int variable_index, int number_of_variables)
+{
+    int shift = number_of_variables - 1 - variable_index;
+    if (shift < 6)
+    {
+        fprintf(file, "0x%016llXULL", (unsigned long long)variable_word(variable_index, number_of_variables, 0));
+    }
+    else
+    {
+        fprintf(file, "(uint64_t)0 - (((uint64_t)word_index >> %d) & 1)", shift - 6);
+    }
+}
+
+/**
+ * Writes the straight-line evaluation of the compiled expression, either into the slots array
+ * or into local constants s0, s1, ... which the compiler can keep in registers
+ */
+static void emit_program(FILE *file, const compiled_expression *compiled, bool into_slots)
+{
+    int *operands = (int *)malloc((compiled->max_stack_depth + 1) * sizeof(int));
+    int top = -1;
+    for (int i = 0; i < compiled->program_length; i++)
+    {
+        const instruction *current = &compiled->program[i];
+        if (into_slots)
+        {
+            fprintf(file, "    slots[%d] = ", i);
+        }
+        else
+        {
+            fprintf(file, "    const uint64_t s%d = ", i);
+        }
+        const char *slot = into_slots ? "slots[" : "s";
+        const char *close = into_slots ? "]" : "";
+
+        switch (current->op)
+        {
+        case OP_VARIABLE:
+            emit_variable_word(file, current->operand, compiled->number_of_variables);
+            operands[++top] = i;
+            break;
+        case OP_CONSTANT:
+            fprintf(file, "%s", current->operand ? "~0ULL" : "0ULL");
+            operands[++top] = i;
+            break;
+        case OP_COPY:
+            fprintf(file, "%s%d%s", slot, current->operand, close);
+            operands[++top] = i;
+            break;
+        case OP_NOT:
+            fprintf(file, "~%s%d%s", slot, operands[top], close);
+            operands[top] = i;
+            break;
+        case OP_IMPLICATION:
+            // Same operand order as evaluate_word
+            top--;
+            fprintf(file, "~%s%d%s | %s%d%s", slot, operands[top + 1], close, slot, operands[top], close);
+            operands[top] = i;
+            break;
+        case OP_IFF:
+        case OP_NAND:
+        case OP_NOR:
+            top--;
+            fprintf(file, "~(%s%d%s %c %s%d%s)", slot, operands[top], close,
+                    current->op == OP_IFF ? '^' : current->op == OP_NAND ? '&' : '|',
+                    slot, operands[top + 1], close);
+            operands[top] = i;
+            break;
+        case OP_MUX:
+            top -= 2;
+            fprintf(file, "%s%d%s ^ (%s%d%s & (%s%d%s ^ %s%d%s))", slot, operands[top + 2], close,
+                    slot, operands[top], close, slot, operands[top + 1], close, slot, operands[top + 2], close);
+            operands[top] = i;
+            break;
+        case OP_MAJORITY:
+            top -= 2;
+            fprintf(file, "(%s%d%s & %s%d%s) | (%s%d%s & (%s%d%s | %s%d%s))", slot, operands[top], close,
+                    slot, operands[top + 1], close, slot, operands[top + 2], close,
+                    slot, operands[top], close, slot, operands[top + 1], close);
+            operands[top] = i;
+            break;
+        case OP_XOR_N:
+            top -= current->operand - 1;
+            for (int k = 0; k < current->operand; k++)
+            {
+                fprintf(file, "%s%s%d%s", k == 0 ? "" : " ^ ", slot, operands[top + k], close);
+            }
+            operands[top] = i;
+            break;
+        default:
+            top--;
+            fprintf(file, "%s%d%s %c %s%d%s", slot, operands[top], close,
+                    current->op == OP_AND ? '&' : current->op == OP_OR ? '|' : '^',
+                    slot, operands[top + 1], close);
+            operands[top] = i;
+            break;
+        }
+        fprintf(file, ";\n");
+    }
+    free(operands);
+}
+
+bool emit_c_kernels(FILE *file, const char *expression, const char *prefix)
+{
+    if (!is_c_identifier(prefix))
+    {
+        fprintf(stderr, "Invalid prefix %s for generated functions\n", prefix);
+        return false;
+    }
+
+    parsed_expression *parsed = parse_expression(expression);
+    if (parsed == NULL)
+    {
+        return false;
+    }
+    row_formatter *formatter = create_parsed_row_formatter(parsed);
+    if (formatter == NULL)
+    {
+        free_parsed_expression(parsed);
+        return false;
+    }
+    const compiled_expression *compiled = formatter->compiled;
+
+    char upper[strlen(prefix) + 1];
+    for (int i = 0; prefix[i] != '\0'; i++)
+    {
+        upper[i] = toupper(prefix[i]);
+    }
+    upper[strlen(prefix)] = '\0';
+
+    fprintf(file, "/*\n * Kernels for the expression: %s\n", expression);
+    fprintf(file, " * Generated by website_binary_ttable --emit-c, do not edit.\n");
+    fprintf(file, " * Build with gcc -O3 -march=native -I<truth table src directory> -c, then link against\n");
+    fprintf(file, " * table_builders.o and the objects it depends on.\n */\n");
+    fprintf(file, "#include <stdio.h>\n#include <stdlib.h>\n#include <stdint.h>\n#include <stdbool.h>\n\n");
+    fprintf(file, "#include \"table_builders_for_webpage/table_builders.h\"\n\n");
+
+    fprintf(file, "#define %s_NUMBER_OF_VARIABLES %d\n", upper, compiled->number_of_variables);
+    fprintf(file, "#define %s_ROW_LENGTH %d\n", upper, formatter->row_length);
+    fprintf(file, "#define %s_NUMBER_OF_SLOTS %d\n\n", upper, compiled->program_length);
+    fprintf(file, "static const char %s_expression[] = ", prefix);
+    emit_string_literal(file, parsed->expression, parsed->expression_length);
+    fprintf(file, ";\n\n");
+
+    // The row layout is fixed, so the formatter is a constant instead of being computed at run time
+    fprintf(file, "static char %s_template_row[] = ", prefix);
+    emit_string_literal(file, formatter->template_row, formatter->row_length);
+    fprintf(file, ";\nstatic int %s_value_columns[] = {", prefix);
+    for (int v = 0; v < formatter->number_of_values; v++)
+    {
+        fprintf(file, "%s%d", v ? ", " : "", formatter->value_columns[v]);
+    }
+    fprintf(file, "%s};\nstatic int %s_value_slots[] = {", formatter->number_of_values ? "" : "0", prefix);
+    for (int v = 0; v < formatter->number_of_values; v++)
+    {
+        fprintf(file, "%s%d", v ? ", " : "", formatter->value_slots[v]);
+    }
+    fprintf(file, "%s};\n", formatter->number_of_values ? "" : "0");
+    // Designated, so the fields left out are NULL and adding or reordering fields can't shift the values
+    fprintf(file, "static const row_formatter %s_formatter = {\n", prefix);
+    fprintf(file, "    .number_of_variables = %s_NUMBER_OF_VARIABLES,\n", upper);
+    fprintf(file, "    .row_length = %s_ROW_LENGTH,\n", upper);
+    fprintf(file, "    .template_row = %s_template_row,\n", prefix);
+    fprintf(file, "    .number_of_values = %d,\n", formatter->number_of_values);
+    fprintf(file, "    .value_columns = %s_value_columns,\n", prefix);
+    fprintf(file, "    .value_slots = %s_value_slots,\n", prefix);
+    fprintf(file, "    .result_slot = %d,\n", formatter->result_slot);
+    fprintf(file, "    .result_column = %d,\n};\n\n", formatter->result_column);
+
+    // Every intermediate result, for the row formatter
+    fprintf(file, "void %s_slots(int64_t word_index, uint64_t *slots)\n{\n    (void)word_index;\n", prefix);
+    emit_program(file, compiled, true);
+    fprintf(file, "}\n\n");
+
+    // Only the result, for counting
+    fprintf(file, "uint64_t %s_word(int64_t word_index)\n{\n    (void)word_index;\n", prefix);
+    emit_program(file, compiled, false);
+    if (formatter->result_slot >= 0)
+    {
+        fprintf(file, "    return s%d;\n}\n\n", formatter->result_slot);
+    }
+    else
+    {
+        fprintf(file, "    (void)s%d;\n    return 0; // The result column of this expression is blank\n}\n\n", compiled->program_length - 1);
+    }
+
+    fprintf(file,
+            "int64_t %s_count_true(int64_t start_row, int64_t end_row)\n"
+            "{\n"
+            "    if (end_row > ((int64_t)1 << %s_NUMBER_OF_VARIABLES))\n"
+            "    {\n"
+            "        end_row = (int64_t)1 << %s_NUMBER_OF_VARIABLES;\n"
+            "    }\n"
+            "    if (start_row < 0)\n"
+            "    {\n"
+            "        start_row = 0;\n"
+            "    }\n"
+            "    int64_t count = 0;\n"
+            "    for (int64_t word = start_row >> 6; word * 64 < end_row; word++)\n"
+            "    {\n"
+            "        uint64_t mask = ~0ULL;\n"
+            "        if (word * 64 < start_row)\n"
+            "        {\n"
+            "            mask &= ~0ULL << (start_row - word * 64);\n"
+            "        }\n"
+            "        if (end_row - word * 64 < 64)\n"
+            "        {\n"
+            "            mask &= (1ULL << (end_row - word * 64)) - 1;\n"
+            "        }\n"
+            "        count += __builtin_popcountll(%s_word(word) & mask);\n"
+            "    }\n"
+            "    return count;\n"
+            "}\n\n",
+            prefix, upper, upper, prefix);
+
+    fprintf(file,
+            "char *%s_segment(int start_row, int end_row, bool only_true)\n"
+            "{\n"
+            "    if (end_row > (1 << %s_NUMBER_OF_VARIABLES))\n"
+            "    {\n"
+            "        end_row = 1 << %s_NUMBER_OF_VARIABLES;\n"
+            "    }\n"
+            "    if (start_row < 0 || end_row < start_row)\n"
+            "    {\n"
+            "        end_row = start_row = 0;\n"
+            "    }\n"
+            "    char *segment = (char *)malloc((int64_t)(end_row - start_row) * %s_ROW_LENGTH + 1);\n"
+            "    uint64_t *slots = (uint64_t *)malloc(%s_NUMBER_OF_SLOTS * sizeof(uint64_t));\n"
+            "    if (segment == NULL || slots == NULL)\n"
+            "    {\n"
+            "        free(segment);\n"
+            "        free(slots);\n"
+            "        return (char *)NULL;\n"
+            "    }\n"
+            "    int64_t written_rows = 0;\n"
+            "    for (int64_t word = start_row >> 6; word * 64 < end_row; word++)\n"
+            "    {\n"
+            "        int first_bit = word * 64 < start_row ? start_row - word * 64 : 0;\n"
+            "        int end_bit = end_row - word * 64 < 64 ? end_row - word * 64 : 64;\n"
+            "        %s_slots(word, slots);\n"
+            "        written_rows += format_word_rows(&%s_formatter, slots, word, first_bit, end_bit, only_true,\n"
+            "                                         segment + written_rows * %s_ROW_LENGTH);\n"
+            "    }\n"
+            "    segment[written_rows * %s_ROW_LENGTH] = '\\0';\n"
+            "    free(slots);\n"
+            "    return segment;\n"
+            "}\n\n",
+            prefix, upper, upper, upper, upper, prefix, prefix, upper, upper);
+
+    fprintf(file,
+            "void %s_table(FILE *file, bool only_true)\n"
+            "{\n"
+            "    char *header = generate_header(%s_expression);\n"
+            "    char *separator = generate_separator(%s_expression);\n"
+            "    fprintf(file, \"%%s%%s\", header, separator);\n"
+            "    free(header);\n"
+            "    free(separator);\n"
+            "\n"
+            "    // Rows are written 64 words at a time\n"
+            "    int64_t number_of_rows = (int64_t)1 << %s_NUMBER_OF_VARIABLES;\n"
+            "    char *buffer = (char *)malloc((int64_t)64 * 64 * %s_ROW_LENGTH);\n"
+            "    uint64_t *slots = (uint64_t *)malloc(%s_NUMBER_OF_SLOTS * sizeof(uint64_t));\n"
+            "    if (buffer == NULL || slots == NULL)\n"
+            "    {\n"
+            "        fprintf(stderr, \"Memory allocation failed in %%s at line %%d\\n\", __FILE__, __LINE__);\n"
+            "        exit(EXIT_FAILURE);\n"
+            "    }\n"
+            "    for (int64_t first_word = 0; first_word * 64 < number_of_rows; first_word += 64)\n"
+            "    {\n"
+            "        int64_t written_rows = 0;\n"
+            "        for (int64_t word = first_word; word < first_word + 64 && word * 64 < number_of_rows; word++)\n"
+            "        {\n"
+            "            int end_bit = number_of_rows - word * 64 < 64 ? number_of_rows - word * 64 : 64;\n"
+            "            %s_slots(word, slots);\n"
+            "            written_rows += format_word_rows(&%s_formatter, slots, word, 0, end_bit, only_true,\n"
+            "                                             buffer + written_rows * %s_ROW_LENGTH);\n"
+            "        }\n"
+            "        fwrite(buffer, %s_ROW_LENGTH, written_rows, file);\n"
+            "    }\n"
+            "    free(buffer);\n"
+            "    free(slots);\n"
+            "}\n",
+            prefix, prefix, prefix, upper, upper, upper, prefix, prefix, upper, upper);
+
+    free_row_formatter(formatter);
+    free_parsed_expression(parsed);
+    return true;
+}
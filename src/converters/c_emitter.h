@@ -0,0 +1,18 @@
+#pragma once
+#include <stdio.h>
+#include <stdbool.h>
+
+/**
+ * Function to write a self-contained C file implementing the kernels of one fixed expression.
+ * The number of variables, row width and every operator are compile-time constants, so the file
+ * can be built with -O3 -march=native and linked against table_builders.o (and the objects it
+ * depends on) which provides the row output code. The file defines, for a prefix p:
+ * p_slots (every intermediate result of 64 rows), p_word (the results of 64 rows),
+ * p_count_true (number of true rows in a range), p_segment (a segment of the table, like
+ * generate_infix_truth_table_segment) and p_table (the whole table or its true rows written to a file).
+ * @param file The file the C source is written to
+ * @param expression The infix or postfix expression
+ * @param prefix The prefix of the generated functions, which must be a valid C identifier
+ * @return true if the file was written, false if the expression or prefix is invalid
+ */
+bool emit_c_kernels(FILE *file, const char *expression, const char *prefix);
@@ -0,0 +1,268 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "functions.h"
+#include "expression_parser.h"
+
+static int precedence(char op)
+{
+    switch (op)
+    {
+    case '-':
+        return 5; // NOT
+    case '&':
+        return 4; // AND
+    case '#':
+        return 3; // XOR
+    case '|':
+        return 2; // OR
+    case '>':
+        return 1; // IMPLICATION
+    case '=':
+        return 0; // IFF
+    default:
+        return -1;
+    }
+}
+
+static bool is_binary_operator(char token)
+{
+    return (token == '&' || token == '#' || token == '|' || token == '>' || token == '=');
+}
+
+/**
+ * Checks the infix grammar, runs the shunting yard algorithm and builds the infix map together, while
+ * also checking whether the expression would be a valid postfix expression in case it isn't infix.
+ * This is the only grammar - shunting_yard, infix_map and is_valid_infix are wrappers over it.
+ */
+parsed_expression *parse_expression(const char *expression)
+{
+    int expression_length = strlen(expression);
+    parsed_expression *parsed = (parsed_expression *)calloc(1, sizeof(parsed_expression));
+    char *operators = (char *)malloc(expression_length + 1);
+    int *positions = (int *)malloc((expression_length + 1) * sizeof(int));
+    // Arguments seen so far by the function call each open bracket belongs to, 0 for plain brackets
+    int *arguments = (int *)malloc((expression_length + 1) * sizeof(int));
+    if (parsed == NULL || operators == NULL || positions == NULL || arguments == NULL)
+    {
+        free(parsed);
+        free(operators);
+        free(positions);
+        free(arguments);
+        return (parsed_expression *)NULL;
+    }
+    parsed->expression = (char *)malloc(expression_length + 1);
+    parsed->rpn_expression = (char *)malloc(expression_length + 1);
+    parsed->map = (int *)malloc((expression_length + 1) * sizeof(int));
+    if (parsed->expression == NULL || parsed->rpn_expression == NULL || parsed->map == NULL)
+    {
+        free(operators);
+        free(positions);
+        free(arguments);
+        free_parsed_expression(parsed);
+        return (parsed_expression *)NULL;
+    }
+    memcpy(parsed->expression, expression, expression_length + 1);
+    parsed->expression_length = expression_length;
+
+    bool present[26] = {0};
+    bool valid_infix = true;
+    bool valid_postfix = true;
+    bool expecting_operand = true;
+    bool expecting_call = false; // A function name must be followed by its bracket
+    int balance = 0;
+    int postfix_depth = 0;
+    int top = -1;
+    int rpn_index = 0;
+
+    for (int i = 0; i < expression_length; i++)
+    {
+        char token = expression[i];
+        if (token == ' ')
+        {
+            continue;
+        }
+        bool call = expecting_call;
+        valid_infix = valid_infix && (!call || token == '(');
+        expecting_call = false;
+
+        char function;
+        int name_length;
+        if (islower(token) || token == '0' || token == '1')
+        {
+            if (islower(token) && !present[token - 'a'])
+            {
+                present[token - 'a'] = true;
+                parsed->variables[parsed->number_of_variables++] = token;
+            }
+            valid_infix = valid_infix && expecting_operand;
+            expecting_operand = false;
+            postfix_depth++;
+            parsed->rpn_expression[rpn_index] = token;
+            parsed->map[rpn_index++] = i;
+        }
+        else if ((function = function_token(expression + i, &name_length)) != 0)
+        {
+            // No function name is a valid sequence of postfix tokens
+            valid_postfix = false;
+            valid_infix = valid_infix && expecting_operand;
+            expecting_call = true;
+            operators[++top] = function;
+            positions[top] = i;
+            i += name_length - 1;
+        }
+        else if (is_function_token(token))
+        {
+            valid_infix = false;
+            valid_postfix = valid_postfix && postfix_depth >= function_operands(token);
+            postfix_depth -= function_operands(token) - 1;
+        }
+        else if (token == '-' || is_binary_operator(token))
+        {
+            if (token == '-')
+            {
+                valid_infix = valid_infix && expecting_operand;
+                valid_postfix = valid_postfix && postfix_depth >= 1;
+            }
+            else
+            {
+                valid_infix = valid_infix && !expecting_operand;
+                expecting_operand = true;
+                valid_postfix = valid_postfix && postfix_depth >= 2;
+                postfix_depth--;
+            }
+
+            // NOT and IMPLICATION are right associative
+            bool right_associative = (token == '-' || token == '>');
+            while (top >= 0 && operators[top] != '(' &&
+                   (right_associative ? precedence(token) < precedence(operators[top])
+                                      : precedence(token) <= precedence(operators[top])))
+            {
+                parsed->rpn_expression[rpn_index] = operators[top];
+                parsed->map[rpn_index++] = positions[top--];
+            }
+            operators[++top] = token;
+            positions[top] = i;
+        }
+        else if (token == '(')
+        {
+            valid_postfix = false;
+            valid_infix = valid_infix && expecting_operand;
+            balance++;
+            if (balance > 0)
+            {
+                arguments[balance] = call ? 1 : 0;
+            }
+            operators[++top] = token;
+            positions[top] = -1;
+        }
+        else if (token == ',')
+        {
+            valid_postfix = false;
+            valid_infix = valid_infix && balance > 0 && arguments[balance] > 0 && !expecting_operand;
+            expecting_operand = true;
+            while (top >= 0 && operators[top] != '(')
+            {
+                parsed->rpn_expression[rpn_index] = operators[top];
+                parsed->map[rpn_index++] = positions[top--];
+            }
+            if (balance > 0)
+            {
+                arguments[balance]++;
+            }
+        }
+        else if (token == ')')
+        {
+            valid_postfix = false;
+            valid_infix = valid_infix && balance > 0 && !expecting_operand;
+            int call_arguments = balance > 0 ? arguments[balance] : 0;
+            balance--;
+            while (top >= 0 && operators[top] != '(')
+            {
+                parsed->rpn_expression[rpn_index] = operators[top];
+                parsed->map[rpn_index++] = positions[top--];
+            }
+            if (top >= 0)
+            {
+                top--; // Discard the left parenthesis
+            }
+            if (call_arguments > 0 && top >= 0)
+            {
+                // The function's value is shown under its name, by the last of its tokens
+                function = operators[top];
+                valid_infix = valid_infix && valid_function_arguments(function, call_arguments);
+                int tokens = function == FUNCTION_XOR ? call_arguments - 1 : 1;
+                for (int k = 0; k < tokens; k++)
+                {
+                    parsed->rpn_expression[rpn_index] = function;
+                    parsed->map[rpn_index++] = k == tokens - 1 ? positions[top] : -1;
+                }
+                top--;
+            }
+        }
+        else
+        {
+            valid_infix = false;
+            valid_postfix = false;
+        }
+
+        if (!valid_infix && !valid_postfix)
+        {
+            break;
+        }
+    }
+    valid_infix = valid_infix && balance == 0 && !expecting_operand && !expecting_call;
+    valid_postfix = valid_postfix && postfix_depth == 1;
+
+    if (valid_infix)
+    {
+        while (top >= 0)
+        {
+            parsed->rpn_expression[rpn_index] = operators[top];
+            parsed->map[rpn_index++] = positions[top--];
+        }
+    }
+    free(operators);
+    free(positions);
+    free(arguments);
+
+    if (!valid_infix && !valid_postfix)
+    {
+        free_parsed_expression(parsed);
+        return (parsed_expression *)NULL;
+    }
+
+    parsed->is_infix = valid_infix;
+    if (valid_infix)
+    {
+        parsed->rpn_expression[rpn_index] = '\0';
+        parsed->rpn_length = rpn_index;
+        // Mark unused slots of the map with -1
+        for (int i = rpn_index; i < expression_length; i++)
+        {
+            parsed->map[i] = -1;
+        }
+    }
+    else
+    {
+        memcpy(parsed->rpn_expression, expression, expression_length + 1);
+        parsed->rpn_length = expression_length;
+        free(parsed->map);
+        parsed->map = NULL;
+    }
+    parsed->row_length = parsed->number_of_variables * 2 + expression_length + 9;
+    return parsed;
+}
+
+void free_parsed_expression(parsed_expression *parsed)
+{
+    if (parsed == NULL)
+    {
+        return;
+    }
+    free(parsed->expression);
+    free(parsed->rpn_expression);
+    free(parsed->map);
+    free(parsed);
+}
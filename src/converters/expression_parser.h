@@ -0,0 +1,36 @@
+#pragma once
+#include <stdbool.h>
+
+/**
+ * Everything the table builders need to know about an expression, produced by a single pass
+ * over its text so builders don't have to validate, convert and count variables separately
+ */
+typedef struct
+{
+    char *expression;        // Copy of the expression as shown in the header
+    int expression_length;
+    bool is_infix;           // Whether the expression is a valid infix expression
+    char *rpn_expression;    // The converted expression for infix, a copy of the expression for postfix
+    int rpn_length;
+    int *map;                // The infix map (see infix_map), NULL for postfix expressions
+    int number_of_variables;
+    char variables[27];      // Variables in column order, null terminated
+    int row_length;          // Length of every row of the table, including the new line
+} parsed_expression;
+
+/**
+ * Function to parse an expression in one pass, deciding whether it is infix or postfix (infix is
+ * preferred when the expression is valid both ways), converting infix expressions to rpn with
+ * their infix map and collecting the variables in column order.
+ * Caller is responsible for freeing the result with free_parsed_expression.
+ * @param expression The infix or postfix expression
+ * @return The parsed expression, or NULL if the expression is neither valid infix nor valid postfix or
+ * memory can't be allocated. Nothing is printed, callers report the failure.
+ */
+parsed_expression *parse_expression(const char *expression);
+
+/**
+ * Function to free a parsed expression
+ * @param parsed The parsed expression being freed
+ */
+void free_parsed_expression(parsed_expression *parsed);
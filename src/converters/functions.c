@@ -0,0 +1,59 @@
+#include <string.h>
+
+#include "functions.h"
+
+static const struct
+{
+    const char *name;
+    char token;
+} functions[] = {
+    {"NAND", FUNCTION_NAND},
+    {"NOR", FUNCTION_NOR},
+    {"MUX", FUNCTION_MUX},
+    {"MAJ", FUNCTION_MAJORITY},
+    {"XOR", FUNCTION_XOR}};
+
+char function_token(const char *text, int *name_length)
+{
+    for (unsigned long i = 0; i < sizeof(functions) / sizeof(functions[0]); i++)
+    {
+        int length = strlen(functions[i].name);
+        if (strncmp(text, functions[i].name, length) == 0)
+        {
+            *name_length = length;
+            return functions[i].token;
+        }
+    }
+    *name_length = 0;
+    return 0;
+}
+
+bool is_function_token(char token)
+{
+    return function_operands(token) > 0;
+}
+
+int function_operands(char token)
+{
+    switch (token)
+    {
+    case FUNCTION_NAND:
+    case FUNCTION_NOR:
+    case FUNCTION_XOR:
+        return 2;
+    case FUNCTION_MUX:
+    case FUNCTION_MAJORITY:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+bool valid_function_arguments(char token, int number_of_arguments)
+{
+    if (token == FUNCTION_XOR)
+    {
+        return number_of_arguments >= 2;
+    }
+    return number_of_arguments == function_operands(token);
+}
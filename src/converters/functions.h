@@ -0,0 +1,45 @@
+#pragma once
+#include <stdbool.h>
+
+/**
+ * Operators written as functions in infix expressions, NAME(argument, ...), and as a single
+ * uppercase token in rpn (and postfix) expressions, which the function's value is shown under.
+ * MUX(s,a,b) is a when s is 1 and b otherwise, MAJ(a,b,c) is 1 when at least two of its
+ * arguments are. XOR takes two operands per token, a run of k XOR tokens in rpn is a single
+ * XOR of k + 1 operands, so XOR(a,b,c,d) is abcdXXX in rpn.
+ */
+#define FUNCTION_NAND 'N'
+#define FUNCTION_NOR 'O'
+#define FUNCTION_MUX 'M'
+#define FUNCTION_MAJORITY 'V'
+#define FUNCTION_XOR 'X'
+
+/**
+ * Function to recognise the name of a function at the start of an infix expression
+ * @param text The text starting where the name might be
+ * @param name_length Receives the length of the name
+ * @return The rpn token of the function, or 0 if text doesn't start with a function name
+ */
+char function_token(const char *text, int *name_length);
+
+/**
+ * Function to check whether a character is the rpn token of a function
+ * @param token The character
+ * @return true if it is, false otherwise
+ */
+bool is_function_token(char token);
+
+/**
+ * Function to get the number of operands a function token takes off the rpn stack
+ * @param token The rpn token of the function
+ * @return The number of operands, 0 if token isn't a function token
+ */
+int function_operands(char token);
+
+/**
+ * Function to check a function of an infix expression is called with a valid number of arguments
+ * @param token The rpn token of the function
+ * @param number_of_arguments The number of arguments of the call
+ * @return true if it is valid, false otherwise
+ */
+bool valid_function_arguments(char token, int number_of_arguments);
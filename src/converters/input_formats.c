@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "input_formats.h"
+
+/**
+ * A compiled expression being built one instruction at a time
+ */
+typedef struct
+{
+    compiled_expression *compiled;
+    int capacity;
+    int depth;
+} program_builder;
+
+static compiled_expression *start_program(program_builder *builder, int number_of_variables)
+{
+    builder->compiled = (compiled_expression *)calloc(1, sizeof(compiled_expression));
+    if (builder->compiled == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for compiled expression in %s at line %d\n", __FILE__, __LINE__);
+        return (compiled_expression *)NULL;
+    }
+    builder->capacity = 0;
+    builder->depth = 0;
+    builder->compiled->number_of_variables = number_of_variables;
+    for (int i = 0; i < number_of_variables; i++)
+    {
+        builder->compiled->variables[i] = 'a' + i;
+    }
+    return builder->compiled;
+}
+
+static bool append_instruction(program_builder *builder, opcode op, int operand)
+{
+    compiled_expression *compiled = builder->compiled;
+    if (compiled->program_length == builder->capacity)
+    {
+        int capacity = builder->capacity < 64 ? 64 : builder->capacity * 2;
+        instruction *program = (instruction *)realloc(compiled->program, capacity * sizeof(instruction));
+        if (program == NULL)
+        {
+            fprintf(stderr, "Failed to allocate memory for program in %s at line %d\n", __FILE__, __LINE__);
+            return false;
+        }
+        compiled->program = program;
+        builder->capacity = capacity;
+    }
+
+    instruction *current = &compiled->program[compiled->program_length];
+    current->op = op;
+    current->operand = operand;
+    current->rpn_position = compiled->program_length; // There is no text to point back to
+    compiled->program_length++;
+
+    if (op == OP_VARIABLE || op == OP_CONSTANT || op == OP_COPY)
+    {
+        builder->depth++;
+    }
+    else if (op != OP_NOT)
+    {
+        builder->depth--;
+    }
+    if (builder->depth > compiled->max_stack_depth)
+    {
+        compiled->max_stack_depth = builder->depth;
+    }
+    return true;
+}
+
+static void skip_line(FILE *file)
+{
+    int ch;
+    while ((ch = fgetc(file)) != EOF && ch != '\n')
+    {
+    }
+}
+
+compiled_expression *read_dimacs_cnf(FILE *file)
+{
+    int number_of_variables = -1;
+    int number_of_clauses = 0;
+    int ch;
+
+    // Comments come before the problem line
+    while ((ch = fgetc(file)) != EOF)
+    {
+        if (ch == 'c' || ch == '\n' || ch == ' ' || ch == '\r')
+        {
+            if (ch == 'c')
+            {
+                skip_line(file);
+            }
+            continue;
+        }
+        if (ch != 'p' || fscanf(file, " cnf %d %d", &number_of_variables, &number_of_clauses) != 2)
+        {
+            fprintf(stderr, "Missing DIMACS problem line in %s at line %d\n", __FILE__, __LINE__);
+            return (compiled_expression *)NULL;
+        }
+        break;
+    }
+    if (number_of_variables < 0 || number_of_variables > 26)
+    {
+        fprintf(stderr, "DIMACS formula must declare between 0 and 26 variables in %s at line %d\n", __FILE__, __LINE__);
+        return (compiled_expression *)NULL;
+    }
+
+    program_builder builder;
+    compiled_expression *compiled = start_program(&builder, number_of_variables);
+    if (compiled == NULL)
+    {
+        return (compiled_expression *)NULL;
+    }
+
+    // The formula is the AND of every clause, each clause the OR of its literals
+    int clauses = 0;
+    int clause_literals = 0;
+    bool ok = true;
+    while (ok && (ch = fgetc(file)) != EOF)
+    {
+        if (ch == 'c')
+        {
+            skip_line(file);
+            continue;
+        }
+        if (ch == '%')
+        {
+            break; // End marker of some benchmark files
+        }
+        if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r')
+        {
+            continue;
+        }
+        ungetc(ch, file);
+
+        int literal;
+        if (fscanf(file, "%d", &literal) != 1)
+        {
+            fprintf(stderr, "Invalid DIMACS clause in %s at line %d\n", __FILE__, __LINE__);
+            ok = false;
+        }
+        else if (literal == 0)
+        {
+            if (clause_literals == 0)
+            {
+                ok = append_instruction(&builder, OP_CONSTANT, 0); // The empty clause is false
+            }
+            if (ok && clauses > 0)
+            {
+                ok = append_instruction(&builder, OP_AND, 0);
+            }
+            clauses++;
+            clause_literals = 0;
+        }
+        else if (abs(literal) > number_of_variables)
+        {
+            fprintf(stderr, "DIMACS literal %d is not a declared variable in %s at line %d\n", literal, __FILE__, __LINE__);
+            ok = false;
+        }
+        else
+        {
+            ok = append_instruction(&builder, OP_VARIABLE, abs(literal) - 1);
+            if (ok && literal < 0)
+            {
+                ok = append_instruction(&builder, OP_NOT, 0);
+            }
+            if (ok && clause_literals > 0)
+            {
+                ok = append_instruction(&builder, OP_OR, 0);
+            }
+            clause_literals++;
+        }
+    }
+
+    // A last clause may be missing its terminating 0
+    if (ok && clause_literals > 0 && clauses > 0)
+    {
+        ok = append_instruction(&builder, OP_AND, 0);
+        clauses++;
+    }
+    else if (ok && clause_literals > 0)
+    {
+        clauses++;
+    }
+    // The formula without clauses is true
+    if (ok && clauses == 0)
+    {
+        ok = append_instruction(&builder, OP_CONSTANT, 1);
+    }
+    if (!ok)
+    {
+        free_compiled_expression(compiled);
+        return (compiled_expression *)NULL;
+    }
+    compiled->scratch_words = compiled->max_stack_depth;
+    return compiled;
+}
+
+/**
+ * Decodes one delta of the binary AIGER format, 7 bits per byte with the high bit set on every byte but the last
+ */
+static bool read_delta(FILE *file, unsigned int *delta)
+{
+    unsigned int value = 0;
+    int shift = 0;
+    int ch;
+    while ((ch = fgetc(file)) != EOF)
+    {
+        value |= (unsigned int)(ch & 0x7F) << shift;
+        if (!(ch & 0x80))
+        {
+            *delta = value;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+/**
+ * A node of the graph waiting to be emitted, before (state 0) or after (state 1) its inputs
+ */
+typedef struct
+{
+    unsigned int literal;
+    int state;
+} aiger_frame;
+
+/**
+ * Emits the program for literal in rpn order, visiting the graph with an explicit stack
+ * so deep graphs can't overflow the call stack
+ */
+static bool emit_aiger_literal(program_builder *builder, unsigned int output, unsigned int maximum_variable,
+                               const int *input_column, const unsigned int *first_input, const unsigned int *second_input)
+{
+    int *emitted_at = (int *)malloc((maximum_variable + 1) * sizeof(int));
+    bool *visiting = (bool *)calloc(maximum_variable + 1, sizeof(bool));
+    aiger_frame *frames = (aiger_frame *)malloc((2 * (size_t)maximum_variable + 2) * sizeof(aiger_frame));
+    if (emitted_at == NULL || visiting == NULL || frames == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for and-inverter graph in %s at line %d\n", __FILE__, __LINE__);
+        free(emitted_at);
+        free(visiting);
+        free(frames);
+        return false;
+    }
+    memset(emitted_at, -1, (maximum_variable + 1) * sizeof(int));
+
+    bool ok = true;
+    int top = 0;
+    frames[0] = (aiger_frame){output, 0};
+    while (ok && top >= 0)
+    {
+        aiger_frame *frame = &frames[top];
+        unsigned int variable = frame->literal >> 1;
+        bool is_gate = (variable != 0 && input_column[variable] < 0);
+
+        if (frame->state == 0 && is_gate && emitted_at[variable] < 0)
+        {
+            if (visiting[variable] || first_input[variable] == 0xFFFFFFFFu)
+            {
+                fprintf(stderr, "Undefined or cyclic AIGER literal %u in %s at line %d\n", frame->literal, __FILE__, __LINE__);
+                ok = false;
+                break;
+            }
+            // The first input ends up on top so it is emitted first
+            visiting[variable] = true;
+            frame->state = 1;
+            frames[++top] = (aiger_frame){second_input[variable], 0};
+            frames[++top] = (aiger_frame){first_input[variable], 0};
+            continue;
+        }
+
+        if (frame->state == 1)
+        {
+            ok = append_instruction(builder, OP_AND, 0);
+            emitted_at[variable] = builder->compiled->program_length - 1;
+            visiting[variable] = false;
+        }
+        else if (variable == 0)
+        {
+            ok = append_instruction(builder, OP_CONSTANT, 0);
+        }
+        else if (!is_gate)
+        {
+            ok = append_instruction(builder, OP_VARIABLE, input_column[variable]);
+        }
+        else
+        {
+            ok = append_instruction(builder, OP_COPY, emitted_at[variable]);
+        }
+        if (ok && (frame->literal & 1))
+        {
+            ok = append_instruction(builder, OP_NOT, 0);
+        }
+        top--;
+    }
+
+    free(emitted_at);
+    free(visiting);
+    free(frames);
+    return ok;
+}
+
+compiled_expression *read_aiger(FILE *file)
+{
+    char format[4];
+    unsigned int maximum_variable, inputs, latches, outputs, ands;
+    if (fscanf(file, "%3s %u %u %u %u %u", format, &maximum_variable, &inputs, &latches, &outputs, &ands) != 6 ||
+        (strcmp(format, "aag") != 0 && strcmp(format, "aig") != 0))
+    {
+        fprintf(stderr, "Invalid AIGER header in %s at line %d\n", __FILE__, __LINE__);
+        return (compiled_expression *)NULL;
+    }
+    bool binary = (strcmp(format, "aig") == 0);
+    if (latches != 0 || outputs == 0 || inputs > 26 || inputs + ands > maximum_variable ||
+        maximum_variable > 0x3FFFFFFFu)
+    {
+        fprintf(stderr, "Only combinational AIGER graphs with outputs and at most 26 inputs are supported in %s at line %d\n", __FILE__, __LINE__);
+        return (compiled_expression *)NULL;
+    }
+
+    int *input_column = (int *)malloc((maximum_variable + 1) * sizeof(int));
+    unsigned int *first_input = (unsigned int *)malloc((maximum_variable + 1) * sizeof(unsigned int));
+    unsigned int *second_input = (unsigned int *)malloc((maximum_variable + 1) * sizeof(unsigned int));
+    if (input_column == NULL || first_input == NULL || second_input == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for and-inverter graph in %s at line %d\n", __FILE__, __LINE__);
+        free(input_column);
+        free(first_input);
+        free(second_input);
+        return (compiled_expression *)NULL;
+    }
+    memset(input_column, -1, (maximum_variable + 1) * sizeof(int));
+    memset(first_input, 0xFF, (maximum_variable + 1) * sizeof(unsigned int)); // Not a gate
+
+    bool ok = true;
+    for (unsigned int i = 0; ok && i < inputs; i++)
+    {
+        unsigned int literal = 2 * (i + 1); // Implicit in the binary format
+        if (!binary && (fscanf(file, "%u", &literal) != 1 || literal & 1 || literal < 2 || literal / 2 > maximum_variable))
+        {
+            ok = false;
+        }
+        else
+        {
+            input_column[literal / 2] = i;
+        }
+    }
+
+    unsigned int output = 0;
+    for (unsigned int i = 0; ok && i < outputs; i++)
+    {
+        unsigned int literal;
+        ok = (fscanf(file, "%u", &literal) == 1 && literal / 2 <= maximum_variable);
+        if (i == 0)
+        {
+            output = literal;
+        }
+    }
+
+    if (ok && binary)
+    {
+        skip_line(file); // The gates start after the new line of the last output
+    }
+    for (unsigned int i = 0; ok && i < ands; i++)
+    {
+        unsigned int gate, first, second;
+        if (binary)
+        {
+            unsigned int first_delta, second_delta;
+            gate = 2 * (inputs + latches + i + 1);
+            ok = read_delta(file, &first_delta) && read_delta(file, &second_delta) &&
+                 first_delta <= gate && second_delta <= gate - first_delta;
+            first = gate - first_delta;
+            second = first - second_delta;
+        }
+        else
+        {
+            ok = (fscanf(file, "%u %u %u", &gate, &first, &second) == 3);
+        }
+        if (!ok || gate & 1 || gate < 2 || gate / 2 > maximum_variable || first / 2 > maximum_variable ||
+            second / 2 > maximum_variable || input_column[gate / 2] >= 0)
+        {
+            ok = false;
+            break;
+        }
+        first_input[gate / 2] = first;
+        second_input[gate / 2] = second;
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "Invalid AIGER graph in %s at line %d\n", __FILE__, __LINE__);
+        free(input_column);
+        free(first_input);
+        free(second_input);
+        return (compiled_expression *)NULL;
+    }
+
+    program_builder builder;
+    compiled_expression *compiled = start_program(&builder, inputs);
+    if (compiled == NULL || !emit_aiger_literal(&builder, output, maximum_variable, input_column, first_input, second_input))
+    {
+        free_compiled_expression(compiled);
+        compiled = NULL;
+    }
+    else
+    {
+        // Shared gates are kept after the stack for OP_COPY
+        compiled->scratch_words = compiled->max_stack_depth + compiled->program_length;
+    }
+    free(input_column);
+    free(first_input);
+    free(second_input);
+    return compiled;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdio.h>
+
+#include "../rpn_evaluator/word_evaluation.h"
+
+/**
+ * Function to read a formula in DIMACS CNF and compile it directly, without building an expression string.
+ * Variable k of the file becomes the k-th column of the table, named by the k-th letter (1 is a, 2 is b...),
+ * so at most 26 variables can be declared.
+ * Caller is responsible for freeing the result with free_compiled_expression.
+ * @param file The file the formula is read from
+ * @return The compiled expression, or NULL if the file isn't valid DIMACS CNF
+ */
+compiled_expression *read_dimacs_cnf(FILE *file);
+
+/**
+ * Function to read a combinational and-inverter graph in AIGER format, ASCII (aag) or binary (aig),
+ * and compile its first output directly. And gates used by more than one gate are computed once and
+ * shared with OP_COPY. Inputs become the columns of the table in order, named a, b, c...
+ * so at most 26 inputs are allowed, and latches are not supported.
+ * Caller is responsible for freeing the result with free_compiled_expression.
+ * @param file The file the graph is read from
+ * @return The compiled expression, or NULL if the file isn't a supported AIGER graph
+ */
+compiled_expression *read_aiger(FILE *file);
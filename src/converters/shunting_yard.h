@@ -1,25 +1,27 @@
 #pragma once
-#define MAX_EXPR_SIZE 1000
 
 #include <stdbool.h>
 
 /**
- * Function to convert an infix expression to a rpn expression using the shunting yard algorithm
+ * Function to convert an infix expression to a rpn expression, the one parse_expression produces
+ * Caller is responsible for freeing the memory allocated for the string returned.
  * @param expression The expression being converted
- * @return The expression after the conversion
+ * @return The expression after the conversion, or NULL if it isn't a valid infix expression
 */
 char *shunting_yard(const char *expression);
 
 /**
  * Function to get the infix map of an expression - so where the operators in the infix expression would
- * map onto the rpn expression
+ * map onto the rpn expression - the one parse_expression produces
+ * Caller is responsible for freeing the memory allocated for the array returned.
  * @param expression The infix expression for which we are computing the map
- * @return An array of integers, with array[i] = the possition of the element of rpn[i] in infix
+ * @return An array of integers, with array[i] = the possition of the element of rpn[i] in infix,
+ * or NULL if it isn't a valid infix expression
 */
 int *infix_map(const char *expression);
 
 /**
- * Checks if the expression passed is a valid infix expresson
+ * Checks if the expression passed is a valid infix expresson, as parse_expression decides it
  * @param expression The expression being checked
  * @return true if it is valid, false otherwise
 */
@@ -1,17 +1,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#define MAX_SIZE 1000
-
-typedef struct
-{
-    int top;
-    int items[MAX_SIZE];
-} IntStack;
+#include "int_stack.h"
 
 void int_stack_init(IntStack *stack)
 {
     stack->top = -1;
+    stack->capacity = 0;
+    stack->items = NULL;
+}
+
+int int_stack_init_with_capacity(IntStack *stack, int capacity)
+{
+    int_stack_init(stack);
+    stack->items = (int *)malloc((capacity > 0 ? capacity : 1) * sizeof(int));
+    if (stack->items == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for stack in %s at line %d\n", __FILE__, __LINE__);
+        return 0;
+    }
+    stack->capacity = capacity > 0 ? capacity : 1;
+    return 1;
+}
+
+void int_stack_free(IntStack *stack)
+{
+    free(stack->items);
+    int_stack_init(stack);
 }
 
 int int_stack_is_empty(IntStack *stack)
@@ -21,17 +36,25 @@ int int_stack_is_empty(IntStack *stack)
 
 int int_stack_is_full(IntStack *stack)
 {
-    return stack->top == MAX_SIZE - 1;
+    return stack->top == stack->capacity - 1;
 }
 
-void int_stack_push(IntStack *stack, int value)
+int int_stack_push(IntStack *stack, int value)
 {
     if (int_stack_is_full(stack))
     {
-        fprintf(stderr, "Stack overflow: Cannot push %d, stack is full\n", value);
-        return;
+        int capacity = stack->capacity < 16 ? 16 : stack->capacity * 2;
+        int *items = (int *)realloc(stack->items, capacity * sizeof(int));
+        if (items == NULL)
+        {
+            fprintf(stderr, "Stack overflow: Cannot push %d, failed to grow stack\n", value);
+            return 0;
+        }
+        stack->items = items;
+        stack->capacity = capacity;
     }
     stack->items[++(stack->top)] = value;
+    return 1;
 }
 
 int int_stack_pop(IntStack *stack)
@@ -39,7 +62,7 @@ int int_stack_pop(IntStack *stack)
     if (int_stack_is_empty(stack))
     {
         fprintf(stderr, "Stack underflow: Cannot pop, stack is empty\n");
-        return NULL;
+        return INT_STACK_EMPTY;
     }
     return stack->items[(stack->top)--];
 }
@@ -49,7 +72,7 @@ int int_stack_peek(IntStack *stack)
     if (int_stack_is_empty(stack))
     {
         fprintf(stderr, "Stack is empty: Cannot peek\n");
-        return NULL;
+        return INT_STACK_EMPTY;
     }
     return stack->items[stack->top];
 }
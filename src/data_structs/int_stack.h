@@ -1,28 +1,36 @@
 #pragma once
 
-#define MAX_SIZE 1000 // Define maximum size of the stack
+// Returned by int_stack_pop and int_stack_peek when the stack is empty, the stacks only holding positions and counts
+#define INT_STACK_EMPTY -1
 
-// Stack structure for managing integers
+// Stack structure for managing integers, its storage grows as values are pushed
 typedef struct
 {
-    int top;             
-    int items[MAX_SIZE]; 
+    int top;
+    int capacity;
+    int *items;
 } IntStack;
 
 // Function to initialize the stack
 void int_stack_init(IntStack *stack);
 
+// Function to initialize the stack with room for capacity integers, returns 0 if allocation fails
+int int_stack_init_with_capacity(IntStack *stack, int capacity);
+
+// Function to free the storage of the stack
+void int_stack_free(IntStack *stack);
+
 // Function to check if the stack is empty
 int int_stack_is_empty(IntStack *stack);
 
-// Function to check if the stack is full
+// Function to check if the stack is full, so the next push has to grow its storage
 int int_stack_is_full(IntStack *stack);
 
-// Function to push an integer onto the stack
-void int_stack_push(IntStack *stack, int value);
+// Function to push an integer onto the stack, returns 0 if the stack couldn't grow
+int int_stack_push(IntStack *stack, int value);
 
-// Function to pop an integer from the stack
+// Function to pop an integer from the stack, INT_STACK_EMPTY if it is empty
 int int_stack_pop(IntStack *stack);
 
-// Function to peek at the top integer of the stack without removing it
+// Function to peek at the top integer of the stack without removing it, INT_STACK_EMPTY if it is empty
 int int_stack_peek(IntStack *stack);
@@ -2,21 +2,64 @@
 
 void init_stack(Stack *stack)
 {
+    stack->data = NULL;
     stack->top = -1;
+    stack->capacity = 0;
+    stack->owns_data = true;
 }
 
-void push(Stack *stack, char value)
+bool init_stack_with_capacity(Stack *stack, int capacity)
 {
-    if (stack->top < STACK_SIZE - 1)
+    init_stack(stack);
+    stack->data = (char *)malloc(capacity > 0 ? capacity : 1);
+    if (stack->data == NULL)
     {
-        stack->top++;
-        stack->data[stack->top] = value;
+        fprintf(stderr, "Failed to allocate memory for stack in %s at line %d\n", __FILE__, __LINE__);
+        return false;
     }
-    else
+    stack->capacity = capacity > 0 ? capacity : 1;
+    return true;
+}
+
+void init_stack_with_buffer(Stack *stack, char *buffer, int capacity)
+{
+    stack->data = buffer;
+    stack->top = -1;
+    stack->capacity = capacity;
+    stack->owns_data = false;
+}
+
+void free_stack(Stack *stack)
+{
+    if (stack->owns_data)
+    {
+        free(stack->data);
+    }
+    init_stack(stack);
+}
+
+bool push(Stack *stack, char value)
+{
+    if (stack->top == stack->capacity - 1)
     {
-        fprintf(stderr, "Error: Stack overflow\n");
-        return;
+        int capacity = stack->capacity < 16 ? 16 : stack->capacity * 2;
+        char *data = (char *)(stack->owns_data ? realloc(stack->data, capacity) : malloc(capacity));
+        if (data == NULL)
+        {
+            fprintf(stderr, "Error: Failed to grow stack in %s at line %d\n", __FILE__, __LINE__);
+            return false;
+        }
+        if (!stack->owns_data)
+        {
+            memcpy(data, stack->data, stack->capacity);
+            stack->owns_data = true;
+        }
+        stack->data = data;
+        stack->capacity = capacity;
     }
+    stack->top++;
+    stack->data[stack->top] = value;
+    return true;
 }
 
 char pop(Stack *stack)
@@ -30,7 +73,7 @@ char pop(Stack *stack)
     else
     {
         fprintf(stderr, "Error: Stack underflow\n");
-        return NULL;
+        return STACK_EMPTY;
     }
 }
 
@@ -41,10 +84,10 @@ bool is_empty(Stack *stack)
 
 char peek(Stack *stack)
 {
-    if (stack->data[stack->top] < 0)
+    if (stack->top < 0)
     {
         fprintf(stderr, "Error: Stack underflow\n");
-        return NULL;
+        return STACK_EMPTY;
     }
     return stack->data[stack->top];
 }
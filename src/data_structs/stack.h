@@ -5,26 +5,38 @@
 #include <stdbool.h>
 #include <string.h>
 
-#define STACK_SIZE 1000
+// Returned by pop and peek when the stack is empty, never pushed since values are tokens or '0' and '1'
+#define STACK_EMPTY '\0'
 
-// Structure representing a stack for char values
+// Structure representing a stack for char values, its storage grows as values are pushed
 typedef struct
 {
-    char data[STACK_SIZE];
+    char *data;
     int top;
+    int capacity;
+    bool owns_data; // False while data is storage given by the caller
 } Stack;
 
-// Function to push a char value onto the stack
-void push(Stack *stack, char value);
+// Function to push a char value onto the stack, returns false if the stack couldn't grow
+bool push(Stack *stack, char value);
 
-// Function to pop a char value from the stack
+// Function to pop a char value from the stack, STACK_EMPTY if it is empty
 char pop(Stack *stack);
 
-// Function to initialise the stack
+// Function to initialise an empty stack
 void init_stack(Stack *stack);
 
-// Function to peek the top element
+// Function to initialise a stack with room for capacity values, returns false if allocation fails
+bool init_stack_with_capacity(Stack *stack, int capacity);
+
+// Function to initialise a stack on storage owned by the caller, only moved to the heap if it has to grow
+void init_stack_with_buffer(Stack *stack, char *buffer, int capacity);
+
+// Function to free the storage of the stack
+void free_stack(Stack *stack);
+
+// Function to peek the top element, STACK_EMPTY if the stack is empty
 char peek(Stack *stack);
 
 // Function to check if the stack is empty
-bool is_empty(Stack *stack);
\ No newline at end of file
+bool is_empty(Stack *stack);
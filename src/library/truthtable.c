@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "../converters/expression_parser.h"
+#include "../table_builders_for_webpage/table_builders.h"
+#include "../utils/parallel_scan.h"
+
+#include "truthtable.h"
+
+// Smallest number of words worth handing to a counting thread
+#define COUNT_GRAIN 4096
+
+struct truthtable_expression
+{
+    parsed_expression *parsed;
+    row_formatter *formatter;
+    char *header; // Header and separator
+    int64_t number_of_rows;
+};
+
+/**
+ * Context shared by the threads counting true rows
+ */
+typedef struct
+{
+    const row_formatter *formatter;
+    uint64_t mask;
+    atomic_llong count;
+    atomic_int out_of_memory;
+} count_context;
+
+/**
+ * Scratch space of one evaluation of the formatter
+ */
+typedef struct
+{
+    uint64_t *variable_words;
+    uint64_t *slots;
+} evaluation_scratch;
+
+static bool allocate_scratch(const row_formatter *formatter, evaluation_scratch *scratch)
+{
+    scratch->variable_words = (uint64_t *)malloc((formatter->number_of_variables + 1) * sizeof(uint64_t));
+    scratch->slots = (uint64_t *)malloc((formatter->compiled->program_length + 1) * sizeof(uint64_t));
+    return scratch->variable_words != NULL && scratch->slots != NULL;
+}
+
+static void free_scratch(evaluation_scratch *scratch)
+{
+    free(scratch->variable_words);
+    free(scratch->slots);
+}
+
+/**
+ * Result column of an evaluated word, expressions with a blank result column having no true rows like on the command line
+ */
+static uint64_t result_word(const row_formatter *formatter, const evaluation_scratch *scratch)
+{
+    return formatter->result_slot >= 0 ? scratch->slots[formatter->result_slot] : 0;
+}
+
+/**
+ * Header and separator of the table of a parsed expression, the same text as generate_header and
+ * generate_separator give, but NULL instead of exiting when memory can't be allocated
+ */
+static char *generate_table_header(const parsed_expression *parsed)
+{
+    // Variables, ": ", the expression, " : Result\n" and a separator line as long as that
+    int header_length = parsed->number_of_variables * 2 + parsed->expression_length + 12;
+    char *header = (char *)malloc(header_length * 2 + 1);
+    if (header == NULL)
+    {
+        return (char *)NULL;
+    }
+    int offset = 0;
+    for (int i = 0; i < parsed->number_of_variables; i++)
+    {
+        header[offset++] = parsed->variables[i];
+        header[offset++] = ' ';
+    }
+    offset += sprintf(header + offset, ": %s : Result\n", parsed->expression);
+    memset(header + offset, '=', header_length - 1);
+    header[offset + header_length - 1] = '\n';
+    header[offset + header_length] = '\0';
+    return header;
+}
+
+int truthtable_compile(const char *expression, truthtable_expression **compiled)
+{
+    if (compiled == NULL)
+    {
+        return TRUTHTABLE_INVALID_ARGUMENT;
+    }
+    *compiled = NULL;
+    if (expression == NULL)
+    {
+        return TRUTHTABLE_INVALID_ARGUMENT;
+    }
+    truthtable_expression *result = (truthtable_expression *)calloc(1, sizeof(truthtable_expression));
+    if (result == NULL)
+    {
+        return TRUTHTABLE_OUT_OF_MEMORY;
+    }
+    result->parsed = parse_expression(expression);
+    if (result->parsed == NULL)
+    {
+        free(result);
+        return TRUTHTABLE_INVALID_EXPRESSION;
+    }
+    result->formatter = create_parsed_row_formatter(result->parsed);
+    if (result->formatter == NULL)
+    {
+        truthtable_free(result);
+        return TRUTHTABLE_OUT_OF_MEMORY;
+    }
+    result->header = generate_table_header(result->parsed);
+    if (result->header == NULL)
+    {
+        truthtable_free(result);
+        return TRUTHTABLE_OUT_OF_MEMORY;
+    }
+    result->number_of_rows = (int64_t)1 << result->formatter->number_of_variables;
+    *compiled = result;
+    return TRUTHTABLE_OK;
+}
+
+void truthtable_free(truthtable_expression *compiled)
+{
+    if (compiled == NULL)
+    {
+        return;
+    }
+    free_row_formatter(compiled->formatter);
+    free_parsed_expression(compiled->parsed);
+    free(compiled->header);
+    free(compiled);
+}
+
+int truthtable_number_of_variables(const truthtable_expression *compiled)
+{
+    return compiled == NULL ? TRUTHTABLE_INVALID_ARGUMENT : compiled->formatter->number_of_variables;
+}
+
+int truthtable_row_length(const truthtable_expression *compiled)
+{
+    return compiled == NULL ? TRUTHTABLE_INVALID_ARGUMENT : compiled->formatter->row_length;
+}
+
+int truthtable_header(const truthtable_expression *compiled, char *buffer, size_t capacity, size_t *written)
+{
+    if (compiled == NULL || buffer == NULL || written == NULL)
+    {
+        return TRUTHTABLE_INVALID_ARGUMENT;
+    }
+    *written = strlen(compiled->header);
+    if (*written + 1 > capacity)
+    {
+        return TRUTHTABLE_BUFFER_TOO_SMALL;
+    }
+    memcpy(buffer, compiled->header, *written + 1);
+    return TRUTHTABLE_OK;
+}
+
+int truthtable_segment(const truthtable_expression *compiled, int64_t start_row, int64_t end_row, char *buffer, size_t capacity, size_t *written)
+{
+    if (compiled == NULL || buffer == NULL || written == NULL || start_row < 0 || end_row < start_row)
+    {
+        return TRUTHTABLE_INVALID_ARGUMENT;
+    }
+    const row_formatter *formatter = compiled->formatter;
+    if (end_row > compiled->number_of_rows)
+    {
+        end_row = compiled->number_of_rows;
+    }
+    if (start_row > end_row)
+    {
+        start_row = end_row;
+    }
+    *written = (size_t)(end_row - start_row) * formatter->row_length;
+    if (*written + 1 > capacity)
+    {
+        return TRUTHTABLE_BUFFER_TOO_SMALL;
+    }
+
+    evaluation_scratch scratch;
+    if (!allocate_scratch(formatter, &scratch))
+    {
+        free_scratch(&scratch);
+        return TRUTHTABLE_OUT_OF_MEMORY;
+    }
+    int64_t written_rows = 0;
+    for (int64_t word = start_row >> 6; word * 64 < end_row; word++)
+    {
+        int first_bit = word * 64 < start_row ? start_row - word * 64 : 0;
+        int end_bit = end_row - word * 64 < 64 ? end_row - word * 64 : 64;
+        evaluate_formatter_word(formatter, word, scratch.variable_words, scratch.slots);
+        written_rows += format_word_rows(formatter, scratch.slots, word, first_bit, end_bit, false,
+                                         buffer + written_rows * formatter->row_length);
+    }
+    buffer[*written] = '\0';
+    free_scratch(&scratch);
+    return TRUTHTABLE_OK;
+}
+
+int truthtable_next_true_rows(const truthtable_expression *compiled, int64_t *cursor, char *buffer, size_t capacity, size_t *written)
+{
+    if (compiled == NULL || cursor == NULL || buffer == NULL || written == NULL || *cursor < 0 || capacity == 0)
+    {
+        return TRUTHTABLE_INVALID_ARGUMENT;
+    }
+    const row_formatter *formatter = compiled->formatter;
+    int64_t row_capacity = (int64_t)(capacity - 1) / formatter->row_length;
+    *written = 0;
+    buffer[0] = '\0';
+    if (*cursor >= compiled->number_of_rows)
+    {
+        *cursor = compiled->number_of_rows;
+        return TRUTHTABLE_OK;
+    }
+    if (row_capacity == 0)
+    {
+        *written = formatter->row_length;
+        return TRUTHTABLE_BUFFER_TOO_SMALL;
+    }
+
+    evaluation_scratch scratch;
+    if (!allocate_scratch(formatter, &scratch))
+    {
+        free_scratch(&scratch);
+        return TRUTHTABLE_OUT_OF_MEMORY;
+    }
+    int64_t written_rows = 0;
+    while (*cursor < compiled->number_of_rows && written_rows < row_capacity)
+    {
+        int64_t word = *cursor >> 6;
+        int first_bit = *cursor & 63;
+        int end_bit = compiled->number_of_rows - word * 64 < 64 ? compiled->number_of_rows - word * 64 : 64;
+        evaluate_formatter_word(formatter, word, scratch.variable_words, scratch.slots);
+
+        // Stopping after the last true row that fits, so the next call starts right after it
+        uint64_t true_rows = (result_word(formatter, &scratch) >> first_bit) << first_bit;
+        if (end_bit < 64)
+        {
+            true_rows &= (1ULL << end_bit) - 1;
+        }
+        for (int64_t room = row_capacity - written_rows; __builtin_popcountll(true_rows) > room;)
+        {
+            end_bit = 63 - __builtin_clzll(true_rows);
+            true_rows &= ~(1ULL << end_bit);
+        }
+        written_rows += format_word_rows(formatter, scratch.slots, word, first_bit, end_bit, true,
+                                         buffer + written_rows * formatter->row_length);
+        *cursor = word * 64 + end_bit;
+    }
+    *written = (size_t)written_rows * formatter->row_length;
+    buffer[*written] = '\0';
+    free_scratch(&scratch);
+    return TRUTHTABLE_OK;
+}
+
+static void count_task(void *arg, int64_t start, int64_t end)
+{
+    count_context *context = (count_context *)arg;
+    evaluation_scratch scratch;
+    if (!allocate_scratch(context->formatter, &scratch))
+    {
+        free_scratch(&scratch);
+        atomic_store(&context->out_of_memory, 1);
+        return;
+    }
+    long long count = 0;
+    for (int64_t word = start; word < end; word++)
+    {
+        evaluate_formatter_word(context->formatter, word, scratch.variable_words, scratch.slots);
+        count += __builtin_popcountll(result_word(context->formatter, &scratch) & context->mask);
+    }
+    atomic_fetch_add(&context->count, count);
+    free_scratch(&scratch);
+}
+
+int truthtable_count_true_rows(const truthtable_expression *compiled, int64_t *count)
+{
+    if (compiled == NULL || count == NULL)
+    {
+        return TRUTHTABLE_INVALID_ARGUMENT;
+    }
+    count_context context;
+    context.formatter = compiled->formatter;
+    context.mask = valid_rows_mask(compiled->formatter->number_of_variables);
+    atomic_init(&context.count, 0);
+    atomic_init(&context.out_of_memory, 0);
+    parallel_for_range(number_of_words(compiled->formatter->number_of_variables), COUNT_GRAIN, count_task, &context);
+    if (atomic_load(&context.out_of_memory))
+    {
+        return TRUTHTABLE_OUT_OF_MEMORY;
+    }
+    *count = atomic_load(&context.count);
+    return TRUTHTABLE_OK;
+}
+
+const char *truthtable_status_message(int status)
+{
+    switch (status)
+    {
+    case TRUTHTABLE_OK:
+        return "Success";
+    case TRUTHTABLE_INVALID_EXPRESSION:
+        return "Variables must be a-z lowercase. Operators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT";
+    case TRUTHTABLE_INVALID_ARGUMENT:
+        return "Invalid argument";
+    case TRUTHTABLE_BUFFER_TOO_SMALL:
+        return "Buffer too small";
+    case TRUTHTABLE_OUT_OF_MEMORY:
+        return "Out of memory";
+    default:
+        return "Unknown status";
+    }
+}
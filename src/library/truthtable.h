@@ -0,0 +1,106 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * C API of libtruthtable.so, for generating truth tables in process instead of running website_binary_ttable.
+ * Functions report failures through their return value and never exit, all buffers are owned by the caller.
+ * Rows, headers and separators are the same text as the command line prints.
+ */
+
+/**
+ * Values returned by the functions of the library
+ */
+typedef enum
+{
+    TRUTHTABLE_OK = 0,
+    TRUTHTABLE_INVALID_EXPRESSION = -1, // Not a valid infix or postfix expression
+    TRUTHTABLE_INVALID_ARGUMENT = -2,   // NULL pointer or a row outside the table
+    TRUTHTABLE_BUFFER_TOO_SMALL = -3,   // Nothing was written, the size needed is given back
+    TRUTHTABLE_OUT_OF_MEMORY = -4
+} truthtable_status;
+
+/**
+ * An expression compiled once for all the tables generated from it, safe to use from several threads at once
+ */
+typedef struct truthtable_expression truthtable_expression;
+
+/**
+ * Function to compile an expression.
+ * Caller is responsible for freeing the result with truthtable_free.
+ * @param expression The infix or postfix expression
+ * @param compiled Receives the compiled expression, NULL on failure
+ * @return TRUTHTABLE_OK, TRUTHTABLE_INVALID_EXPRESSION, TRUTHTABLE_INVALID_ARGUMENT or TRUTHTABLE_OUT_OF_MEMORY
+ */
+int truthtable_compile(const char *expression, truthtable_expression **compiled);
+
+/**
+ * Function to free a compiled expression
+ * @param compiled The compiled expression, may be NULL
+ */
+void truthtable_free(truthtable_expression *compiled);
+
+/**
+ * Function to get the number of variables of a compiled expression, the table having 2^n rows
+ * @param compiled The compiled expression
+ * @return The number of variables, or TRUTHTABLE_INVALID_ARGUMENT
+ */
+int truthtable_number_of_variables(const truthtable_expression *compiled);
+
+/**
+ * Function to get the length of every row of the table, new line included
+ * @param compiled The compiled expression
+ * @return The row length, or TRUTHTABLE_INVALID_ARGUMENT
+ */
+int truthtable_row_length(const truthtable_expression *compiled);
+
+/**
+ * Function to write the header and separator of the table, null terminated
+ * @param compiled The compiled expression
+ * @param buffer The buffer written to
+ * @param capacity The size of the buffer
+ * @param written Receives the number of characters written without the null, or needed on TRUTHTABLE_BUFFER_TOO_SMALL
+ * @return TRUTHTABLE_OK, TRUTHTABLE_INVALID_ARGUMENT or TRUTHTABLE_BUFFER_TOO_SMALL
+ */
+int truthtable_header(const truthtable_expression *compiled, char *buffer, size_t capacity, size_t *written);
+
+/**
+ * Function to write the rows [start_row, end_row) of the table, null terminated
+ * @param compiled The compiled expression
+ * @param start_row The first row
+ * @param end_row The row after the last row, clamped to the size of the table
+ * @param buffer The buffer written to
+ * @param capacity The size of the buffer, (end_row - start_row) * row length + 1 is enough
+ * @param written Receives the number of characters written without the null, or needed on TRUTHTABLE_BUFFER_TOO_SMALL
+ * @return TRUTHTABLE_OK, TRUTHTABLE_INVALID_ARGUMENT, TRUTHTABLE_BUFFER_TOO_SMALL or TRUTHTABLE_OUT_OF_MEMORY
+ */
+int truthtable_segment(const truthtable_expression *compiled, int64_t start_row, int64_t end_row, char *buffer, size_t capacity, size_t *written);
+
+/**
+ * Function to iterate over the true rows of the table, writing as many of them as fit in the buffer,
+ * null terminated. Called again with the same cursor, it carries on where the last call stopped.
+ * @param compiled The compiled expression
+ * @param cursor The row the search starts from, 0 for the first call, moved past the rows written.
+ * It is the number of rows of the table once every true row was written.
+ * @param buffer The buffer written to
+ * @param capacity The size of the buffer, at least one row length + 1
+ * @param written Receives the number of characters written without the null, 0 once the iteration is over
+ * @return TRUTHTABLE_OK, TRUTHTABLE_INVALID_ARGUMENT, TRUTHTABLE_BUFFER_TOO_SMALL or TRUTHTABLE_OUT_OF_MEMORY
+ */
+int truthtable_next_true_rows(const truthtable_expression *compiled, int64_t *cursor, char *buffer, size_t capacity, size_t *written);
+
+/**
+ * Function to count the true rows of the table, using parallel threads for large tables
+ * @param compiled The compiled expression
+ * @param count Receives the number of true rows
+ * @return TRUTHTABLE_OK, TRUTHTABLE_INVALID_ARGUMENT or TRUTHTABLE_OUT_OF_MEMORY
+ */
+int truthtable_count_true_rows(const truthtable_expression *compiled, int64_t *count);
+
+/**
+ * Function to describe a value returned by the library
+ * @param status The value
+ * @return A static description of it
+ */
+const char *truthtable_status_message(int status);
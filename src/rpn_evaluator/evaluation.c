@@ -4,9 +4,13 @@
 #include <string.h>
 
 #include "../data_structs/stack.h"
+#include "../converters/functions.h"
 
 #include "evaluation.h"
 
+// Depth of the stack evaluate_expr keeps on its own frame, deeper expressions move it to the heap
+#define EVALUATION_STACK_SIZE 256
+
 static bool apply_operator(char operator, bool operand1, bool operand2)
 {
     bool result;
@@ -30,6 +34,15 @@ static bool apply_operator(char operator, bool operand1, bool operand2)
     case '-':
         result = !operand1;
         break;
+    case FUNCTION_NAND:
+        result = !(operand1 && operand2);
+        break;
+    case FUNCTION_NOR:
+        result = !(operand1 || operand2);
+        break;
+    case FUNCTION_XOR:
+        result = operand1 != operand2;
+        break;
     default:
         fprintf(stderr, "Error: Unknwon operator %c\n", operator);
         return NULL;
@@ -41,9 +54,20 @@ static bool apply_operator(char operator, bool operand1, bool operand2)
 char *evaluate_expr(const char *expression)
 {
     Stack stack;
-    init_stack(&stack);
+    char stack_buffer[EVALUATION_STACK_SIZE];
     int len = strlen(expression);
     char *output = (char *)malloc((len + 1) * sizeof(char)); // Allocate memory for the output string
+    // No expression of length len can need a deeper stack, so it is only allocated for long expressions
+    // and pushes never have to grow it. Called for every row of the legacy tables.
+    if (len <= EVALUATION_STACK_SIZE)
+    {
+        init_stack_with_buffer(&stack, stack_buffer, EVALUATION_STACK_SIZE);
+    }
+    else if (output != NULL && !init_stack_with_capacity(&stack, len))
+    {
+        free(output);
+        output = NULL;
+    }
     if (output == NULL)
     {
         fprintf(stderr, "Memory allocation failed in %s\n", __FILE__);
@@ -61,14 +85,16 @@ char *evaluate_expr(const char *expression)
             output[output_index++] = ' ';
         }
         // Evaluating for operators
-        else if (token == '|' || token == '&' || token == '#' || token == '>' || token == '=')
+        else if (token == '|' || token == '&' || token == '#' || token == '>' || token == '=' ||
+                 function_operands(token) == 2)
         {
             char elem1 = pop(&stack);
             char elem2 = pop(&stack);
-            if (elem1 == NULL || elem2 == NULL)
+            if (elem1 == STACK_EMPTY || elem2 == STACK_EMPTY)
             {
                 fprintf(stderr, "Error: Bad Expression in %s at line %d", __FILE__, __LINE__);
                 free(output);
+                free_stack(&stack);
                 return NULL;
             }
             bool operand2 = (elem2 == '1');
@@ -83,10 +109,11 @@ char *evaluate_expr(const char *expression)
         else if (token == '-')
         {
             char elem1 = pop(&stack);
-            if (elem1 == NULL)
+            if (elem1 == STACK_EMPTY)
             {
                 fprintf(stderr, "Error: Bad Expression in %s at line %d", __FILE__, __LINE__);
                 free(output);
+                free_stack(&stack);
                 return NULL;
             }
 
@@ -96,6 +123,32 @@ char *evaluate_expr(const char *expression)
             push(&stack, result ? '1' : '0');
         }
 
+        // Evaluating MUX and majority, the first operand being the deepest on the stack
+        else if (function_operands(token) == 3)
+        {
+            char third = pop(&stack);
+            char second = pop(&stack);
+            char first = pop(&stack);
+            if (first == STACK_EMPTY || second == STACK_EMPTY || third == STACK_EMPTY)
+            {
+                fprintf(stderr, "Error: Bad Expression in %s at line %d", __FILE__, __LINE__);
+                free(output);
+                free_stack(&stack);
+                return NULL;
+            }
+            bool result;
+            if (token == FUNCTION_MUX)
+            {
+                result = first == '1' ? second == '1' : third == '1';
+            }
+            else
+            {
+                result = (first == '1') + (second == '1') + (third == '1') >= 2;
+            }
+            output[output_index++] = result ? '1' : '0';
+            push(&stack, result ? '1' : '0');
+        }
+
         // Evaluating constants
         else if (token == '1' || token == '0')
         {
@@ -107,6 +160,7 @@ char *evaluate_expr(const char *expression)
         else
         {
             free(output); // Free allocated memory before exiting
+            free_stack(&stack);
             fprintf(stderr, "Error: Bad Expression\n");
             return NULL;
         }
@@ -116,8 +170,10 @@ char *evaluate_expr(const char *expression)
     {
         fprintf(stderr, "Bad expression\n");
         free(output);
+        free_stack(&stack);
         return NULL;
     }
+    free_stack(&stack);
 
     output[output_index] = '\0'; // Null-terminate the output string
     return output;
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "jit.h"
+
+#if defined(__x86_64__) && !defined(NO_JIT)
+
+// Registers used by the generated code, numbered as in the ModRM byte
+#define REG_RAX 0
+#define REG_RDX 2
+#define REG_RSI 6 // slots
+#define REG_RDI 7 // variable_words
+
+// Opcodes of the 64 bit register, memory instructions
+#define OPCODE_LOAD 0x8B
+#define OPCODE_STORE 0x89
+#define OPCODE_AND 0x23
+#define OPCODE_OR 0x0B
+#define OPCODE_XOR 0x33
+
+// Opcodes of the 64 bit register, register instructions, destination in the r/m field
+#define OPCODE_MOVE_REGISTER 0x89
+#define OPCODE_OR_REGISTER 0x09
+
+// Longest code emitted for a single instruction, in bytes, OP_XOR_N adding a memory instruction per operand
+#define MAX_INSTRUCTION_CODE 48
+#define MEMORY_INSTRUCTION_CODE 7
+
+/**
+ * Where an operand of the simulated stack lives, either a slot or a variable word
+ */
+typedef struct
+{
+    int base;  // REG_RSI for slots, REG_RDI for variables
+    int index; // Slot or variable index
+} operand;
+
+/**
+ * Buffer the machine code is written to
+ */
+typedef struct
+{
+    unsigned char *code;
+    size_t length;
+} code_buffer;
+
+static void emit_byte(code_buffer *buffer, unsigned char byte)
+{
+    buffer->code[buffer->length++] = byte;
+}
+
+/**
+ * Emits "opcode reg, [base + 8 * index]" (or the store form) with a 32 bit displacement
+ */
+static void emit_memory_instruction(code_buffer *buffer, unsigned char opcode, int reg, operand location)
+{
+    int32_t displacement = location.index * 8;
+    emit_byte(buffer, 0x48); // REX.W, 64 bit operands
+    emit_byte(buffer, opcode);
+    emit_byte(buffer, 0x80 | (reg << 3) | location.base);
+    memcpy(buffer->code + buffer->length, &displacement, sizeof(displacement));
+    buffer->length += sizeof(displacement);
+}
+
+/**
+ * Emits "opcode destination, source" between two registers
+ */
+static void emit_register_instruction(code_buffer *buffer, unsigned char opcode, int destination, int source)
+{
+    emit_byte(buffer, 0x48);
+    emit_byte(buffer, opcode);
+    emit_byte(buffer, 0xC0 | (source << 3) | destination);
+}
+
+static void emit_not(code_buffer *buffer, int reg)
+{
+    emit_byte(buffer, 0x48);
+    emit_byte(buffer, 0xF7);
+    emit_byte(buffer, 0xD0 | reg);
+}
+
+static void emit_constant(code_buffer *buffer, int value)
+{
+    if (value)
+    {
+        // mov rax, -1
+        emit_byte(buffer, 0x48);
+        emit_byte(buffer, 0xC7);
+        emit_byte(buffer, 0xC0);
+        emit_byte(buffer, 0xFF);
+        emit_byte(buffer, 0xFF);
+        emit_byte(buffer, 0xFF);
+        emit_byte(buffer, 0xFF);
+    }
+    else
+    {
+        // xor eax, eax
+        emit_byte(buffer, 0x31);
+        emit_byte(buffer, 0xC0);
+    }
+}
+
+static unsigned char binary_opcode(opcode op)
+{
+    switch (op)
+    {
+    case OP_AND:
+    case OP_NAND:
+        return OPCODE_AND;
+    case OP_OR:
+    case OP_NOR:
+        return OPCODE_OR;
+    default:
+        return OPCODE_XOR; // XOR and IFF
+    }
+}
+
+native_expression *compile_native(const compiled_expression *compiled)
+{
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t code_bytes = 1;
+    for (int i = 0; i < compiled->program_length; i++)
+    {
+        code_bytes += MAX_INSTRUCTION_CODE;
+        if (compiled->program[i].op == OP_XOR_N)
+        {
+            code_bytes += (size_t)compiled->program[i].operand * MEMORY_INSTRUCTION_CODE;
+        }
+    }
+    size_t code_size = (code_bytes + page_size - 1) / page_size * page_size;
+    operand *stack = (operand *)malloc((compiled->max_stack_depth + 1) * sizeof(operand));
+    native_expression *native = (native_expression *)malloc(sizeof(native_expression));
+    if (stack == NULL || native == NULL)
+    {
+        free(stack);
+        free(native);
+        return (native_expression *)NULL;
+    }
+
+    void *code = mmap(NULL, code_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED)
+    {
+        free(stack);
+        free(native);
+        return (native_expression *)NULL;
+    }
+
+    code_buffer buffer = {(unsigned char *)code, 0};
+    int top = -1;
+    int rax_slot = -1; // Slot whose value rax still holds, -1 if none
+    for (int i = 0; i < compiled->program_length; i++)
+    {
+        const instruction *current = &compiled->program[i];
+        operand result = {REG_RSI, i};
+        bool last = (i == compiled->program_length - 1);
+
+        if (current->op == OP_VARIABLE && !last)
+        {
+            // Variables are read straight from variable_words by the operators using them
+            stack[++top] = (operand){REG_RDI, current->operand};
+            continue;
+        }
+
+        // Shared results are read from where the instruction that computed them left them
+        operand copied = {REG_RSI, current->operand};
+        if (current->op == OP_COPY && compiled->program[current->operand].op == OP_VARIABLE)
+        {
+            copied = (operand){REG_RDI, compiled->program[current->operand].operand};
+        }
+        if (current->op == OP_COPY && !last)
+        {
+            stack[++top] = copied;
+            continue;
+        }
+
+        if (current->op == OP_VARIABLE)
+        {
+            emit_memory_instruction(&buffer, OPCODE_LOAD, REG_RAX, (operand){REG_RDI, current->operand});
+            top++;
+        }
+        else if (current->op == OP_COPY)
+        {
+            emit_memory_instruction(&buffer, OPCODE_LOAD, REG_RAX, copied);
+            top++;
+        }
+        else if (current->op == OP_CONSTANT)
+        {
+            emit_constant(&buffer, current->operand);
+            top++;
+        }
+        else if (current->op == OP_NOT)
+        {
+            operand value = stack[top];
+            if (!(value.base == REG_RSI && value.index == rax_slot))
+            {
+                emit_memory_instruction(&buffer, OPCODE_LOAD, REG_RAX, value);
+            }
+            emit_not(&buffer, REG_RAX);
+        }
+        else if (current->op == OP_XOR_N)
+        {
+            // Starts from the operand rax may already hold, XOR being commutative
+            int first = top - current->operand + 1;
+            int in_rax = first;
+            for (int k = first; k <= top; k++)
+            {
+                if (stack[k].base == REG_RSI && stack[k].index == rax_slot)
+                {
+                    in_rax = k;
+                }
+            }
+            if (!(stack[in_rax].base == REG_RSI && stack[in_rax].index == rax_slot))
+            {
+                emit_memory_instruction(&buffer, OPCODE_LOAD, REG_RAX, stack[in_rax]);
+            }
+            for (int k = first; k <= top; k++)
+            {
+                if (k != in_rax)
+                {
+                    emit_memory_instruction(&buffer, OPCODE_XOR, REG_RAX, stack[k]);
+                }
+            }
+            top = first;
+        }
+        else if (current->op == OP_MUX || current->op == OP_MAJORITY)
+        {
+            operand third = stack[top--];
+            operand second = stack[top--];
+            operand first = stack[top];
+            operand loaded = current->op == OP_MUX ? second : first;
+            if (!(loaded.base == REG_RSI && loaded.index == rax_slot))
+            {
+                emit_memory_instruction(&buffer, OPCODE_LOAD, REG_RAX, loaded);
+            }
+            if (current->op == OP_MUX)
+            {
+                // third ^ (first & (second ^ third))
+                emit_memory_instruction(&buffer, OPCODE_XOR, REG_RAX, third);
+                emit_memory_instruction(&buffer, OPCODE_AND, REG_RAX, first);
+                emit_memory_instruction(&buffer, OPCODE_XOR, REG_RAX, third);
+            }
+            else
+            {
+                // (first & second) | (third & (first | second))
+                emit_register_instruction(&buffer, OPCODE_MOVE_REGISTER, REG_RDX, REG_RAX);
+                emit_memory_instruction(&buffer, OPCODE_AND, REG_RAX, second);
+                emit_memory_instruction(&buffer, OPCODE_OR, REG_RDX, second);
+                emit_memory_instruction(&buffer, OPCODE_AND, REG_RDX, third);
+                emit_register_instruction(&buffer, OPCODE_OR_REGISTER, REG_RAX, REG_RDX);
+            }
+        }
+        else
+        {
+            operand right = stack[top--];
+            operand left = stack[top];
+            bool rax_left = (left.base == REG_RSI && left.index == rax_slot);
+            bool rax_right = (right.base == REG_RSI && right.index == rax_slot);
+
+            if (current->op == OP_IMPLICATION)
+            {
+                // Same operand order as evaluate_word: ~right | left
+                if (rax_right)
+                {
+                    emit_not(&buffer, REG_RAX);
+                    emit_memory_instruction(&buffer, OPCODE_OR, REG_RAX, left);
+                }
+                else
+                {
+                    if (!rax_left)
+                    {
+                        emit_memory_instruction(&buffer, OPCODE_LOAD, REG_RAX, left);
+                    }
+                    emit_memory_instruction(&buffer, OPCODE_LOAD, REG_RDX, right);
+                    emit_not(&buffer, REG_RDX);
+                    emit_register_instruction(&buffer, OPCODE_OR_REGISTER, REG_RAX, REG_RDX);
+                }
+            }
+            else
+            {
+                // AND, OR, XOR and IFF are commutative so either operand may already be in rax
+                if (rax_left)
+                {
+                    emit_memory_instruction(&buffer, binary_opcode(current->op), REG_RAX, right);
+                }
+                else if (rax_right)
+                {
+                    emit_memory_instruction(&buffer, binary_opcode(current->op), REG_RAX, left);
+                }
+                else
+                {
+                    emit_memory_instruction(&buffer, OPCODE_LOAD, REG_RAX, left);
+                    emit_memory_instruction(&buffer, binary_opcode(current->op), REG_RAX, right);
+                }
+                if (current->op == OP_IFF || current->op == OP_NAND || current->op == OP_NOR)
+                {
+                    emit_not(&buffer, REG_RAX);
+                }
+            }
+        }
+
+        // Spill the result to its slot for the row formatter
+        emit_memory_instruction(&buffer, OPCODE_STORE, REG_RAX, result);
+        stack[top] = result;
+        rax_slot = i;
+    }
+    emit_byte(&buffer, 0xC3); // ret
+    free(stack);
+
+    if (mprotect(code, code_size, PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(code, code_size);
+        free(native);
+        return (native_expression *)NULL;
+    }
+
+    native->code = code;
+    native->code_size = code_size;
+    native->function = (native_word_function)code;
+    return native;
+}
+
+void free_native_expression(native_expression *native)
+{
+    if (native == NULL)
+    {
+        return;
+    }
+    munmap(native->code, native->code_size);
+    free(native);
+}
+
+#else
+
+native_expression *compile_native(const compiled_expression *compiled)
+{
+    (void)compiled;
+    return (native_expression *)NULL;
+}
+
+void free_native_expression(native_expression *native)
+{
+    (void)native;
+}
+
+#endif
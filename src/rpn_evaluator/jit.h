@@ -0,0 +1,41 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "word_evaluation.h"
+
+/**
+ * Signature of the machine code generated for a compiled expression.
+ * @param variable_words The values of every variable over the current 64 rows, see fill_variable_words
+ * @param slots Receives the result of every instruction of the compiled expression, slot i holding
+ * the value of instruction i over the 64 rows, the layout evaluate_word_slots writes
+ */
+typedef void (*native_word_function)(const uint64_t *variable_words, uint64_t *slots);
+
+/**
+ * Straight-line x86-64 machine code for a compiled expression
+ */
+typedef struct
+{
+    native_word_function function;
+    void *code;       // Start of the mapped pages
+    size_t code_size; // Size of the mapped pages
+} native_expression;
+
+/**
+ * Function to translate a compiled expression into straight-line x86-64 code without any dispatch,
+ * one or two register instructions per operator, with the intermediate results spilled to their slots.
+ * The code is written to pages mapped with mmap and made executable with mprotect.
+ * Returns NULL when the JIT is unavailable (other architectures, or built with -DNO_JIT) or the pages
+ * can't be mapped, in which case callers fall back to evaluate_word_slots.
+ * Caller is responsible for freeing the result with free_native_expression.
+ * @param compiled The compiled expression
+ * @return The native code, or NULL if it can't be generated
+ */
+native_expression *compile_native(const compiled_expression *compiled);
+
+/**
+ * Function to unmap and free native code
+ * @param native The native code being freed
+ */
+void free_native_expression(native_expression *native);
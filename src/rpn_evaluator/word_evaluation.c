@@ -0,0 +1,420 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "../converters/expression_parser.h"
+#include "../converters/functions.h"
+
+#include "word_evaluation.h"
+
+// Values of the variables whose bit in the row number changes within a single word
+static const uint64_t low_variable_patterns[6] = {
+    0xAAAAAAAAAAAAAAAAULL,
+    0xCCCCCCCCCCCCCCCCULL,
+    0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL,
+    0xFFFF0000FFFF0000ULL,
+    0xFFFFFFFF00000000ULL};
+
+static int binary_opcode(char token, opcode *op)
+{
+    switch (token)
+    {
+    case '&':
+        *op = OP_AND;
+        return 1;
+    case '|':
+        *op = OP_OR;
+        return 1;
+    case '#':
+        *op = OP_XOR;
+        return 1;
+    case '>':
+        *op = OP_IMPLICATION;
+        return 1;
+    case '=':
+        *op = OP_IFF;
+        return 1;
+    case FUNCTION_NAND:
+        *op = OP_NAND;
+        return 1;
+    case FUNCTION_NOR:
+        *op = OP_NOR;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+compiled_expression *compile_rpn(const char *rpn, const char *variables)
+{
+    return compile_mapped_rpn(rpn, NULL, variables);
+}
+
+compiled_expression *compile_mapped_rpn(const char *rpn, const int *map, const char *variables)
+{
+    compiled_expression *compiled = (compiled_expression *)calloc(1, sizeof(compiled_expression));
+    if (compiled == NULL)
+    {
+        return (compiled_expression *)NULL;
+    }
+
+    // Map each letter to its column, either from the given order or by first appearance
+    int column[26];
+    memset(column, -1, sizeof(column));
+    if (variables != NULL)
+    {
+        for (int i = 0; variables[i] != '\0'; i++)
+        {
+            if (!islower(variables[i]) || column[variables[i] - 'a'] != -1 || i >= 26)
+            {
+                fprintf(stderr, "Invalid variable order %s\n", variables);
+                free(compiled);
+                return (compiled_expression *)NULL;
+            }
+            column[variables[i] - 'a'] = i;
+            compiled->variables[compiled->number_of_variables++] = variables[i];
+        }
+    }
+
+    int rpn_length = strlen(rpn);
+    compiled->program = (instruction *)malloc((rpn_length + 1) * sizeof(instruction));
+    if (compiled->program == NULL)
+    {
+        free(compiled);
+        return (compiled_expression *)NULL;
+    }
+
+    int depth = 0;
+    for (int i = 0; i < rpn_length; i++)
+    {
+        char token = rpn[i];
+        instruction *current = &compiled->program[compiled->program_length];
+        current->rpn_position = i;
+        current->operand = 0;
+
+        if (token == ' ')
+        {
+            continue;
+        }
+        else if (islower(token))
+        {
+            if (column[token - 'a'] == -1)
+            {
+                if (variables != NULL)
+                {
+                    fprintf(stderr, "Variable %c missing from variable order %s\n", token, variables);
+                    free_compiled_expression(compiled);
+                    return (compiled_expression *)NULL;
+                }
+                column[token - 'a'] = compiled->number_of_variables;
+                compiled->variables[compiled->number_of_variables++] = token;
+            }
+            current->op = OP_VARIABLE;
+            current->operand = column[token - 'a'];
+            depth++;
+        }
+        else if (token == '0' || token == '1')
+        {
+            current->op = OP_CONSTANT;
+            current->operand = token - '0';
+            depth++;
+        }
+        else if (token == '-')
+        {
+            if (depth < 1)
+            {
+                fprintf(stderr, "Error: Bad Expression in %s at line %d\n", __FILE__, __LINE__);
+                free_compiled_expression(compiled);
+                return (compiled_expression *)NULL;
+            }
+            current->op = OP_NOT;
+        }
+        else if (binary_opcode(token, &current->op))
+        {
+            if (depth < 2)
+            {
+                fprintf(stderr, "Error: Bad Expression in %s at line %d\n", __FILE__, __LINE__);
+                free_compiled_expression(compiled);
+                return (compiled_expression *)NULL;
+            }
+            depth--;
+        }
+        else if (token == FUNCTION_MUX || token == FUNCTION_MAJORITY)
+        {
+            if (depth < 3)
+            {
+                fprintf(stderr, "Error: Bad Expression in %s at line %d\n", __FILE__, __LINE__);
+                free_compiled_expression(compiled);
+                return (compiled_expression *)NULL;
+            }
+            current->op = token == FUNCTION_MUX ? OP_MUX : OP_MAJORITY;
+            depth -= 2;
+        }
+        else if (token == FUNCTION_XOR)
+        {
+            if (depth < 2)
+            {
+                fprintf(stderr, "Error: Bad Expression in %s at line %d\n", __FILE__, __LINE__);
+                free_compiled_expression(compiled);
+                return (compiled_expression *)NULL;
+            }
+            depth--;
+            // XOR of the previous XOR's result is one more operand of the same XOR, as long as that
+            // result isn't shown in a column of its own, so only the tokens of a single call are merged
+            instruction *previous = compiled->program_length > 0 ? &compiled->program[compiled->program_length - 1] : NULL;
+            if (previous != NULL && previous->op == OP_XOR_N && map != NULL && map[previous->rpn_position] < 0)
+            {
+                previous->operand++;
+                previous->rpn_position = i;
+                continue;
+            }
+            current->op = OP_XOR_N;
+            current->operand = 2;
+        }
+        else
+        {
+            fprintf(stderr, "Unknwon symbol %c\n", token);
+            free_compiled_expression(compiled);
+            return (compiled_expression *)NULL;
+        }
+
+        if (depth > compiled->max_stack_depth)
+        {
+            compiled->max_stack_depth = depth;
+        }
+        compiled->program_length++;
+    }
+
+    if (depth != 1)
+    {
+        fprintf(stderr, "Bad expression\n");
+        free_compiled_expression(compiled);
+        return (compiled_expression *)NULL;
+    }
+
+    compiled->scratch_words = compiled->max_stack_depth;
+    return compiled;
+}
+
+compiled_expression *compile_expression(const char *expression, const char *variables)
+{
+    parsed_expression *parsed = parse_expression(expression);
+    if (parsed == NULL)
+    {
+        fprintf(stderr, "Failed to parse expression in file %s at line %d\n", __FILE__, __LINE__);
+        return (compiled_expression *)NULL;
+    }
+    compiled_expression *compiled = compile_mapped_rpn(parsed->rpn_expression, parsed->map, variables);
+    free_parsed_expression(parsed);
+    return compiled;
+}
+
+void free_compiled_expression(compiled_expression *compiled)
+{
+    if (compiled == NULL)
+    {
+        return;
+    }
+    free(compiled->program);
+    free(compiled);
+}
+
+uint64_t variable_word(int variable_index, int number_of_variables, int64_t word_index)
+{
+    // The leftmost column is the most significant bit of the row number
+    int shift = number_of_variables - 1 - variable_index;
+    if (shift < 6)
+    {
+        return low_variable_patterns[shift];
+    }
+    return ((word_index << 6) >> shift) & 1 ? ~0ULL : 0ULL;
+}
+
+uint64_t valid_rows_mask(int number_of_variables)
+{
+    if (number_of_variables >= 6)
+    {
+        return ~0ULL;
+    }
+    return (1ULL << (1 << number_of_variables)) - 1;
+}
+
+int64_t number_of_words(int number_of_variables)
+{
+    if (number_of_variables <= 6)
+    {
+        return 1;
+    }
+    return (int64_t)1 << (number_of_variables - 6);
+}
+
+uint64_t evaluate_word(const compiled_expression *compiled, int64_t word_index, uint64_t *stack)
+{
+    // Programs that share results keep every result after the stack, for OP_COPY
+    uint64_t *results = compiled->scratch_words > compiled->max_stack_depth ? stack + compiled->max_stack_depth : NULL;
+    int top = -1;
+    for (int i = 0; i < compiled->program_length; i++)
+    {
+        const instruction *current = &compiled->program[i];
+        switch (current->op)
+        {
+        case OP_COPY:
+            stack[++top] = results[current->operand];
+            break;
+        case OP_VARIABLE:
+            stack[++top] = variable_word(current->operand, compiled->number_of_variables, word_index);
+            break;
+        case OP_CONSTANT:
+            stack[++top] = current->operand ? ~0ULL : 0ULL;
+            break;
+        case OP_NOT:
+            stack[top] = ~stack[top];
+            break;
+        // For binary operators stack[top] is the right operand
+        case OP_AND:
+            top--;
+            stack[top] = stack[top] & stack[top + 1];
+            break;
+        case OP_OR:
+            top--;
+            stack[top] = stack[top] | stack[top + 1];
+            break;
+        case OP_XOR:
+            top--;
+            stack[top] = stack[top] ^ stack[top + 1];
+            break;
+        case OP_IMPLICATION:
+            // Operands are applied in the same order as evaluate_expr so both evaluators agree
+            top--;
+            stack[top] = ~stack[top + 1] | stack[top];
+            break;
+        case OP_IFF:
+            top--;
+            stack[top] = ~(stack[top] ^ stack[top + 1]);
+            break;
+        case OP_NAND:
+            top--;
+            stack[top] = ~(stack[top] & stack[top + 1]);
+            break;
+        case OP_NOR:
+            top--;
+            stack[top] = ~(stack[top] | stack[top + 1]);
+            break;
+        case OP_MUX:
+            top -= 2;
+            stack[top] = stack[top + 2] ^ (stack[top] & (stack[top + 1] ^ stack[top + 2]));
+            break;
+        case OP_MAJORITY:
+            top -= 2;
+            stack[top] = (stack[top] & stack[top + 1]) | (stack[top + 2] & (stack[top] | stack[top + 1]));
+            break;
+        case OP_XOR_N:
+            top -= current->operand - 1;
+            for (int k = 1; k < current->operand; k++)
+            {
+                stack[top] ^= stack[top + k];
+            }
+            break;
+        }
+        if (results != NULL)
+        {
+            results[i] = stack[top];
+        }
+    }
+    return stack[0];
+}
+
+void fill_variable_words(int number_of_variables, int64_t word_index, uint64_t *variable_words)
+{
+    for (int i = 0; i < number_of_variables; i++)
+    {
+        variable_words[i] = variable_word(i, number_of_variables, word_index);
+    }
+}
+
+void evaluate_word_slots(const compiled_expression *compiled, const uint64_t *variable_words, uint64_t *slots)
+{
+    // operands holds the slot of every value on the evaluation stack
+    int operands[compiled->max_stack_depth + 1];
+    int top = -1;
+    for (int i = 0; i < compiled->program_length; i++)
+    {
+        const instruction *current = &compiled->program[i];
+        switch (current->op)
+        {
+        case OP_COPY:
+            slots[i] = slots[current->operand];
+            operands[++top] = i;
+            break;
+        case OP_VARIABLE:
+            slots[i] = variable_words[current->operand];
+            operands[++top] = i;
+            break;
+        case OP_CONSTANT:
+            slots[i] = current->operand ? ~0ULL : 0ULL;
+            operands[++top] = i;
+            break;
+        case OP_NOT:
+            slots[i] = ~slots[operands[top]];
+            operands[top] = i;
+            break;
+        case OP_AND:
+            top--;
+            slots[i] = slots[operands[top]] & slots[operands[top + 1]];
+            operands[top] = i;
+            break;
+        case OP_OR:
+            top--;
+            slots[i] = slots[operands[top]] | slots[operands[top + 1]];
+            operands[top] = i;
+            break;
+        case OP_XOR:
+            top--;
+            slots[i] = slots[operands[top]] ^ slots[operands[top + 1]];
+            operands[top] = i;
+            break;
+        case OP_IMPLICATION:
+            top--;
+            slots[i] = ~slots[operands[top + 1]] | slots[operands[top]];
+            operands[top] = i;
+            break;
+        case OP_IFF:
+            top--;
+            slots[i] = ~(slots[operands[top]] ^ slots[operands[top + 1]]);
+            operands[top] = i;
+            break;
+        case OP_NAND:
+            top--;
+            slots[i] = ~(slots[operands[top]] & slots[operands[top + 1]]);
+            operands[top] = i;
+            break;
+        case OP_NOR:
+            top--;
+            slots[i] = ~(slots[operands[top]] | slots[operands[top + 1]]);
+            operands[top] = i;
+            break;
+        case OP_MUX:
+            top -= 2;
+            slots[i] = slots[operands[top + 2]] ^ (slots[operands[top]] & (slots[operands[top + 1]] ^ slots[operands[top + 2]]));
+            operands[top] = i;
+            break;
+        case OP_MAJORITY:
+            top -= 2;
+            slots[i] = (slots[operands[top]] & slots[operands[top + 1]]) |
+                       (slots[operands[top + 2]] & (slots[operands[top]] | slots[operands[top + 1]]));
+            operands[top] = i;
+            break;
+        case OP_XOR_N:
+            top -= current->operand - 1;
+            slots[i] = slots[operands[top]];
+            for (int k = 1; k < current->operand; k++)
+            {
+                slots[i] ^= slots[operands[top + k]];
+            }
+            operands[top] = i;
+            break;
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Operations a compiled expression is made of. Every operation works on 64 rows of the
+ * truth table at once, row (64 * word_index + k) being held in bit k of a 64 bit word.
+ */
+typedef enum
+{
+    OP_VARIABLE,
+    OP_CONSTANT,
+    OP_NOT,
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_IMPLICATION,
+    OP_IFF,
+    OP_COPY, // Pushes the result of an earlier instruction again, for expressions read as graphs
+    OP_NAND,
+    OP_NOR,
+    OP_MUX,      // First operand selects the second when 1, the third when 0
+    OP_MAJORITY, // 1 when at least two of the three operands are
+    OP_XOR_N     // XOR of the top operand words of the stack
+} opcode;
+
+/**
+ * A single instruction of a compiled expression
+ */
+typedef struct
+{
+    opcode op;
+    int operand;      // Variable index for OP_VARIABLE, 0 or 1 for OP_CONSTANT, instruction index for OP_COPY,
+                      // number of operands for OP_XOR_N
+    int rpn_position; // Position in the rpn expression the instruction was compiled from
+} instruction;
+
+/**
+ * An rpn expression compiled into a program for the word evaluator
+ */
+typedef struct
+{
+    instruction *program;
+    int program_length;
+    int max_stack_depth;     // Number of words the evaluation stack needs
+    int scratch_words;       // Number of words evaluate_word needs, more than max_stack_depth with OP_COPY
+    int number_of_variables; // Number of columns of the truth table
+    char variables[27];      // Variables in column order, null terminated
+} compiled_expression;
+
+/**
+ * Function to compile a rpn expression into a program evaluating 64 rows at a time, with one
+ * instruction per token so each one's value can be shown in its column.
+ * Caller is responsible for freeing the result with free_compiled_expression.
+ * @param rpn The rpn expression being compiled
+ * @param variables The variables in the order of the table columns, this lets two expressions
+ * share a column layout. If NULL, variables are ordered by their first appearance in rpn.
+ * @return The compiled expression, or NULL if rpn is not a valid rpn expression
+ */
+compiled_expression *compile_rpn(const char *rpn, const char *variables);
+
+/**
+ * Function to compile a rpn expression like compile_rpn, merging the XOR tokens of a single infix call
+ * into one OP_XOR_N. Only the last token of a call has a position in the infix map, so a run of XOR
+ * tokens is merged up to the first one shown in a column, and nested calls keep their own columns.
+ * Caller is responsible for freeing the result with free_compiled_expression.
+ * @param rpn The rpn expression being compiled
+ * @param map The infix map of the rpn expression, or NULL if every token is shown, as in postfix tables
+ * @param variables The variables in the order of the table columns, or NULL like for compile_rpn
+ * @return The compiled expression, or NULL if rpn is not a valid rpn expression or memory can't be
+ * allocated. Only invalid expressions are printed, callers report allocation failures.
+ */
+compiled_expression *compile_mapped_rpn(const char *rpn, const int *map, const char *variables);
+
+/**
+ * Function to compile an expression that is either infix or postfix, the same way
+ * website_main decides between the two.
+ * Caller is responsible for freeing the result with free_compiled_expression.
+ * @param expression The infix or postfix expression being compiled
+ * @param variables The variables in column order, or NULL for the order of first appearance
+ * @return The compiled expression, or NULL if the expression is invalid
+ */
+compiled_expression *compile_expression(const char *expression, const char *variables);
+
+/**
+ * Function to free a compiled expression
+ * @param compiled The compiled expression being freed
+ */
+void free_compiled_expression(compiled_expression *compiled);
+
+/**
+ * Function to get the values a variable takes in 64 consecutive rows of the truth table
+ * @param variable_index The column of the variable, 0 being the leftmost (most significant) column
+ * @param number_of_variables The number of columns in the truth table
+ * @param word_index The index of the word, so rows [64 * word_index, 64 * word_index + 64)
+ * @return The word holding the values of the variable, one bit per row
+ */
+uint64_t variable_word(int variable_index, int number_of_variables, int64_t word_index);
+
+/**
+ * Function to get a mask of the bits of a word which map onto rows of the table.
+ * Only tables with less than 6 variables have words that are not full.
+ * @param number_of_variables The number of columns in the truth table
+ * @return The mask of valid rows within a word
+ */
+uint64_t valid_rows_mask(int number_of_variables);
+
+/**
+ * Function to get the number of words needed to hold every row of a truth table
+ * @param number_of_variables The number of columns in the truth table
+ * @return The number of words
+ */
+int64_t number_of_words(int number_of_variables);
+
+/**
+ * Function to evaluate a compiled expression over 64 consecutive rows of the truth table.
+ * @param compiled The compiled expression
+ * @param word_index The index of the word, so rows [64 * word_index, 64 * word_index + 64)
+ * @param stack Scratch space of at least compiled->scratch_words words
+ * @return The result of the expression, one bit per row
+ */
+uint64_t evaluate_word(const compiled_expression *compiled, int64_t word_index, uint64_t *stack);
+
+/**
+ * Function to fill in the values every variable takes over 64 consecutive rows of the truth table
+ * @param number_of_variables The number of columns in the truth table
+ * @param word_index The index of the word, so rows [64 * word_index, 64 * word_index + 64)
+ * @param variable_words Receives number_of_variables words, one per column
+ */
+void fill_variable_words(int number_of_variables, int64_t word_index, uint64_t *variable_words);
+
+/**
+ * Function to evaluate a compiled expression over 64 consecutive rows, keeping the result of every
+ * instruction so the intermediate results of each row can be printed.
+ * @param compiled The compiled expression
+ * @param variable_words The values of the variables over the 64 rows, from fill_variable_words
+ * @param slots Receives compiled->program_length words, slot i holding the result of instruction i
+ */
+void evaluate_word_slots(const compiled_expression *compiled, const uint64_t *variable_words, uint64_t *slots);
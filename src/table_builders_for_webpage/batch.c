@@ -0,0 +1,427 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "../utils/parallel_scan.h"
+#include "../utils/find_nr_of_vars.h"
+#include "table_builders.h"
+#include "expression_cache.h"
+
+#include "batch.h"
+
+// Number of rows of the segments jobs are split into, the work items of the worker threads
+#define BATCH_CHUNK_ROWS 65536
+
+// Number of work items workers may finish past the first one not done yet, which bounds the spill file
+#define BATCH_AHEAD_ITEMS 1024
+
+// Number of bytes copied at a time from the spill file to the outputs
+#define BATCH_COPY_BYTES 65536
+
+// Number of distinct expressions a batch keeps compiled
+#define BATCH_CACHE_CAPACITY 256
+
+batch_job *read_batch_jobs(FILE *file, int *number_of_jobs)
+{
+    int capacity = 64;
+    batch_job *jobs = (batch_job *)malloc(capacity * sizeof(batch_job));
+    if (jobs == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for batch jobs in %s at line %d\n", __FILE__, __LINE__);
+        return (batch_job *)NULL;
+    }
+    *number_of_jobs = 0;
+
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t length;
+    int line_number = 0;
+    while ((length = getline(&line, &line_capacity, file)) != -1)
+    {
+        line_number++;
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+        {
+            line[--length] = '\0';
+        }
+        if (length == 0 || line[0] == '#')
+        {
+            continue;
+        }
+
+        if (*number_of_jobs == capacity)
+        {
+            capacity *= 2;
+            batch_job *grown = (batch_job *)realloc(jobs, capacity * sizeof(batch_job));
+            if (grown == NULL)
+            {
+                fprintf(stderr, "Failed to allocate memory for batch jobs in %s at line %d\n", __FILE__, __LINE__);
+                free(line);
+                free_batch_jobs(jobs, *number_of_jobs);
+                return (batch_job *)NULL;
+            }
+            jobs = grown;
+        }
+
+        batch_job *job = &jobs[*number_of_jobs];
+        job->line_number = line_number;
+        job->mode = BATCH_INVALID;
+        job->start_row = 0;
+        job->end_row = 0;
+        int expression_offset = -1;
+        if (sscanf(line, "segment %d %d %n", &job->start_row, &job->end_row, &expression_offset) == 2 && expression_offset > 0)
+        {
+            job->mode = BATCH_SEGMENT;
+        }
+        else if (strncmp(line, "true ", 5) == 0)
+        {
+            job->mode = BATCH_TRUE_ROWS;
+            expression_offset = 5;
+        }
+        job->expression = strdup(job->mode == BATCH_INVALID ? "" : line + expression_offset);
+        if (job->expression == NULL)
+        {
+            fprintf(stderr, "Failed to allocate memory for batch jobs in %s at line %d\n", __FILE__, __LINE__);
+            free(line);
+            free_batch_jobs(jobs, *number_of_jobs);
+            return (batch_job *)NULL;
+        }
+        (*number_of_jobs)++;
+    }
+    free(line);
+    return jobs;
+}
+
+void free_batch_jobs(batch_job *jobs, int number_of_jobs)
+{
+    if (jobs == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < number_of_jobs; i++)
+    {
+        free(jobs[i].expression);
+    }
+    free(jobs);
+}
+
+/**
+ * Rows [start_row, end_row) of a job, with end_row clamped to its table
+ */
+static void job_rows(const batch_job *job, int number_of_variables, int *start_row, int *end_row)
+{
+    int number_of_rows = 1 << number_of_variables;
+    *start_row = job->mode == BATCH_SEGMENT ? job->start_row : 0;
+    *end_row = job->mode == BATCH_SEGMENT && job->end_row < number_of_rows ? job->end_row : number_of_rows;
+}
+
+/**
+ * Number of work items of a job, one per segment of its rows and at least one for its header or error
+ */
+static int number_of_job_items(const batch_job *job)
+{
+    if (job->mode == BATCH_INVALID || (job->mode == BATCH_SEGMENT && job->start_row < 0))
+    {
+        return 1;
+    }
+    int start_row, end_row;
+    job_rows(job, count_unique_variables(job->expression), &start_row, &end_row);
+    return end_row > start_row ? (end_row - start_row - 1) / BATCH_CHUNK_ROWS + 1 : 1;
+}
+
+/**
+ * Writes the output of a work item of a job: the rows of its segment, preceded by the header or error
+ * message of the job for its first item, so the items of a job joined are what the single expression
+ * modes print or write to their file
+ */
+static void write_batch_item(const batch_job *job, int item, int number_of_items, expression_cache *cache, FILE *file)
+{
+    if (job->mode == BATCH_INVALID)
+    {
+        fprintf(file, "Invalid batch line, use segment <start> <end> <expression> or true <expression>\n");
+        return;
+    }
+    const cached_expression *entry = acquire_cached_expression(cache, job->expression);
+    if (entry == NULL || (job->mode == BATCH_SEGMENT && job->start_row < 0))
+    {
+        if (item == 0)
+        {
+            fprintf(file, "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        }
+        release_cached_expression(cache, entry);
+        return;
+    }
+
+    // Same output as the segment and file modes, so segments starting past the table are left empty
+    if (item == 0 && (job->mode == BATCH_TRUE_ROWS || (job->start_row == 0 && job->end_row != 0)))
+    {
+        fprintf(file, "%s%s", entry->header, entry->separator);
+    }
+
+    int start_row, end_row;
+    job_rows(job, entry->parsed->number_of_variables, &start_row, &end_row);
+    start_row += item * BATCH_CHUNK_ROWS;
+    if (item < number_of_items - 1)
+    {
+        end_row = start_row + BATCH_CHUNK_ROWS;
+    }
+    if (start_row < end_row)
+    {
+        char *segment = generate_segment_with_formatter(entry->formatter, start_row, end_row, job->mode == BATCH_TRUE_ROWS);
+        if (segment != NULL)
+        {
+            fputs(segment, file);
+            free(segment);
+        }
+    }
+    release_cached_expression(cache, entry);
+}
+
+/**
+ * State shared by the worker pool of a batch
+ */
+typedef struct
+{
+    const batch_job *jobs;
+    int number_of_jobs;
+    int *first_items;    // Index of the first work item of each job, the last entry being the number of items
+    expression_cache *cache; // Shared so a batch paging through one expression compiles it once
+    atomic_int next_item;
+    atomic_int failed;
+    int spill_fd;        // Where the outputs of the items wait for their job to be written
+    off_t spill_length;
+    off_t *item_offsets;
+    size_t *item_lengths;
+    bool *items_done;
+    int first_pending;   // First item not done yet
+    pthread_mutex_t lock;
+    pthread_cond_t item_done;
+} batch_state;
+
+/**
+ * Index of the job a work item belongs to
+ */
+static int job_of_item(const batch_state *state, int item)
+{
+    int low = 0, high = state->number_of_jobs - 1;
+    while (low < high)
+    {
+        int middle = (low + high + 1) / 2;
+        if (state->first_items[middle] <= item)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+static void *batch_worker(void *arg)
+{
+    batch_state *state = (batch_state *)arg;
+    int number_of_items = state->first_items[state->number_of_jobs];
+    int item;
+    while ((item = atomic_fetch_add(&state->next_item, 1)) < number_of_items)
+    {
+        // Items are taken in the order of the outputs, so the first pending one is never waiting here
+        pthread_mutex_lock(&state->lock);
+        while (item >= state->first_pending + BATCH_AHEAD_ITEMS)
+        {
+            pthread_cond_wait(&state->item_done, &state->lock);
+        }
+        pthread_mutex_unlock(&state->lock);
+
+        int job = job_of_item(state, item);
+        char *output = NULL;
+        size_t output_size = 0;
+        FILE *file = open_memstream(&output, &output_size);
+        if (file == NULL)
+        {
+            fprintf(stderr, "Failed to open memory stream in %s at line %d\n", __FILE__, __LINE__);
+            exit(EXIT_FAILURE);
+        }
+        write_batch_item(&state->jobs[job], item - state->first_items[job], state->first_items[job + 1] - state->first_items[job], state->cache, file);
+        fclose(file);
+
+        pthread_mutex_lock(&state->lock);
+        off_t offset = state->spill_length;
+        state->spill_length += output_size;
+        pthread_mutex_unlock(&state->lock);
+        for (size_t written = 0; written < output_size;)
+        {
+            ssize_t result = pwrite(state->spill_fd, output + written, output_size - written, offset + written);
+            if (result <= 0)
+            {
+                fprintf(stderr, "Failed to write spill file in %s at line %d\n", __FILE__, __LINE__);
+                atomic_store(&state->failed, 1);
+                break;
+            }
+            written += result;
+        }
+        free(output);
+
+        pthread_mutex_lock(&state->lock);
+        state->item_offsets[item] = offset;
+        state->item_lengths[item] = output_size;
+        state->items_done[item] = true;
+        while (state->first_pending < number_of_items && state->items_done[state->first_pending])
+        {
+            state->first_pending++;
+        }
+        pthread_cond_broadcast(&state->item_done);
+        pthread_mutex_unlock(&state->lock);
+    }
+    return NULL;
+}
+
+/**
+ * Copies the items of a job from the spill file to its output, then frees their space in the spill file
+ */
+static void copy_job_output(batch_state *state, int job, FILE *output)
+{
+    char buffer[BATCH_COPY_BYTES];
+    for (int item = state->first_items[job]; item < state->first_items[job + 1]; item++)
+    {
+        off_t offset = state->item_offsets[item];
+        for (size_t left = state->item_lengths[item]; left > 0;)
+        {
+            ssize_t read = pread(state->spill_fd, buffer, left < BATCH_COPY_BYTES ? left : BATCH_COPY_BYTES, offset);
+            if (read <= 0)
+            {
+                fprintf(stderr, "Failed to read spill file in %s at line %d\n", __FILE__, __LINE__);
+                atomic_store(&state->failed, 1);
+                break;
+            }
+            fwrite(buffer, 1, read, output);
+            offset += read;
+            left -= read;
+        }
+        if (state->item_lengths[item] > 0)
+        {
+            fallocate(state->spill_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, state->item_offsets[item], state->item_lengths[item]);
+        }
+    }
+}
+
+int run_batch(const batch_job *jobs, int number_of_jobs, FILE *stream, const char *output_directory)
+{
+    batch_state state;
+    state.jobs = jobs;
+    state.number_of_jobs = number_of_jobs;
+    atomic_init(&state.next_item, 0);
+    atomic_init(&state.failed, 0);
+    state.spill_length = 0;
+    state.first_pending = 0;
+    state.first_items = (int *)malloc((number_of_jobs + 1) * sizeof(int));
+    if (state.first_items == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for batch outputs in %s at line %d\n", __FILE__, __LINE__);
+        return 1;
+    }
+    state.first_items[0] = 0;
+    for (int job = 0; job < number_of_jobs; job++)
+    {
+        state.first_items[job + 1] = state.first_items[job] + number_of_job_items(&jobs[job]);
+    }
+    int number_of_items = state.first_items[number_of_jobs];
+
+    FILE *spill = tmpfile();
+    state.item_offsets = (off_t *)calloc(number_of_items + 1, sizeof(off_t));
+    state.item_lengths = (size_t *)calloc(number_of_items + 1, sizeof(size_t));
+    state.items_done = (bool *)calloc(number_of_items + 1, sizeof(bool));
+    state.cache = create_expression_cache(BATCH_CACHE_CAPACITY);
+    if (spill == NULL || state.item_offsets == NULL || state.item_lengths == NULL || state.items_done == NULL || state.cache == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for batch outputs in %s at line %d\n", __FILE__, __LINE__);
+        if (spill != NULL)
+        {
+            fclose(spill);
+        }
+        free(state.first_items);
+        free(state.item_offsets);
+        free(state.item_lengths);
+        free(state.items_done);
+        free_expression_cache(state.cache);
+        return 1;
+    }
+    state.spill_fd = fileno(spill);
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.item_done, NULL);
+
+    // One pool for the whole batch, working through the segments of every job
+    int num_threads = number_of_scan_threads();
+    if (num_threads > number_of_items)
+    {
+        num_threads = number_of_items;
+    }
+    pthread_t threads[num_threads > 0 ? num_threads : 1];
+    for (int i = 0; i < num_threads; i++)
+    {
+        if (pthread_create(&threads[i], NULL, batch_worker, &state) != 0)
+        {
+            fprintf(stderr, "Failed to create thread in file %s at line %d\n", __FILE__, __LINE__);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Outputs are written in the order of the batch file, each once all its items are done
+    for (int job = 0; job < number_of_jobs; job++)
+    {
+        pthread_mutex_lock(&state.lock);
+        while (state.first_pending < state.first_items[job + 1])
+        {
+            pthread_cond_wait(&state.item_done, &state.lock);
+        }
+        pthread_mutex_unlock(&state.lock);
+
+        if (output_directory == NULL)
+        {
+            size_t output_size = 0;
+            for (int item = state.first_items[job]; item < state.first_items[job + 1]; item++)
+            {
+                output_size += state.item_lengths[item];
+            }
+            fprintf(stream, "#%d %zu\n", jobs[job].line_number, output_size);
+            copy_job_output(&state, job, stream);
+            continue;
+        }
+        size_t path_length = strlen(output_directory) + 32;
+        char path[path_length];
+        snprintf(path, path_length, "%s/%d.txt", output_directory, jobs[job].line_number);
+        FILE *file = fopen(path, "w");
+        if (file == NULL)
+        {
+            fprintf(stderr, "Failed to open %s in %s at line %d\n", path, __FILE__, __LINE__);
+            atomic_store(&state.failed, 1);
+            continue;
+        }
+        copy_job_output(&state, job, file);
+        if (fclose(file) != 0)
+        {
+            atomic_store(&state.failed, 1);
+        }
+    }
+
+    for (int i = 0; i < num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&state.lock);
+    pthread_cond_destroy(&state.item_done);
+    fclose(spill);
+    free(state.first_items);
+    free(state.item_offsets);
+    free(state.item_lengths);
+    free(state.items_done);
+    free_expression_cache(state.cache);
+    return atomic_load(&state.failed);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <stdio.h>
+
+#include "expression_cache.h"
+
+/**
+ * What a line of a batch file asks for
+ */
+typedef enum
+{
+    BATCH_SEGMENT,   // segment <start> <end> <expression>, like <expression> <start> <end>
+    BATCH_TRUE_ROWS, // true <expression>, like <expression> <file_name>
+    BATCH_INVALID    // A line that couldn't be read, answered with an error message
+} batch_mode;
+
+/**
+ * A single expression of a batch file
+ */
+typedef struct
+{
+    int line_number; // Line of the batch file, used to name or tag the output
+    batch_mode mode;
+    int start_row;
+    int end_row;
+    char *expression;
+} batch_job;
+
+/**
+ * Function to read the jobs of a batch file, one per line. Blank lines and lines starting with '#'
+ * are skipped, the expression is the rest of the line so it may contain spaces.
+ * Caller is responsible for freeing the result with free_batch_jobs.
+ * @param file The batch file
+ * @param number_of_jobs Receives the number of jobs read
+ * @return The jobs, or NULL if memory allocation fails
+ */
+batch_job *read_batch_jobs(FILE *file, int *number_of_jobs);
+
+/**
+ * Function to free the jobs of a batch file
+ * @param jobs The jobs being freed
+ * @param number_of_jobs The number of jobs
+ */
+void free_batch_jobs(batch_job *jobs, int number_of_jobs);
+
+/**
+ * Function to run every job of a batch with one pool of worker threads shared by all of them,
+ * instead of a process and a batch of threads per expression. Jobs are split into segments of rows,
+ * and workers take the next segment of the batch as soon as they finish one, so many small
+ * expressions and a few big ones alike keep every thread busy. The output of each job is exactly
+ * what the single expression modes of website_binary_ttable print or write to their file.
+ * @param jobs The jobs
+ * @param number_of_jobs The number of jobs
+ * @param stream If output_directory is NULL, the outputs are written here in the order of the jobs,
+ * each preceded by a tag line "#<line_number> <number of bytes>". Segments finished before the
+ * turn of their job wait in a single temporary file, so outputs are never held in memory.
+ * @param output_directory If not NULL, the output of each job is written to <line_number>.txt in it
+ * @return 0 on success, 1 if an output could not be written
+ */
+int run_batch(const batch_job *jobs, int number_of_jobs, FILE *stream, const char *output_directory);
@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "expression_cache.h"
+
+expression_cache *create_expression_cache(int capacity)
+{
+    expression_cache *cache = (expression_cache *)calloc(1, sizeof(expression_cache));
+    if (cache == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for expression cache in %s at line %d\n", __FILE__, __LINE__);
+        return (expression_cache *)NULL;
+    }
+    cache->capacity = capacity > 0 ? capacity : 1;
+    cache->number_of_buckets = cache->capacity * 2;
+    cache->buckets = (cached_expression **)calloc(cache->number_of_buckets, sizeof(cached_expression *));
+    if (cache->buckets == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for expression cache in %s at line %d\n", __FILE__, __LINE__);
+        free(cache);
+        return (expression_cache *)NULL;
+    }
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+static void free_cached_expression(cached_expression *entry)
+{
+    if (entry == NULL)
+    {
+        return;
+    }
+    free(entry->key);
+    free_parsed_expression(entry->parsed);
+    free_row_formatter(entry->formatter);
+    free(entry->header);
+    free(entry->separator);
+    free(entry);
+}
+
+void free_expression_cache(expression_cache *cache)
+{
+    if (cache == NULL)
+    {
+        return;
+    }
+    cached_expression *entry = cache->newest;
+    while (entry != NULL)
+    {
+        cached_expression *older = entry->older;
+        free_cached_expression(entry);
+        entry = older;
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->buckets);
+    free(cache);
+}
+
+static int bucket_of(const expression_cache *cache, const char *key)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; key[i] != '\0'; i++)
+    {
+        hash = (hash ^ (unsigned char)key[i]) * 1099511628211ULL;
+    }
+    return hash % cache->number_of_buckets;
+}
+
+static void unlink_from_order(expression_cache *cache, cached_expression *entry)
+{
+    if (entry->newer != NULL)
+    {
+        entry->newer->older = entry->older;
+    }
+    else
+    {
+        cache->newest = entry->older;
+    }
+    if (entry->older != NULL)
+    {
+        entry->older->newer = entry->newer;
+    }
+    else
+    {
+        cache->oldest = entry->newer;
+    }
+    entry->newer = entry->older = NULL;
+}
+
+static void link_as_newest(expression_cache *cache, cached_expression *entry)
+{
+    entry->older = cache->newest;
+    entry->newer = NULL;
+    if (cache->newest != NULL)
+    {
+        cache->newest->newer = entry;
+    }
+    cache->newest = entry;
+    if (cache->oldest == NULL)
+    {
+        cache->oldest = entry;
+    }
+}
+
+static cached_expression *find_entry(const expression_cache *cache, const char *key)
+{
+    for (cached_expression *entry = cache->buckets[bucket_of(cache, key)]; entry != NULL; entry = entry->next_in_bucket)
+    {
+        if (strcmp(entry->key, key) == 0)
+        {
+            return entry;
+        }
+    }
+    return (cached_expression *)NULL;
+}
+
+/**
+ * Drops the least recently used entry, which is freed now or by its last release
+ */
+static void evict_oldest(expression_cache *cache)
+{
+    cached_expression *entry = cache->oldest;
+    unlink_from_order(cache, entry);
+    cached_expression **link = &cache->buckets[bucket_of(cache, entry->key)];
+    while (*link != entry)
+    {
+        link = &(*link)->next_in_bucket;
+    }
+    *link = entry->next_in_bucket;
+    cache->size--;
+    entry->evicted = true;
+    if (entry->references == 0)
+    {
+        free_cached_expression(entry);
+    }
+}
+
+/**
+ * Parses and compiles an expression outside of the lock, so other lookups aren't held up by it
+ */
+static cached_expression *build_entry(char *key)
+{
+    cached_expression *entry = (cached_expression *)calloc(1, sizeof(cached_expression));
+    if (entry == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for cache entry in %s at line %d\n", __FILE__, __LINE__);
+        free(key);
+        return (cached_expression *)NULL;
+    }
+    entry->key = key;
+    entry->parsed = parse_expression(key);
+    entry->formatter = entry->parsed == NULL ? NULL : create_parsed_row_formatter(entry->parsed);
+    if (entry->formatter == NULL)
+    {
+        free_cached_expression(entry);
+        return (cached_expression *)NULL;
+    }
+    entry->header = generate_header(key);
+    entry->separator = generate_separator(key);
+    return entry;
+}
+
+const cached_expression *acquire_cached_expression(expression_cache *cache, const char *expression)
+{
+    char *key = strdup(expression);
+    if (key == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for expression in %s at line %d\n", __FILE__, __LINE__);
+        return (cached_expression *)NULL;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    cached_expression *entry = find_entry(cache, key);
+    if (entry != NULL)
+    {
+        cache->hits++;
+        entry->references++;
+        unlink_from_order(cache, entry);
+        link_as_newest(cache, entry);
+        pthread_mutex_unlock(&cache->lock);
+        free(key);
+        return entry;
+    }
+    cache->misses++;
+    pthread_mutex_unlock(&cache->lock);
+
+    cached_expression *built = build_entry(key);
+    if (built == NULL)
+    {
+        return (cached_expression *)NULL;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    // Another thread may have built the same expression in the meantime
+    entry = find_entry(cache, built->key);
+    if (entry != NULL)
+    {
+        unlink_from_order(cache, entry);
+    }
+    else
+    {
+        entry = built;
+        built = NULL;
+        int bucket = bucket_of(cache, entry->key);
+        entry->next_in_bucket = cache->buckets[bucket];
+        cache->buckets[bucket] = entry;
+        cache->size++;
+    }
+    entry->references++;
+    link_as_newest(cache, entry);
+    while (cache->size > cache->capacity)
+    {
+        evict_oldest(cache);
+    }
+    pthread_mutex_unlock(&cache->lock);
+    free_cached_expression(built);
+    return entry;
+}
+
+void release_cached_expression(expression_cache *cache, const cached_expression *entry)
+{
+    if (entry == NULL)
+    {
+        return;
+    }
+    cached_expression *released = (cached_expression *)entry;
+    pthread_mutex_lock(&cache->lock);
+    released->references--;
+    bool free_now = released->evicted && released->references == 0;
+    pthread_mutex_unlock(&cache->lock);
+    if (free_now)
+    {
+        free_cached_expression(released);
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <pthread.h>
+
+#include "../converters/expression_parser.h"
+#include "table_builders.h"
+
+/**
+ * An expression compiled once for all the tables generated from it
+ */
+typedef struct cached_expression
+{
+    char *key; // The expression exactly as given, whitespace included since the table is laid out on it
+    parsed_expression *parsed;
+    row_formatter *formatter;
+    char *header;
+    char *separator;
+    int references;  // Number of acquires not released yet, the entry is only freed once it drops to 0
+    bool evicted;    // Whether the entry was already dropped from the cache
+    struct cached_expression *newer;     // Neighbours in least recently used order
+    struct cached_expression *older;
+    struct cached_expression *next_in_bucket;
+} cached_expression;
+
+/**
+ * A thread safe cache of compiled expressions with least recently used eviction
+ */
+typedef struct
+{
+    pthread_mutex_t lock;
+    int capacity;
+    int size;
+    int number_of_buckets;
+    cached_expression **buckets;
+    cached_expression *newest;
+    cached_expression *oldest;
+    long hits;
+    long misses;
+} expression_cache;
+
+/**
+ * Function to create an empty expression cache.
+ * Caller is responsible for freeing the result with free_expression_cache.
+ * @param capacity The number of expressions kept at most, the least recently used one is evicted past it
+ * @return The cache, or NULL if memory allocation fails
+ */
+expression_cache *create_expression_cache(int capacity);
+
+/**
+ * Function to free an expression cache. Entries still acquired must be released before.
+ * @param cache The cache being freed
+ */
+void free_expression_cache(expression_cache *cache);
+
+/**
+ * Function to get the compiled expression, header and separator of an expression, parsing and
+ * compiling it only if it isn't in the cache yet. Expressions are looked up by their exact text, as
+ * the header, separator and row layout follow its spacing, so the tables are those of the command line.
+ * The entry stays valid until it is released, even if it is evicted in the meantime.
+ * @param cache The cache
+ * @param expression The infix or postfix expression
+ * @return The entry, or NULL if the expression is invalid
+ */
+const cached_expression *acquire_cached_expression(expression_cache *cache, const char *expression);
+
+/**
+ * Function to give back an entry from acquire_cached_expression
+ * @param cache The cache the entry was acquired from
+ * @param entry The entry
+ */
+void release_cached_expression(expression_cache *cache, const cached_expression *entry);
@@ -0,0 +1,789 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "../utils/parallel_scan.h"
+#include "table_builders.h"
+#include "json_lines.h"
+
+#include "http_server.h"
+
+// Largest request kept in memory, headers and body
+#define SERVER_MAX_REQUEST 16384
+// Number of lines of a true_rows page, like server.py
+#define SERVER_PAGE_LINES 100
+// Largest truth_table segment answered, so a single request can't take all the memory
+#define SERVER_MAX_SEGMENT_ROWS (1 << 20)
+// Number of distinct expressions the server keeps compiled
+#define SERVER_CACHE_CAPACITY 1024
+#define SERVER_MAX_EVENTS 256
+
+typedef enum
+{
+    CONNECTION_READING,    // Waiting for a whole request
+    CONNECTION_PROCESSING, // Request handed to the workers
+    CONNECTION_WRITING     // Response being sent
+} connection_state;
+
+/**
+ * A client connection, owned by the event loop except while a worker processes its request
+ */
+typedef struct connection
+{
+    int fd;
+    connection_state state;
+    char input[SERVER_MAX_REQUEST];
+    size_t input_length;
+    size_t request_length; // Bytes of the input taken by the request being answered
+    char *query;           // Query string of the request given to the workers
+    char *output;          // Response, status line and headers included
+    size_t output_length;
+    size_t output_offset;
+    bool keep_alive;
+    bool peer_closed;
+    bool closed;           // Closed while handling a batch of events, freed once the whole batch is handled
+    struct connection *next;     // Next connection of the job queue, of the finished list or of the closed list
+    struct connection *previous_open; // Neighbours in the list of open connections
+    struct connection *next_open;
+} connection;
+
+struct http_server
+{
+    int listen_fd;
+    int epoll_fd;
+    int wakeup_fd; // Written by workers when a response is ready and by stop_http_server
+    int port;
+    atomic_int stop_requested;
+    expression_cache *cache;
+    pthread_mutex_t lock;
+    pthread_cond_t job_ready;
+    connection *first_job; // Requests waiting for a worker, in arrival order
+    connection *last_job;
+    connection *finished;  // Requests answered by a worker, waiting to be written
+    bool stopping;
+    connection *open;      // Every open connection, freed when the server stops
+    connection *closed;    // Connections closed during the batch of events being handled
+};
+
+/**
+ * Writes the true rows of a table after skipping the first skip of them, whole words of rows
+ * being skipped by counting their true rows without formatting them
+ */
+static void write_json_true_rows(FILE *json, const row_formatter *formatter, int64_t skip, int64_t count, bool *first)
+{
+    if (formatter->result_slot < 0)
+    {
+        return;
+    }
+    uint64_t variable_words[27];
+    uint64_t *slots = (uint64_t *)malloc((formatter->compiled->program_length + 1) * sizeof(uint64_t));
+    char *row = (char *)malloc(formatter->row_length);
+    if (slots == NULL || row == NULL)
+    {
+        fprintf(stderr, "Memory allocation for true rows failed in file %s at line %d\n", __FILE__, __LINE__);
+        free(slots);
+        free(row);
+        return;
+    }
+    uint64_t mask = valid_rows_mask(formatter->number_of_variables);
+    int64_t words = number_of_words(formatter->number_of_variables);
+    for (int64_t word = 0; word < words && count > 0; word++)
+    {
+        evaluate_formatter_word(formatter, word, variable_words, slots);
+        uint64_t true_rows = slots[formatter->result_slot] & mask;
+        int number_true = __builtin_popcountll(true_rows);
+        if (skip >= number_true)
+        {
+            skip -= number_true;
+            continue;
+        }
+        for (; true_rows != 0 && count > 0; true_rows &= true_rows - 1)
+        {
+            if (skip > 0)
+            {
+                skip--;
+                continue;
+            }
+            int bit = __builtin_ctzll(true_rows);
+            format_word_rows(formatter, slots, word, bit, bit + 1, false, row);
+            write_json_line(json, row, formatter->row_length, true, first);
+            count--;
+        }
+    }
+    free(slots);
+    free(row);
+}
+
+/**
+ * Decodes a percent encoded query parameter in place, '+' standing for a space
+ */
+static void decode_parameter(char *text)
+{
+    char *output = text;
+    for (char *input = text; *input != '\0'; input++)
+    {
+        if (*input == '%' && isxdigit((unsigned char)input[1]) && isxdigit((unsigned char)input[2]))
+        {
+            char hex[3] = {input[1], input[2], '\0'};
+            *output++ = (char)strtol(hex, NULL, 16);
+            input += 2;
+        }
+        else
+        {
+            *output++ = *input == '+' ? ' ' : *input;
+        }
+    }
+    *output = '\0';
+}
+
+/**
+ * Finds a parameter of a query string, decoded
+ * Caller is responsible for freeing the memory allocated for the string returned.
+ */
+static char *query_parameter(const char *query, const char *name)
+{
+    size_t name_length = strlen(name);
+    const char *position = query;
+    while (position != NULL && *position != '\0')
+    {
+        const char *end = strchr(position, '&');
+        size_t length = end == NULL ? strlen(position) : (size_t)(end - position);
+        if (length > name_length && strncmp(position, name, name_length) == 0 && position[name_length] == '=')
+        {
+            char *value = strndup(position + name_length + 1, length - name_length - 1);
+            if (value != NULL)
+            {
+                decode_parameter(value);
+            }
+            return value;
+        }
+        position = end == NULL ? NULL : end + 1;
+    }
+    return (char *)NULL;
+}
+
+/**
+ * Reads an integer parameter, false if it is there but not an integer
+ */
+static bool integer_parameter(const char *query, const char *name, long default_value, long *value)
+{
+    char *text = query_parameter(query, name);
+    *value = default_value;
+    if (text == NULL)
+    {
+        return true;
+    }
+    char *end;
+    errno = 0;
+    *value = strtol(text, &end, 10);
+    bool valid = end != text && *end == '\0' && errno == 0;
+    free(text);
+    return valid;
+}
+
+int answer_generate_request(expression_cache *cache, const char *query, char **body, size_t *body_length)
+{
+    char *expression = query_parameter(query, "expression");
+    char *mode = query_parameter(query, "mode");
+    long start = 0;
+    long end = 100;
+    bool valid_rows = integer_parameter(query, "start", 0, &start) && integer_parameter(query, "end", 100, &end);
+    bool true_rows = mode != NULL && strcmp(mode, "true_rows") == 0;
+
+    FILE *json = open_memstream(body, body_length);
+    if (json == NULL)
+    {
+        fprintf(stderr, "Failed to open memory stream in %s at line %d\n", __FILE__, __LINE__);
+        exit(EXIT_FAILURE);
+    }
+    int status = 200;
+    if (expression == NULL || !valid_rows || (mode != NULL && !true_rows && strcmp(mode, "truth_table") != 0))
+    {
+        fprintf(json, "{\"error\":\"%s\"}\n", expression == NULL ? "No expression provided" : !valid_rows ? "start and end must be integers" : "Unknown mode");
+        status = 400;
+    }
+    else if (!true_rows && end - start > SERVER_MAX_SEGMENT_ROWS)
+    {
+        fprintf(json, "{\"error\":\"Segments are limited to %d rows\"}\n", SERVER_MAX_SEGMENT_ROWS);
+        status = 400;
+    }
+    else
+    {
+        const cached_expression *entry = acquire_cached_expression(cache, expression);
+        bool first = true;
+        int64_t skip = true_rows ? start : 0;
+        int64_t count = true_rows ? SERVER_PAGE_LINES : INT64_MAX;
+        fputc('[', json);
+        if (entry == NULL || (!true_rows && start < 0))
+        {
+            // What the binary prints, or writes to the file read by server.py
+            write_json_lines(json, INVALID_EXPRESSION_LINES, true_rows, &skip, &count, &first);
+        }
+        else if (true_rows)
+        {
+            write_json_lines(json, entry->header, true, &skip, &count, &first);
+            write_json_lines(json, entry->separator, true, &skip, &count, &first);
+            write_json_true_rows(json, entry->formatter, skip, count, &first);
+        }
+        else if (start < 1L << entry->formatter->number_of_variables)
+        {
+            if (start == 0 && start != end)
+            {
+                write_json_lines(json, entry->header, false, &skip, &count, &first);
+                write_json_lines(json, entry->separator, false, &skip, &count, &first);
+            }
+            long table_rows = 1L << entry->formatter->number_of_variables;
+            char *segment = generate_segment_with_formatter(entry->formatter, start, end < table_rows ? end : table_rows, false);
+            if (segment != NULL)
+            {
+                write_json_lines(json, segment, false, &skip, &count, &first);
+                free(segment);
+            }
+        }
+        fputs("]\n", json);
+        release_cached_expression(cache, entry);
+    }
+    fclose(json);
+    free(expression);
+    free(mode);
+    return status;
+}
+
+static const char *status_text(int status)
+{
+    switch (status)
+    {
+    case 200:
+        return "OK";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    case 413:
+        return "Content Too Large";
+    default:
+        return "Internal Server Error";
+    }
+}
+
+/**
+ * Puts the whole response of a connection, status line and headers included, in its output
+ */
+static void set_response(connection *client, int status, const char *body, size_t body_length)
+{
+    char headers[256];
+    int headers_length = snprintf(headers, sizeof(headers),
+                                  "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\nConnection: %s\r\n\r\n",
+                                  status, status_text(status), body_length, client->keep_alive ? "keep-alive" : "close");
+    client->output = (char *)malloc(headers_length + body_length);
+    if (client->output == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for response in %s at line %d\n", __FILE__, __LINE__);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(client->output, headers, headers_length);
+    memcpy(client->output + headers_length, body, body_length);
+    client->output_length = headers_length + body_length;
+    client->output_offset = 0;
+}
+
+/**
+ * Puts a response with a JSON error message in the output of a connection
+ */
+static void set_error_response(connection *client, int status, const char *message)
+{
+    char body[128];
+    int body_length = snprintf(body, sizeof(body), "{\"error\":\"%s\"}\n", message);
+    set_response(client, status, body, body_length);
+}
+
+static void *server_worker(void *arg)
+{
+    http_server *server = (http_server *)arg;
+    while (true)
+    {
+        pthread_mutex_lock(&server->lock);
+        while (!server->stopping && server->first_job == NULL)
+        {
+            pthread_cond_wait(&server->job_ready, &server->lock);
+        }
+        if (server->stopping)
+        {
+            pthread_mutex_unlock(&server->lock);
+            return NULL;
+        }
+        connection *client = server->first_job;
+        server->first_job = client->next;
+        if (server->first_job == NULL)
+        {
+            server->last_job = NULL;
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        char *body;
+        size_t body_length;
+        int status = answer_generate_request(server->cache, client->query, &body, &body_length);
+        set_response(client, status, body, body_length);
+        free(body);
+
+        pthread_mutex_lock(&server->lock);
+        client->next = server->finished;
+        server->finished = client;
+        pthread_mutex_unlock(&server->lock);
+        uint64_t one = 1;
+        if (write(server->wakeup_fd, &one, sizeof(one)) != sizeof(one))
+        {
+            fprintf(stderr, "Failed to wake the event loop in %s at line %d\n", __FILE__, __LINE__);
+        }
+    }
+}
+
+http_server *create_http_server(int port)
+{
+    http_server *server = (http_server *)calloc(1, sizeof(http_server));
+    if (server == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory for server in %s at line %d\n", __FILE__, __LINE__);
+        return (http_server *)NULL;
+    }
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_cond_init(&server->job_ready, NULL);
+    atomic_init(&server->stop_requested, 0);
+    server->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    server->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    server->cache = create_expression_cache(SERVER_CACHE_CAPACITY);
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    socklen_t address_length = sizeof(address);
+    int reuse = 1;
+    if (server->listen_fd < 0 || server->epoll_fd < 0 || server->wakeup_fd < 0 || server->cache == NULL ||
+        setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(server->listen_fd, SOMAXCONN) != 0 ||
+        getsockname(server->listen_fd, (struct sockaddr *)&address, &address_length) != 0)
+    {
+        fprintf(stderr, "Failed to listen on port %d: %s in %s at line %d\n", port, strerror(errno), __FILE__, __LINE__);
+        free_http_server(server);
+        return (http_server *)NULL;
+    }
+    server->port = ntohs(address.sin_port);
+
+    // The fields themselves tell the listening socket and the wake up events apart from connections
+    struct epoll_event listen_event = {.events = EPOLLIN, .data.ptr = &server->listen_fd};
+    struct epoll_event wakeup_event = {.events = EPOLLIN, .data.ptr = &server->wakeup_fd};
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &listen_event) != 0 ||
+        epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->wakeup_fd, &wakeup_event) != 0)
+    {
+        fprintf(stderr, "Failed to watch the server sockets in %s at line %d\n", __FILE__, __LINE__);
+        free_http_server(server);
+        return (http_server *)NULL;
+    }
+    return server;
+}
+
+int http_server_port(const http_server *server)
+{
+    return server->port;
+}
+
+/**
+ * Closes a connection, which later events of the same batch may still point to, so it is only freed
+ * by free_closed_connections once the batch is handled
+ */
+static void close_connection(http_server *server, connection *client)
+{
+    close(client->fd);
+    client->closed = true;
+    if (client->previous_open != NULL)
+    {
+        client->previous_open->next_open = client->next_open;
+    }
+    else
+    {
+        server->open = client->next_open;
+    }
+    if (client->next_open != NULL)
+    {
+        client->next_open->previous_open = client->previous_open;
+    }
+    client->next = server->closed;
+    server->closed = client;
+}
+
+static void free_closed_connections(http_server *server)
+{
+    while (server->closed != NULL)
+    {
+        connection *client = server->closed;
+        server->closed = client->next;
+        free(client->query);
+        free(client->output);
+        free(client);
+    }
+}
+
+static void accept_connections(http_server *server)
+{
+    while (true)
+    {
+        int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+        connection *client = (connection *)calloc(1, sizeof(connection));
+        if (client == NULL)
+        {
+            fprintf(stderr, "Failed to allocate memory for connection in %s at line %d\n", __FILE__, __LINE__);
+            close(fd);
+            continue;
+        }
+        client->fd = fd;
+        client->state = CONNECTION_READING;
+        client->next_open = server->open;
+        if (server->open != NULL)
+        {
+            server->open->previous_open = client;
+        }
+        server->open = client;
+        struct epoll_event event = {.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data.ptr = client};
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            close_connection(server, client);
+        }
+    }
+}
+
+/**
+ * Finds a header of a request, case insensitively, returning its value or NULL
+ */
+static const char *find_header(const char *headers, const char *name)
+{
+    size_t name_length = strlen(name);
+    for (const char *line = strstr(headers, "\r\n"); line != NULL; line = strstr(line + 2, "\r\n"))
+    {
+        if (strncasecmp(line + 2, name, name_length) == 0 && line[2 + name_length] == ':')
+        {
+            const char *value = line + 3 + name_length;
+            while (*value == ' ')
+            {
+                value++;
+            }
+            return value;
+        }
+    }
+    return (const char *)NULL;
+}
+
+static void write_output(http_server *server, connection *client);
+
+/**
+ * Starts answering the next request of a connection once all of it was read
+ */
+static void start_request(http_server *server, connection *client)
+{
+    char *headers_end = memmem(client->input, client->input_length, "\r\n\r\n", 4);
+    if (headers_end == NULL)
+    {
+        if (client->input_length == SERVER_MAX_REQUEST)
+        {
+            client->keep_alive = false;
+            set_error_response(client, 413, "Request too large");
+            client->state = CONNECTION_WRITING;
+            write_output(server, client);
+        }
+        else if (client->peer_closed)
+        {
+            close_connection(server, client);
+        }
+        return;
+    }
+    size_t headers_length = headers_end - client->input + 4;
+    char headers[headers_length + 1];
+    memcpy(headers, client->input, headers_length);
+    headers[headers_length] = '\0';
+
+    const char *content_length = find_header(headers, "Content-Length");
+    long body_length = content_length == NULL ? 0 : strtol(content_length, NULL, 10);
+    client->request_length = headers_length + (body_length > 0 ? body_length : 0);
+    if (client->request_length > SERVER_MAX_REQUEST)
+    {
+        client->keep_alive = false;
+        set_error_response(client, 413, "Request too large");
+        client->state = CONNECTION_WRITING;
+        write_output(server, client);
+        return;
+    }
+    if (client->input_length < client->request_length)
+    {
+        if (client->peer_closed)
+        {
+            close_connection(server, client);
+        }
+        return;
+    }
+
+    char method[16];
+    char target[SERVER_MAX_REQUEST];
+    char version[16];
+    const char *connection_header = find_header(headers, "Connection");
+    bool parsed = sscanf(headers, "%15s %16383s %15s", method, target, version) == 3;
+    // HTTP/1.1 keeps connections open unless told to close them, HTTP/1.0 only when asked to
+    bool asked_to_close = connection_header != NULL && strncasecmp(connection_header, "close", 5) == 0;
+    bool asked_to_keep = connection_header != NULL && strncasecmp(connection_header, "keep-alive", 10) == 0;
+    client->keep_alive = parsed && !asked_to_close && (asked_to_keep || strcmp(version, "HTTP/1.1") == 0);
+
+    char *query = parsed ? strchr(target, '?') : NULL;
+    size_t path_length = query == NULL ? strlen(target) : (size_t)(query - target);
+    if (!parsed)
+    {
+        set_error_response(client, 400, "Bad request");
+    }
+    else if (strcmp(method, "GET") != 0 && strcmp(method, "POST") != 0)
+    {
+        set_error_response(client, 405, "Method not allowed");
+    }
+    else if (path_length != strlen("/generate") || strncmp(target, "/generate", path_length) != 0)
+    {
+        set_error_response(client, 404, "Not found");
+    }
+    else
+    {
+        client->query = strdup(query == NULL ? "" : query + 1);
+        if (client->query == NULL)
+        {
+            fprintf(stderr, "Failed to allocate memory for request in %s at line %d\n", __FILE__, __LINE__);
+            exit(EXIT_FAILURE);
+        }
+        client->state = CONNECTION_PROCESSING;
+        pthread_mutex_lock(&server->lock);
+        client->next = NULL;
+        if (server->last_job != NULL)
+        {
+            server->last_job->next = client;
+        }
+        else
+        {
+            server->first_job = client;
+        }
+        server->last_job = client;
+        pthread_cond_signal(&server->job_ready);
+        pthread_mutex_unlock(&server->lock);
+        return;
+    }
+    client->state = CONNECTION_WRITING;
+    write_output(server, client);
+}
+
+/**
+ * Reads everything the socket has, then starts the request if the connection is waiting for one
+ */
+static void read_input(http_server *server, connection *client)
+{
+    while (client->input_length < SERVER_MAX_REQUEST)
+    {
+        ssize_t received = read(client->fd, client->input + client->input_length, SERVER_MAX_REQUEST - client->input_length);
+        if (received > 0)
+        {
+            client->input_length += received;
+        }
+        else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            client->peer_closed = true;
+            break;
+        }
+        else if (errno != EINTR)
+        {
+            break;
+        }
+    }
+    // A client that closed its side after sending a request still gets the response
+    if (client->state == CONNECTION_READING)
+    {
+        start_request(server, client);
+    }
+}
+
+/**
+ * Sends as much of the response as the socket takes, then carries on with the next request
+ */
+static void write_output(http_server *server, connection *client)
+{
+    while (client->output_offset < client->output_length)
+    {
+        ssize_t sent = send(client->fd, client->output + client->output_offset, client->output_length - client->output_offset, MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            client->output_offset += sent;
+        }
+        else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return; // Carried on when the socket is writable again
+        }
+        else if (sent < 0 && errno != EINTR)
+        {
+            close_connection(server, client);
+            return;
+        }
+    }
+    free(client->output);
+    client->output = NULL;
+    free(client->query);
+    client->query = NULL;
+    if (!client->keep_alive || client->peer_closed)
+    {
+        close_connection(server, client);
+        return;
+    }
+    memmove(client->input, client->input + client->request_length, client->input_length - client->request_length);
+    client->input_length -= client->request_length;
+    client->request_length = 0;
+    client->state = CONNECTION_READING;
+    read_input(server, client);
+}
+
+int run_http_server(http_server *server)
+{
+    int number_of_workers = number_of_scan_threads();
+    pthread_t workers[number_of_workers];
+    for (int i = 0; i < number_of_workers; i++)
+    {
+        if (pthread_create(&workers[i], NULL, server_worker, server) != 0)
+        {
+            fprintf(stderr, "Failed to create thread in file %s at line %d\n", __FILE__, __LINE__);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (!atomic_load(&server->stop_requested))
+    {
+        int number_of_events = epoll_wait(server->epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        for (int i = 0; i < number_of_events; i++)
+        {
+            if (events[i].data.ptr == &server->listen_fd)
+            {
+                accept_connections(server);
+                continue;
+            }
+            if (events[i].data.ptr == &server->wakeup_fd)
+            {
+                uint64_t count;
+                if (read(server->wakeup_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+                {
+                    fprintf(stderr, "Failed to read wake up events in %s at line %d\n", __FILE__, __LINE__);
+                }
+                pthread_mutex_lock(&server->lock);
+                connection *finished = server->finished;
+                server->finished = NULL;
+                pthread_mutex_unlock(&server->lock);
+                while (finished != NULL)
+                {
+                    connection *next = finished->next;
+                    finished->state = CONNECTION_WRITING;
+                    write_output(server, finished);
+                    finished = next;
+                }
+                continue;
+            }
+
+            // A connection closed while a worker has its request is closed once the response comes back
+            connection *client = (connection *)events[i].data.ptr;
+            if (client->closed)
+            {
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                client->peer_closed = true;
+                if (client->state != CONNECTION_PROCESSING)
+                {
+                    close_connection(server, client);
+                }
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP))
+            {
+                connection_state state = client->state;
+                read_input(server, client);
+                if (state == CONNECTION_READING)
+                {
+                    continue; // The connection may be closed or already writing
+                }
+            }
+            if ((events[i].events & EPOLLOUT) && client->state == CONNECTION_WRITING && !client->closed)
+            {
+                write_output(server, client);
+            }
+        }
+        free_closed_connections(server);
+    }
+
+    pthread_mutex_lock(&server->lock);
+    server->stopping = true;
+    pthread_cond_broadcast(&server->job_ready);
+    pthread_mutex_unlock(&server->lock);
+    for (int i = 0; i < number_of_workers; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    while (server->open != NULL)
+    {
+        close_connection(server, server->open);
+    }
+    free_closed_connections(server);
+    server->first_job = server->last_job = server->finished = NULL;
+    return 0;
+}
+
+void stop_http_server(http_server *server)
+{
+    atomic_store(&server->stop_requested, 1);
+    uint64_t one = 1;
+    if (write(server->wakeup_fd, &one, sizeof(one)) != sizeof(one))
+    {
+        return;
+    }
+}
+
+void free_http_server(http_server *server)
+{
+    if (server == NULL)
+    {
+        return;
+    }
+    if (server->listen_fd >= 0)
+    {
+        close(server->listen_fd);
+    }
+    if (server->epoll_fd >= 0)
+    {
+        close(server->epoll_fd);
+    }
+    if (server->wakeup_fd >= 0)
+    {
+        close(server->wakeup_fd);
+    }
+    free_expression_cache(server->cache);
+    pthread_mutex_destroy(&server->lock);
+    pthread_cond_destroy(&server->job_ready);
+    free(server);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+
+#include "expression_cache.h"
+
+/**
+ * An HTTP server answering the /generate API of server.py, with one thread waiting on every
+ * connection through epoll and a pool of worker threads generating the responses
+ */
+typedef struct http_server http_server;
+
+/**
+ * Function to answer a request of the /generate API with the same JSON array of lines as server.py.
+ * mode=truth_table gives the lines <expression> <start> <end> prints, mode=true_rows the lines
+ * [start, start + 100) of the file <expression> <file_name> writes, header and separator included.
+ * Caller is responsible for freeing the body.
+ * @param cache The cache the compiled expression is taken from
+ * @param query The query string of the request, without the '?', parameters still percent encoded
+ * @param body Receives the JSON body
+ * @param body_length Receives the length of the body
+ * @return The HTTP status of the response
+ */
+int answer_generate_request(expression_cache *cache, const char *query, char **body, size_t *body_length);
+
+/**
+ * Function to create a server listening on a port of every interface, ready to be run.
+ * Caller is responsible for freeing the result with free_http_server.
+ * @param port The port, 0 for any free port
+ * @return The server, or NULL if the port can't be listened on
+ */
+http_server *create_http_server(int port);
+
+/**
+ * Function to get the port a server listens on
+ * @param server The server
+ * @return The port
+ */
+int http_server_port(const http_server *server);
+
+/**
+ * Function to serve requests until stop_http_server is called, then wait for the worker threads
+ * @param server The server
+ * @return 0 once stopped, 1 if the server could not run
+ */
+int run_http_server(http_server *server);
+
+/**
+ * Function to make run_http_server return, safe to call from another thread or a signal handler
+ * @param server The server
+ */
+void stop_http_server(http_server *server);
+
+/**
+ * Function to close a server that is not running and free it
+ * @param server The server, may be NULL
+ */
+void free_http_server(http_server *server);
@@ -0,0 +1,150 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_lines.h"
+
+// Number of rows of a frame of a streamed segment
+#define STREAM_SEGMENT_ROWS 4096
+
+void write_json_string(FILE *json, const char *text, size_t length)
+{
+    fputc('"', json);
+    size_t plain = 0; // Start of the run of characters written as they are
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned char c = text[i];
+        if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        fwrite(text + plain, 1, i - plain, json);
+        plain = i + 1;
+        if (c == '"' || c == '\\')
+        {
+            fputc('\\', json);
+            fputc(c, json);
+        }
+        else if (c == '\n')
+        {
+            fputs("\\n", json);
+        }
+        else
+        {
+            fprintf(json, "\\u%04x", c);
+        }
+    }
+    fwrite(text + plain, 1, length - plain, json);
+    fputc('"', json);
+}
+
+void write_json_line(FILE *json, const char *line, size_t length, bool keep_new_line, bool *first)
+{
+    if (!*first)
+    {
+        fputc(',', json);
+    }
+    *first = false;
+    if (!keep_new_line && length > 0 && line[length - 1] == '\n')
+    {
+        length--;
+    }
+    write_json_string(json, line, length);
+}
+
+void write_json_lines(FILE *json, const char *text, bool keep_new_line, int64_t *skip, int64_t *count, bool *first)
+{
+    while (*text != '\0' && *count > 0)
+    {
+        const char *end = strchr(text, '\n');
+        size_t length = end == NULL ? strlen(text) : (size_t)(end - text + 1);
+        if (*skip > 0)
+        {
+            (*skip)--;
+        }
+        else
+        {
+            write_json_line(json, text, length, keep_new_line, first);
+            (*count)--;
+        }
+        text += length;
+    }
+}
+
+/**
+ * A stream of frames being written, and whether the JSON array it holds has no element yet
+ */
+typedef struct
+{
+    FILE *stream;
+    bool first;
+} frame_stream;
+
+/**
+ * Writes a frame, its number of bytes on a line then the bytes, and flushes it to the reader
+ */
+static void write_frame(frame_stream *frames, const char *payload, size_t length)
+{
+    fprintf(frames->stream, "%zu\n", length);
+    fwrite(payload, 1, length, frames->stream);
+    fflush(frames->stream);
+}
+
+/**
+ * Writes the lines of a text as the elements of the next frame of the JSON array
+ */
+static void write_lines_frame(frame_stream *frames, const char *prefix, const char *text, const char *suffix)
+{
+    char *payload = NULL;
+    size_t length = 0;
+    FILE *json = open_memstream(&payload, &length);
+    if (json == NULL)
+    {
+        fprintf(stderr, "Failed to open memory stream in %s at line %d\n", __FILE__, __LINE__);
+        exit(EXIT_FAILURE);
+    }
+    int64_t skip = 0;
+    int64_t count = INT64_MAX;
+    fputs(prefix, json);
+    write_json_lines(json, text, false, &skip, &count, &frames->first);
+    fputs(suffix, json);
+    fclose(json);
+    if (length > 0)
+    {
+        write_frame(frames, payload, length);
+    }
+    free(payload);
+}
+
+static void write_segment_frame(const char *segment, void *context)
+{
+    write_lines_frame((frame_stream *)context, "", segment, "");
+}
+
+void stream_json_segment(const row_formatter *formatter, const char *header, const char *separator, int start_row, int end_row, FILE *stream)
+{
+    frame_stream frames = {stream, true};
+    if (formatter == NULL || start_row < 0)
+    {
+        write_lines_frame(&frames, "[", INVALID_EXPRESSION_LINES, "]\n");
+    }
+    else
+    {
+        if (start_row == 0 && start_row != end_row)
+        {
+            write_lines_frame(&frames, "[", header, "");
+            write_lines_frame(&frames, "", separator, "");
+        }
+        else
+        {
+            write_frame(&frames, "[", 1);
+        }
+        if (start_row < 1 << formatter->number_of_variables)
+        {
+            stream_formatter_segments(formatter, start_row, end_row, false, STREAM_SEGMENT_ROWS, write_segment_frame, &frames);
+        }
+        write_frame(&frames, "]\n", 2);
+    }
+    write_frame(&frames, "", 0);
+}
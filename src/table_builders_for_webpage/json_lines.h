@@ -0,0 +1,54 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "table_builders.h"
+
+// What the binary prints for an invalid expression, as lines
+#define INVALID_EXPRESSION_LINES "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n"
+
+/**
+ * Function to write a string as a JSON string, escaping what JSON requires and non ASCII bytes like jsonify does
+ * @param json The file written to
+ * @param text The string
+ * @param length The number of characters of the string
+ */
+void write_json_string(FILE *json, const char *text, size_t length);
+
+/**
+ * Function to write a line as an element of a JSON array of lines
+ * @param json The file written to
+ * @param line The line
+ * @param length The number of characters of the line, its '\n' included
+ * @param keep_new_line Whether the element keeps the '\n' like the lines read from a file by server.py,
+ * or loses it like the lines of splitlines
+ * @param first Whether no element was written yet, cleared once one is
+ */
+void write_json_line(FILE *json, const char *line, size_t length, bool keep_new_line, bool *first);
+
+/**
+ * Function to write every line of a text as elements of a JSON array of lines
+ * @param json The file written to
+ * @param text The lines
+ * @param keep_new_line Whether the elements keep their '\n'
+ * @param skip The number of lines left to skip before writing any, decremented by the lines skipped
+ * @param count The number of lines left to write, decremented by the lines written
+ * @param first Whether no element was written yet, cleared once one is
+ */
+void write_json_lines(FILE *json, const char *text, bool keep_new_line, int64_t *skip, int64_t *count, bool *first);
+
+/**
+ * Function to stream the JSON array of lines of a segment, the lines <expression> <start> <end> prints,
+ * in frames written as soon as each part of the segment is generated, in order. A frame is its
+ * number of bytes on a line then the bytes, the concatenated frames being the JSON array, and a
+ * frame of 0 bytes ends the stream. The frames can be forwarded as they come, with HTTP chunked
+ * transfer encoding for instance, so the first rows don't wait for the whole segment.
+ * @param formatter The row formatter of the expression, NULL if the expression is invalid
+ * @param header The header of the table
+ * @param separator The separator of the table
+ * @param start_row The first row of the segment
+ * @param end_row The row after the last row of the segment, clamped to the size of the table
+ * @param stream Where the frames are written, flushed after every frame
+ */
+void stream_json_segment(const row_formatter *formatter, const char *header, const char *separator, int start_row, int end_row, FILE *stream);
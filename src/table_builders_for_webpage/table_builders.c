@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,14 +8,397 @@
 #include <unistd.h>
 #include <math.h>
 #include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
 
 #include "../rpn_evaluator/evaluation.h"
 #include "../converters/binary_converter.h"
-#include "../converters/shunting_yard.h"
+#include "../converters/expression_parser.h"
+#include "../converters/functions.h"
 #include "../utils/find_nr_of_vars.h"
+#include "../utils/parallel_scan.h"
 
 #include "table_builders.h"
 
+static bool is_operator_token(char token)
+{
+    return (token == '-' || token == '&' || token == '#' ||
+            token == '|' || token == '>' || token == '=' || is_function_token(token));
+}
+
+/**
+ * Allocates a row formatter for a compiled expression, taking ownership of it, with the blank
+ * template row of a table whose expression column is expression_length characters wide
+ */
+static row_formatter *allocate_row_formatter(compiled_expression *compiled, int expression_length)
+{
+    row_formatter *formatter = (row_formatter *)calloc(1, sizeof(row_formatter));
+    if (formatter == NULL)
+    {
+        free_compiled_expression(compiled);
+        return (row_formatter *)NULL;
+    }
+    formatter->compiled = compiled;
+    formatter->native = compile_native(compiled);
+    formatter->number_of_variables = compiled->number_of_variables;
+    formatter->row_length = compiled->number_of_variables * 2 + expression_length + 9;
+    formatter->template_row = (char *)malloc(formatter->row_length + 1);
+    formatter->value_columns = (int *)malloc((compiled->program_length + 1) * sizeof(int));
+    formatter->value_slots = (int *)malloc((compiled->program_length + 1) * sizeof(int));
+    if (formatter->template_row == NULL || formatter->value_columns == NULL || formatter->value_slots == NULL)
+    {
+        free_row_formatter(formatter);
+        return (row_formatter *)NULL;
+    }
+
+    // Same layout as generate_postfix_row and generate_infix_row
+    int expression_start = compiled->number_of_variables * 2 + 2;
+    memset(formatter->template_row, ' ', formatter->row_length);
+    formatter->template_row[expression_start - 2] = ':';
+    formatter->template_row[expression_start + expression_length + 1] = ':';
+    formatter->template_row[formatter->row_length - 1] = '\n';
+    formatter->template_row[formatter->row_length] = '\0';
+    formatter->result_slot = compiled->program_length - 1;
+    formatter->result_column = formatter->row_length - 2;
+    return formatter;
+}
+
+row_formatter *create_row_formatter(const char *rpn_expression, const int *map, int expression_length)
+{
+    compiled_expression *compiled = compile_mapped_rpn(rpn_expression, map, NULL);
+    if (compiled == NULL)
+    {
+        return (row_formatter *)NULL;
+    }
+    row_formatter *formatter = allocate_row_formatter(compiled, expression_length);
+    if (formatter == NULL)
+    {
+        return (row_formatter *)NULL;
+    }
+    int expression_start = compiled->number_of_variables * 2 + 2;
+
+    // Only operators show their value, operands are left blank
+    for (int i = 0; i < compiled->program_length; i++)
+    {
+        const instruction *current = &compiled->program[i];
+        if (current->op == OP_VARIABLE || current->op == OP_CONSTANT)
+        {
+            continue;
+        }
+        int position = map == NULL ? current->rpn_position : map[current->rpn_position];
+        if (position < 0 || position >= expression_length)
+        {
+            continue;
+        }
+        formatter->value_columns[formatter->number_of_values] = expression_start + position;
+        formatter->value_slots[formatter->number_of_values] = i;
+        formatter->number_of_values++;
+    }
+
+    // The result column copies the last character of the evaluated rpn, except for single character expressions
+    int rpn_length = strlen(rpn_expression);
+    if (expression_length == 1 || (rpn_length > 0 && is_operator_token(rpn_expression[rpn_length - 1])))
+    {
+        formatter->result_slot = compiled->program_length - 1;
+    }
+    else
+    {
+        formatter->result_slot = -1;
+    }
+    return formatter;
+}
+
+row_formatter *create_parsed_row_formatter(const parsed_expression *parsed)
+{
+    return create_row_formatter(parsed->rpn_expression, parsed->map, parsed->expression_length);
+}
+
+row_formatter *create_compiled_row_formatter(compiled_expression *compiled, const char *label)
+{
+    // Expressions that were never text have no intermediate results to show under the label
+    return allocate_row_formatter(compiled, strlen(label));
+}
+
+row_formatter *create_truth_vector_row_formatter(uint64_t *truth_vector, const char *variables, const char *label)
+{
+    // The program only gives the formatter its variables, results come from the truth vector
+    compiled_expression *compiled = compile_rpn("0", variables);
+    row_formatter *formatter = compiled == NULL ? NULL : allocate_row_formatter(compiled, strlen(label));
+    if (formatter == NULL)
+    {
+        free(truth_vector);
+        return (row_formatter *)NULL;
+    }
+    free_native_expression(formatter->native);
+    formatter->native = NULL;
+    formatter->truth_vector = truth_vector;
+    return formatter;
+}
+
+void free_row_formatter(row_formatter *formatter)
+{
+    if (formatter == NULL)
+    {
+        return;
+    }
+    free_native_expression(formatter->native);
+    free_compiled_expression(formatter->compiled);
+    free(formatter->template_row);
+    free(formatter->value_columns);
+    free(formatter->value_slots);
+    free(formatter->variable_columns);
+    free(formatter->truth_vector);
+    free(formatter);
+}
+
+void evaluate_formatter_word(const row_formatter *formatter, int64_t word_index, uint64_t *variable_words, uint64_t *slots)
+{
+    if (formatter->truth_vector != NULL)
+    {
+        slots[formatter->result_slot] = formatter->truth_vector[word_index];
+        return;
+    }
+    fill_variable_words(formatter->number_of_variables, word_index, variable_words);
+    if (formatter->native != NULL)
+    {
+        formatter->native->function(variable_words, slots);
+    }
+    else
+    {
+        evaluate_word_slots(formatter->compiled, variable_words, slots);
+    }
+}
+
+int format_word_rows(const row_formatter *formatter, const uint64_t *slots, int64_t word_index, int first_bit, int end_bit, bool only_true, char *output)
+{
+    int number_of_variables = formatter->number_of_variables;
+    int row_length = formatter->row_length;
+    uint64_t results = formatter->result_slot >= 0 ? slots[formatter->result_slot] : 0;
+    int added_rows = 0;
+
+    for (int bit = first_bit; bit < end_bit; bit++)
+    {
+        if (only_true && ((results >> bit) & 1) == 0)
+        {
+            continue;
+        }
+        char *row = output + (int64_t)added_rows * row_length;
+        int64_t row_number = word_index * 64 + bit;
+        memcpy(row, formatter->template_row, row_length);
+        for (int j = 0; j < number_of_variables; j++)
+        {
+            int column = formatter->variable_columns == NULL ? 2 * j : formatter->variable_columns[j];
+            row[column] = ((row_number >> (number_of_variables - 1 - j)) & 1) + '0';
+        }
+        for (int v = 0; v < formatter->number_of_values; v++)
+        {
+            row[formatter->value_columns[v]] = ((slots[formatter->value_slots[v]] >> bit) & 1) + '0';
+        }
+        if (formatter->result_slot >= 0)
+        {
+            row[formatter->result_column] = ((results >> bit) & 1) + '0';
+        }
+        added_rows++;
+    }
+    return added_rows;
+}
+
+int64_t write_formatter_rows(const row_formatter *formatter, int start_row, int end_row, bool only_true, char *output)
+{
+    uint64_t *variable_words = (uint64_t *)malloc((formatter->number_of_variables + 1) * sizeof(uint64_t));
+    uint64_t *slots = (uint64_t *)malloc((formatter->compiled->program_length + 1) * sizeof(uint64_t));
+    if (variable_words == NULL || slots == NULL)
+    {
+        fprintf(stderr, "Memory allocation for rows failed in file %s at line %d\n", __FILE__, __LINE__);
+        free(variable_words);
+        free(slots);
+        return -1;
+    }
+
+    int64_t written_rows = 0;
+    for (int64_t word = start_row >> 6; word * 64 < end_row; word++)
+    {
+        int first_bit = word * 64 < start_row ? start_row - word * 64 : 0;
+        int end_bit = end_row - word * 64 < 64 ? end_row - word * 64 : 64;
+        evaluate_formatter_word(formatter, word, variable_words, slots);
+        written_rows += format_word_rows(formatter, slots, word, first_bit, end_bit, only_true,
+                                         output + written_rows * formatter->row_length);
+    }
+
+    free(variable_words);
+    free(slots);
+    return written_rows;
+}
+
+char *generate_segment_with_formatter(const row_formatter *formatter, int start_row, int end_row, bool only_true)
+{
+    // Making sure not to overshoot the table
+    if (end_row > (1 << formatter->number_of_variables))
+    {
+        end_row = (1 << formatter->number_of_variables);
+    }
+    if (start_row < 0 || end_row < start_row)
+    {
+        end_row = start_row = 0;
+    }
+
+    int64_t segment_length = (int64_t)(end_row - start_row) * formatter->row_length;
+    char *segment = (char *)malloc(segment_length + 1);
+    if (segment == NULL)
+    {
+        fprintf(stderr, "Memory allocation for segment failed in file %s at line %d\n", __FILE__, __LINE__);
+        return (char *)NULL;
+    }
+    int64_t written_rows = write_formatter_rows(formatter, start_row, end_row, only_true, segment);
+    if (written_rows < 0)
+    {
+        free(segment);
+        return (char *)NULL;
+    }
+    segment[written_rows * formatter->row_length] = '\0';
+    return segment;
+}
+
+bool parse_partial_assignment(const char *text, partial_assignment *assignment)
+{
+    memset(assignment, 0, sizeof(partial_assignment));
+    int i = 0;
+    while (text[i] != '\0')
+    {
+        char variable = text[i];
+        if (!islower(variable) || text[i + 1] != '=' || (text[i + 2] != '0' && text[i + 2] != '1') ||
+            strchr(assignment->variables, variable) != NULL)
+        {
+            return false;
+        }
+        assignment->values[assignment->number_of_fixed] = text[i + 2] == '1';
+        assignment->variables[assignment->number_of_fixed++] = variable;
+        i += 3;
+        if (text[i] == ',' && text[i + 1] != '\0')
+        {
+            i++;
+        }
+        else if (text[i] != '\0')
+        {
+            return false;
+        }
+    }
+    return assignment->number_of_fixed > 0;
+}
+
+row_formatter *create_cofactor_row_formatter(const parsed_expression *parsed, const partial_assignment *fixed)
+{
+    for (int k = 0; k < fixed->number_of_fixed; k++)
+    {
+        if (strchr(parsed->variables, fixed->variables[k]) == NULL)
+        {
+            fprintf(stderr, "Variable %c is not in the expression\n", fixed->variables[k]);
+            return (row_formatter *)NULL;
+        }
+    }
+    row_formatter *formatter = create_parsed_row_formatter(parsed);
+    if (formatter == NULL)
+    {
+        return (row_formatter *)NULL;
+    }
+    formatter->variable_columns = (int *)malloc((parsed->number_of_variables + 1) * sizeof(int));
+    if (formatter->variable_columns == NULL)
+    {
+        fprintf(stderr, "Memory allocation for row formatter failed in file %s at line %d\n", __FILE__, __LINE__);
+        free_row_formatter(formatter);
+        return (row_formatter *)NULL;
+    }
+
+    // Fixed columns are written once in the template, the others are renumbered in order
+    compiled_expression *compiled = formatter->compiled;
+    int free_index[26];
+    int number_of_free = 0;
+    for (int j = 0; j < parsed->number_of_variables; j++)
+    {
+        const char *position = strchr(fixed->variables, compiled->variables[j]);
+        if (position != NULL)
+        {
+            free_index[j] = -1 - (fixed->values[position - fixed->variables] ? 1 : 0);
+            formatter->template_row[2 * j] = fixed->values[position - fixed->variables] ? '1' : '0';
+        }
+        else
+        {
+            free_index[j] = number_of_free;
+            formatter->variable_columns[number_of_free] = 2 * j;
+            compiled->variables[number_of_free++] = compiled->variables[j];
+        }
+    }
+    compiled->variables[number_of_free] = '\0';
+    compiled->number_of_variables = number_of_free;
+    formatter->number_of_variables = number_of_free;
+
+    for (int i = 0; i < compiled->program_length; i++)
+    {
+        instruction *current = &compiled->program[i];
+        if (current->op != OP_VARIABLE)
+        {
+            continue;
+        }
+        if (free_index[current->operand] < 0)
+        {
+            current->op = OP_CONSTANT;
+            current->operand = free_index[current->operand] == -2 ? 1 : 0;
+        }
+        else
+        {
+            current->operand = free_index[current->operand];
+        }
+    }
+
+    // The native code was generated for the full table
+    free_native_expression(formatter->native);
+    formatter->native = compile_native(compiled);
+    return formatter;
+}
+
+char *generate_cofactor_segment(const parsed_expression *parsed, const partial_assignment *fixed, int start_row, int end_row, bool only_true)
+{
+    row_formatter *formatter = create_cofactor_row_formatter(parsed, fixed);
+    if (formatter == NULL)
+    {
+        fprintf(stderr, "Failed to generate segment in file %s at line %d\n", __FILE__, __LINE__);
+        return (char *)NULL;
+    }
+    char *segment = generate_segment_with_formatter(formatter, start_row, end_row, only_true);
+    free_row_formatter(formatter);
+    return segment;
+}
+
+bool generate_cofactor_table_body(const parsed_expression *parsed, const partial_assignment *fixed, FILE *file)
+{
+    row_formatter *formatter = create_cofactor_row_formatter(parsed, fixed);
+    if (formatter == NULL)
+    {
+        return false;
+    }
+    char *header = generate_header(parsed->expression);
+    char *separator = generate_separator(parsed->expression);
+    generate_formatter_table_body(formatter, header, separator, file);
+    free(header);
+    free(separator);
+    free_row_formatter(formatter);
+    return true;
+}
+
+char *generate_parsed_segment(const parsed_expression *parsed, int start_row, int end_row, bool only_true)
+{
+    row_formatter *formatter = create_parsed_row_formatter(parsed);
+    if (formatter == NULL)
+    {
+        fprintf(stderr, "Failed to generate segment in file %s at line %d\n", __FILE__, __LINE__);
+        return (char *)NULL;
+    }
+    char *segment = generate_segment_with_formatter(formatter, start_row, end_row, only_true);
+    free_row_formatter(formatter);
+    return segment;
+}
+
 char *generate_postfix_row(int row_number, int number_of_variables, const char *expression, int expr_length)
 {
     int row_length = number_of_variables * 2 + expr_length + 10;
@@ -96,12 +480,6 @@ char *generate_postfix_row(int row_number, int number_of_variables, const char *
 
 char *generate_postfix_truth_table_segment(const char *expression, int start_row, int end_row)
 {
-    // Making sure not to overshoot the table
-    if (end_row >= (1 << count_unique_variables(expression)))
-    {
-        end_row = (1 << count_unique_variables(expression));
-    }
-
     if (start_row < 0)
     {
         fprintf(stderr, "Failed to generate segment in file %s at line %d: invalid start row %d\n", __FILE__, __LINE__, start_row);
@@ -113,39 +491,14 @@ char *generate_postfix_truth_table_segment(const char *expression, int start_row
         return (char *)NULL;
     }
 
-    int expr_length = strlen(expression);
-    int number_of_variables = count_unique_variables(expression);
-    int number_of_rows = end_row - start_row + 1;
-    int row_length = number_of_variables * 2 + strlen(expression) + 9;
-
-    int64_t segment_length = (int64_t)number_of_rows * row_length;
-    char *segment = (char *)malloc(segment_length + 1);
-
-    if (segment == NULL)
+    parsed_expression *parsed = parse_expression(expression);
+    if (parsed == NULL)
     {
-        fprintf(stderr, "Memory allocation for postfix segment failed in file %s at line %d\n", __FILE__, __LINE__);
+        fprintf(stderr, "Failed to generate segment in file %s at line %d\n", __FILE__, __LINE__);
         return (char *)NULL;
     }
-
-    int added_rows = 0;
-    // Generate the segment
-    for (int i = start_row; i < end_row; i++)
-    {
-        char *row = generate_postfix_row(i, number_of_variables, expression, expr_length);
-
-        if (row == NULL)
-        {
-            fprintf(stderr, "Failed to generate row in file %s at line %d\n", __FILE__, __LINE__);
-            free(segment);
-            return (char *)NULL;
-        }
-
-        memcpy(segment + added_rows * row_length, row, row_length + 1);
-        added_rows++;
-        free(row);
-    }
-    segment[segment_length] = '\0';
-
+    char *segment = generate_parsed_segment(parsed, start_row, end_row, false);
+    free_parsed_expression(parsed);
     return segment;
 }
 
@@ -161,42 +514,16 @@ char *generate_true_postfix_truth_table_segment(const char *expression, int expr
         fprintf(stderr, "Failed to generate segment in file %s at line %d: invalid end row %d\n", __FILE__, __LINE__, end_row);
         return (char *)NULL;
     }
-    // Making sure not to overshoot the table
-    if (end_row >= (1 << count_unique_variables(expression)))
-    {
-        end_row = (1 << count_unique_variables(expression));
-    }
-    int number_of_rows = end_row - start_row;
-    int row_length = number_of_variables * 2 + expr_length + 9;
-    int64_t segment_length = (int64_t)number_of_rows * row_length;
-    char *segment = (char *)calloc(segment_length + 1, sizeof(char));
 
-    if (segment == NULL)
+    row_formatter *formatter = create_row_formatter(expression, NULL, expr_length);
+    if (formatter == NULL || formatter->number_of_variables != number_of_variables)
     {
-        fprintf(stderr, "Memory allocation for true postfix segment failed in file %s at line %d\n", __FILE__, __LINE__);
+        fprintf(stderr, "Failed to generate true segment in file %s at line %d\n", __FILE__, __LINE__);
+        free_row_formatter(formatter);
         return (char *)NULL;
     }
-
-    int added_rows = 0;
-    // Generate the segment
-    for (int i = start_row; i < end_row; i++)
-    {
-        char *row = generate_postfix_row(i, number_of_variables, expression, expr_length);
-        if (row == NULL)
-        {
-            fprintf(stderr, "Failed to generate row in file %s at line %d\n", __FILE__, __LINE__);
-            free(segment);
-            return (char *)NULL;
-        }
-        if (row[row_length - 2] == '1')
-        {
-            memcpy(segment + (int64_t)added_rows * row_length, row, row_length);
-            added_rows++;
-        }
-        free(row);
-    }
-    segment[segment_length] = '\0';
-
+    char *segment = generate_segment_with_formatter(formatter, start_row, end_row, true);
+    free_row_formatter(formatter);
     return segment;
 }
 
@@ -204,19 +531,20 @@ void *postfix_rows_generator(void *arg)
 {
     postfix_thread_data *data = (postfix_thread_data *)arg;
     // Generate the segment data
-    char *segment = generate_true_postfix_truth_table_segment(data->expression, data->expression_length, data->number_of_variables, data->start_row, data->end_row);
+    char *segment = generate_segment_with_formatter(data->formatter, data->start_row, data->end_row, true);
     if (segment == NULL)
     {
         fprintf(data->file, "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
         exit(EXIT_FAILURE);
     }
+    if (data->segment_true_rows != NULL)
+    {
+        // Recorded before handing the turn over, so every count is there once the last segment is written
+        data->segment_true_rows[data->segment_index] = strlen(segment) / data->formatter->row_length;
+    }
     if (data->start_row == 0 && data->end_row != data->start_row)
     {
-        char *header = generate_header(data->expression);
-        char *separator = generate_separator(data->expression);
-        fprintf(data->file, "%s%s", header, separator);
-        free(header);
-        free(separator);
+        fprintf(data->file, "%s%s", data->header, data->separator);
     }
     sem_wait(&data->semaphore[data->thread_id]);
 
@@ -228,12 +556,33 @@ void *postfix_rows_generator(void *arg)
     pthread_exit(NULL);
 }
 
-void generate_postfix_table_body(const char *expression, FILE *file)
+static void write_formatter_table_body(const row_formatter *formatter, const char *header, const char *separator, FILE *file, int64_t *segment_true_rows);
+
+static void write_postfix_table_body(const parsed_expression *parsed, FILE *file, int64_t *segment_true_rows)
 {
-    int segment_size = 1000;
-    int number_of_variables = count_unique_variables(expression);
-    int expression_length = strlen(expression);
-    int number_of_rows = 1 << number_of_variables;
+    // Compiled once and shared by every segment thread
+    row_formatter *formatter = create_parsed_row_formatter(parsed);
+    if (formatter == NULL)
+    {
+        fprintf(file, "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+    char *header = generate_header(parsed->expression);
+    char *separator = generate_separator(parsed->expression);
+    write_formatter_table_body(formatter, header, separator, file, segment_true_rows);
+    free(header);
+    free(separator);
+    free_row_formatter(formatter);
+}
+
+/**
+ * Writes the true rows of a table with the segment threads, recording the true rows of each segment
+ * when segment_true_rows isn't NULL
+ */
+static void write_formatter_table_body(const row_formatter *formatter, const char *header, const char *separator, FILE *file, int64_t *segment_true_rows)
+{
+    int segment_size = TABLE_BODY_SEGMENT_SIZE;
+    int number_of_rows = 1 << formatter->number_of_variables;
     int number_of_segments = number_of_rows / segment_size + (number_of_rows % segment_size != 0 ? 1 : 0);
 
     // Set the maximum number of threads to create in each batch
@@ -296,55 +645,403 @@ void generate_postfix_table_body(const char *expression, FILE *file)
         thread_data[current_thread_index].semaphore = semaphores;
         thread_data[current_thread_index].num_threads = threads_num;
         thread_data[current_thread_index].thread_id = current_thread_index;
-        thread_data[current_thread_index].expression_length = expression_length;
-        thread_data[current_thread_index].expression = expression;
-        thread_data[current_thread_index].number_of_variables = number_of_variables;
+        thread_data[current_thread_index].number_of_variables = formatter->number_of_variables;
+        thread_data[current_thread_index].header = header;
+        thread_data[current_thread_index].separator = separator;
+        thread_data[current_thread_index].formatter = formatter;
         thread_data[current_thread_index].creation_semaphore = &creation_semaphore;
+        thread_data[current_thread_index].segment_index = current_segment;
+        thread_data[current_thread_index].segment_true_rows = segment_true_rows;
 
         // Update start_row for the next segment
         start_row = thread_data[current_thread_index].end_row;
 
-        // Create the thread
-        int rc = pthread_create(&threads[current_thread_index], NULL, postfix_rows_generator, &thread_data[current_thread_index]);
-        if (rc)
-        {
-            fprintf(stderr, "Error creating thread %d: %d\n", current_segment, rc);
-            exit(EXIT_FAILURE);
-        }
+        // Create the thread
+        int rc = pthread_create(&threads[current_thread_index], NULL, postfix_rows_generator, &thread_data[current_thread_index]);
+        if (rc)
+        {
+            fprintf(stderr, "Error creating thread %d: %d\n", current_segment, rc);
+            exit(EXIT_FAILURE);
+        }
+
+        // Join or detach the thread if necessary
+
+        // Joining only the thread for the last needed segment to ensure the entire table is printed
+        if (current_segment == number_of_segments - 1)
+        {
+            if (pthread_join(threads[current_thread_index], NULL) != 0)
+            {
+                fprintf(stderr, "Failed to join thread in file %s at line %d\n", __FILE__, __LINE__);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        // Detach the thread
+        else
+        {
+            if (pthread_detach(threads[current_thread_index]) != 0)
+            {
+                fprintf(stderr, "Failed to detach thread in file %s at line %d\n", __FILE__, __LINE__);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        // Increment the current_thread_index in a circular manner
+        current_segment += 1;
+        current_thread_index = (current_segment) % (threads_num);
+    }
+
+    // The detached threads give their slot back last, so once every slot is back none of them
+    // still uses the semaphores or the thread data
+    for (int i = 0; i < threads_num; i++)
+    {
+        sem_wait(&creation_semaphore);
+    }
+
+    // Clean up: destroy semaphores
+    for (int i = 0; i < threads_num; i++)
+    {
+        sem_destroy(&semaphores[i]);
+    }
+    sem_destroy(&creation_semaphore);
+}
+
+void generate_formatter_table_body(const row_formatter *formatter, const char *header, const char *separator, FILE *file)
+{
+    write_formatter_table_body(formatter, header, separator, file, NULL);
+}
+
+/**
+ * Data of a thread streaming the segments thread_id, thread_id + num_threads, ... of a range
+ */
+typedef struct
+{
+    const row_formatter *formatter;
+    sem_t *semaphore;
+    int num_threads;
+    int thread_id;
+    int number_of_segments;
+    int start_row;
+    int end_row;
+    int segment_size;
+    bool only_true;
+    segment_consumer consumer;
+    void *context;
+} stream_thread_data;
+
+static void *stream_segments_generator(void *arg)
+{
+    stream_thread_data *data = (stream_thread_data *)arg;
+    for (int segment_index = data->thread_id; segment_index < data->number_of_segments; segment_index += data->num_threads)
+    {
+        int start_row = data->start_row + segment_index * data->segment_size;
+        int end_row = data->end_row - start_row > data->segment_size ? start_row + data->segment_size : data->end_row;
+        char *segment = generate_segment_with_formatter(data->formatter, start_row, end_row, data->only_true);
+        if (segment == NULL)
+        {
+            exit(EXIT_FAILURE);
+        }
+        // The previous segment hands the turn over once consumed
+        sem_wait(&data->semaphore[data->thread_id]);
+        data->consumer(segment, data->context);
+        sem_post(&data->semaphore[(data->thread_id + 1) % data->num_threads]);
+        free(segment);
+    }
+    return NULL;
+}
+
+void stream_formatter_segments(const row_formatter *formatter, int start_row, int end_row, bool only_true, int segment_size, segment_consumer consumer, void *context)
+{
+    int number_of_rows = 1 << formatter->number_of_variables;
+    if (end_row > number_of_rows)
+    {
+        end_row = number_of_rows;
+    }
+    if (start_row >= end_row)
+    {
+        return;
+    }
+    int number_of_segments = (end_row - start_row - 1) / segment_size + 1;
+    int threads_num = number_of_scan_threads();
+    if (threads_num > number_of_segments)
+    {
+        threads_num = number_of_segments;
+    }
+
+    pthread_t threads[threads_num];
+    stream_thread_data thread_data[threads_num];
+    sem_t semaphores[threads_num];
+    for (int i = 0; i < threads_num; i++)
+    {
+        if (sem_init(&semaphores[i], 0, i == 0 ? 1 : 0) == -1)
+        {
+            fprintf(stderr, "Failed to initialise semaphore in file %s at line %d\n", __FILE__, __LINE__);
+            exit(EXIT_FAILURE);
+        }
+        thread_data[i] = (stream_thread_data){formatter, semaphores, threads_num, i, number_of_segments, start_row, end_row, segment_size, only_true, consumer, context};
+    }
+    // The calling thread streams its share of the segments too
+    for (int i = 1; i < threads_num; i++)
+    {
+        int rc = pthread_create(&threads[i], NULL, stream_segments_generator, &thread_data[i]);
+        if (rc)
+        {
+            fprintf(stderr, "Error creating thread %d: %d\n", i, rc);
+            exit(EXIT_FAILURE);
+        }
+    }
+    stream_segments_generator(&thread_data[0]);
+    for (int i = 1; i < threads_num; i++)
+    {
+        if (pthread_join(threads[i], NULL) != 0)
+        {
+            fprintf(stderr, "Failed to join thread in file %s at line %d\n", __FILE__, __LINE__);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < threads_num; i++)
+    {
+        sem_destroy(&semaphores[i]);
+    }
+}
+
+/**
+ * Context shared by the threads writing the segments of a table file at their own offsets
+ */
+typedef struct
+{
+    const row_formatter *formatter;
+    int fd;
+    off_t rows_offset;
+    int number_of_rows;
+    atomic_int failed;
+} positional_write_context;
+
+/**
+ * Writes a whole buffer at an offset of a file, however many calls it takes
+ */
+static bool pwrite_fully(int fd, const char *buffer, size_t length, off_t offset)
+{
+    while (length > 0)
+    {
+        ssize_t written = pwrite(fd, buffer, length, offset);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            fprintf(stderr, "Failed to write the table file in %s at line %d\n", __FILE__, __LINE__);
+            return false;
+        }
+        buffer += written;
+        length -= written;
+        offset += written;
+    }
+    return true;
+}
+
+static void positional_write_task(void *arg, int64_t first_segment, int64_t end_segment)
+{
+    positional_write_context *context = (positional_write_context *)arg;
+    const row_formatter *formatter = context->formatter;
+    char *segment = (char *)malloc((size_t)POSITIONAL_SEGMENT_SIZE * formatter->row_length);
+    if (segment == NULL)
+    {
+        fprintf(stderr, "Memory allocation for segment failed in file %s at line %d\n", __FILE__, __LINE__);
+        atomic_store(&context->failed, 1);
+        return;
+    }
+    for (int64_t segment_index = first_segment; segment_index < end_segment && !atomic_load(&context->failed); segment_index++)
+    {
+        int start_row = segment_index * POSITIONAL_SEGMENT_SIZE;
+        int end_row = context->number_of_rows - start_row > POSITIONAL_SEGMENT_SIZE ? start_row + POSITIONAL_SEGMENT_SIZE : context->number_of_rows;
+        int64_t written_rows = write_formatter_rows(formatter, start_row, end_row, false, segment);
+        // Every row has the same width, so the segment's place in the file is known before the ones before it are written
+        if (written_rows < 0 ||
+            !pwrite_fully(context->fd, segment, written_rows * formatter->row_length, context->rows_offset + (off_t)start_row * formatter->row_length))
+        {
+            atomic_store(&context->failed, 1);
+        }
+    }
+    free(segment);
+}
+
+bool write_full_table_file(const row_formatter *formatter, const char *header, const char *separator, int fd)
+{
+    size_t header_length = strlen(header);
+    size_t separator_length = strlen(separator);
+    int number_of_rows = 1 << formatter->number_of_variables;
+    off_t rows_offset = header_length + separator_length;
+    off_t file_length = rows_offset + (off_t)number_of_rows * formatter->row_length;
+
+    // Reserved up front so the threads only fill the file in, and running out of space fails before any row is generated
+    if (fallocate(fd, 0, 0, file_length) != 0 && ((errno != EOPNOTSUPP && errno != ENOSYS) || ftruncate(fd, file_length) != 0))
+    {
+        fprintf(stderr, "Failed to allocate the table file in %s at line %d\n", __FILE__, __LINE__);
+        return false;
+    }
+    if (!pwrite_fully(fd, header, header_length, 0) || !pwrite_fully(fd, separator, separator_length, header_length))
+    {
+        return false;
+    }
+
+    positional_write_context context;
+    context.formatter = formatter;
+    context.fd = fd;
+    context.rows_offset = rows_offset;
+    context.number_of_rows = number_of_rows;
+    atomic_init(&context.failed, 0);
+    parallel_for_range((number_of_rows - 1) / POSITIONAL_SEGMENT_SIZE + 1, 1, positional_write_task, &context);
+    return !atomic_load(&context.failed);
+}
 
-        // Join or detach the thread if necessary
+/**
+ * Context shared by the threads counting, then writing, the true rows of the segments of a table file
+ */
+typedef struct
+{
+    const row_formatter *formatter;
+    int fd;
+    off_t rows_offset;
+    int number_of_rows;
+    int64_t *true_rows_before; // The true rows of segment i at i + 1 after counting, the true rows before segment i at i once summed
+    atomic_int failed;
+} true_rows_write_context;
+
+static void count_segments_task(void *arg, int64_t first_segment, int64_t end_segment)
+{
+    true_rows_write_context *context = (true_rows_write_context *)arg;
+    const row_formatter *formatter = context->formatter;
+    uint64_t *variable_words = (uint64_t *)malloc((formatter->number_of_variables + 1) * sizeof(uint64_t));
+    uint64_t *slots = (uint64_t *)malloc((formatter->compiled->program_length + 1) * sizeof(uint64_t));
+    if (variable_words == NULL || slots == NULL)
+    {
+        fprintf(stderr, "Memory allocation for rows failed in file %s at line %d\n", __FILE__, __LINE__);
+        atomic_store(&context->failed, 1);
+        free(variable_words);
+        free(slots);
+        return;
+    }
 
-        // Joining only the thread for the last needed segment to ensure the entire table is printed
-        if (current_segment == number_of_segments - 1)
+    int64_t start_row = first_segment * TABLE_BODY_SEGMENT_SIZE;
+    int64_t end_row = end_segment * TABLE_BODY_SEGMENT_SIZE < context->number_of_rows ? end_segment * TABLE_BODY_SEGMENT_SIZE : context->number_of_rows;
+    for (int64_t word = start_row >> 6; word * 64 < end_row; word++)
+    {
+        evaluate_formatter_word(formatter, word, variable_words, slots);
+        uint64_t results = formatter->result_slot >= 0 ? slots[formatter->result_slot] : 0;
+        int64_t word_end = word * 64 + 64 < end_row ? word * 64 + 64 : end_row;
+        // A word can straddle two segments, the true rows of each counted apart
+        for (int64_t row = word * 64 > start_row ? word * 64 : start_row; row < word_end;)
         {
-            if (pthread_join(threads[current_thread_index], NULL) != 0)
+            int64_t segment = row / TABLE_BODY_SEGMENT_SIZE;
+            int64_t segment_end = (segment + 1) * TABLE_BODY_SEGMENT_SIZE < word_end ? (segment + 1) * TABLE_BODY_SEGMENT_SIZE : word_end;
+            int width = segment_end - row;
+            uint64_t bits = results >> (row - word * 64);
+            if (width < 64)
             {
-                fprintf(stderr, "Failed to join thread in file %s at line %d\n", __FILE__, __LINE__);
-                exit(EXIT_FAILURE);
+                bits &= (1ULL << width) - 1;
             }
+            context->true_rows_before[segment + 1] += __builtin_popcountll(bits);
+            row = segment_end;
         }
+    }
+    free(variable_words);
+    free(slots);
+}
 
-        // Detach the thread
-        else
+static void write_true_segments_task(void *arg, int64_t first_segment, int64_t end_segment)
+{
+    true_rows_write_context *context = (true_rows_write_context *)arg;
+    const row_formatter *formatter = context->formatter;
+    // Neighbouring segments are generated and written together, in writes of up to POSITIONAL_SEGMENT_SIZE rows
+    int segments_per_write = POSITIONAL_SEGMENT_SIZE / TABLE_BODY_SEGMENT_SIZE;
+    char *rows = (char *)malloc((size_t)segments_per_write * TABLE_BODY_SEGMENT_SIZE * formatter->row_length);
+    if (rows == NULL)
+    {
+        fprintf(stderr, "Memory allocation for segment failed in file %s at line %d\n", __FILE__, __LINE__);
+        atomic_store(&context->failed, 1);
+        return;
+    }
+    for (int64_t segment = first_segment; segment < end_segment && !atomic_load(&context->failed); segment += segments_per_write)
+    {
+        int64_t last_segment = end_segment - segment > segments_per_write ? segment + segments_per_write : end_segment;
+        int start_row = segment * TABLE_BODY_SEGMENT_SIZE;
+        int end_row = last_segment * TABLE_BODY_SEGMENT_SIZE < context->number_of_rows ? last_segment * TABLE_BODY_SEGMENT_SIZE : context->number_of_rows;
+        int64_t written_rows = write_formatter_rows(formatter, start_row, end_row, true, rows);
+        // The counts say where the rows go, and how many there must be
+        if (written_rows != context->true_rows_before[last_segment] - context->true_rows_before[segment] ||
+            !pwrite_fully(context->fd, rows, written_rows * formatter->row_length,
+                          context->rows_offset + (off_t)context->true_rows_before[segment] * formatter->row_length))
         {
-            if (pthread_detach(threads[current_thread_index]) != 0)
-            {
-                fprintf(stderr, "Failed to detach thread in file %s at line %d\n", __FILE__, __LINE__);
-                exit(EXIT_FAILURE);
-            }
+            atomic_store(&context->failed, 1);
         }
+    }
+    free(rows);
+}
 
-        // Increment the current_thread_index in a circular manner
-        current_segment += 1;
-        current_thread_index = (current_segment) % (threads_num);
+bool write_true_rows_file(const row_formatter *formatter, const char *header, const char *separator, int fd, int64_t *segment_true_rows)
+{
+    size_t header_length = strlen(header);
+    size_t separator_length = strlen(separator);
+    int number_of_rows = 1 << formatter->number_of_variables;
+    int number_of_segments = (number_of_rows - 1) / TABLE_BODY_SEGMENT_SIZE + 1;
+    true_rows_write_context context;
+    context.formatter = formatter;
+    context.fd = fd;
+    context.rows_offset = header_length + separator_length;
+    context.number_of_rows = number_of_rows;
+    context.true_rows_before = (int64_t *)calloc(number_of_segments + 1, sizeof(int64_t));
+    atomic_init(&context.failed, 0);
+    if (context.true_rows_before == NULL)
+    {
+        fprintf(stderr, "Memory allocation for true row counts failed in file %s at line %d\n", __FILE__, __LINE__);
+        return false;
     }
 
-    // Clean up: destroy semaphores
-    for (int i = 0; i < threads_num; i++)
+    // First pass: the true rows of every segment, counted a word of rows at a time without formatting them
+    parallel_for_range(number_of_segments, 1, count_segments_task, &context);
+    for (int i = 0; i < number_of_segments; i++)
     {
-        sem_destroy(&semaphores[i]);
+        if (segment_true_rows != NULL)
+        {
+            segment_true_rows[i] = context.true_rows_before[i + 1];
+        }
+        context.true_rows_before[i + 1] += context.true_rows_before[i];
     }
-    sem_destroy(&creation_semaphore);
+
+    // Second pass: every segment now knows its offset, so the threads write their rows without waiting for each other
+    off_t file_length = context.rows_offset + (off_t)context.true_rows_before[number_of_segments] * formatter->row_length;
+    bool written = !atomic_load(&context.failed);
+    if (written && fallocate(fd, 0, 0, file_length) != 0 && ((errno != EOPNOTSUPP && errno != ENOSYS) || ftruncate(fd, file_length) != 0))
+    {
+        fprintf(stderr, "Failed to allocate the table file in %s at line %d\n", __FILE__, __LINE__);
+        written = false;
+    }
+    written = written && pwrite_fully(fd, header, header_length, 0) && pwrite_fully(fd, separator, separator_length, header_length);
+    if (written)
+    {
+        parallel_for_range(number_of_segments, 1, write_true_segments_task, &context);
+        written = !atomic_load(&context.failed);
+    }
+    free(context.true_rows_before);
+    return written;
+}
+
+bool write_parsed_true_rows_file(const parsed_expression *parsed, int fd, int64_t *segment_true_rows)
+{
+    row_formatter *formatter = create_parsed_row_formatter(parsed);
+    if (formatter == NULL)
+    {
+        return false;
+    }
+    char *header = generate_header(parsed->expression);
+    char *separator = generate_separator(parsed->expression);
+    bool written = write_true_rows_file(formatter, header, separator, fd, segment_true_rows);
+    free(header);
+    free(separator);
+    free_row_formatter(formatter);
+    return written;
 }
 
 char *generate_infix_row(int row_number, int number_of_variables, const char *expression, int *map, int expr_length, int rpn_length)
@@ -450,65 +1147,20 @@ char *generate_infix_row(int row_number, int number_of_variables, const char *ex
 
 char *generate_infix_truth_table_segment(const char *expression, int start_row, int end_row)
 {
-
-    // Making sure not to overshoot the table
-    if (end_row > (1 << count_unique_variables(expression)))
-    {
-        end_row = (1 << count_unique_variables(expression));
-    }
-
-    int expression_length = strlen(expression);
-    int *rpnArr = infix_map(expression);
-    if (rpnArr == NULL)
-    {
-        fprintf(stderr, "Failed to generate infix map in file %s at line %d\n", __FILE__, __LINE__);
-        return (char *)NULL;
-    }
-    char *rpn_expression = shunting_yard(expression);
-    if (rpn_expression == NULL)
+    if (start_row < 0)
     {
-        fprintf(stderr, "Failed to convert infix expression in file %s at line %d\n", __FILE__, __LINE__);
-        free(rpnArr);
+        fprintf(stderr, "Failed to generate segment in file %s at line %d: invalid start row %d\n", __FILE__, __LINE__, start_row);
         return (char *)NULL;
     }
-    int rpn_length = strlen(rpn_expression);
-    int number_of_variables = count_unique_variables(expression);
-    int number_of_rows = end_row - start_row + 1;
-    int row_length = number_of_variables * 2 + strlen(expression) + 9;
-    int64_t segment_length = (int64_t)number_of_rows * row_length;
-
-    char *segment = (char *)calloc(segment_length + 1, sizeof(char));
 
-    if (segment == NULL)
+    parsed_expression *parsed = parse_expression(expression);
+    if (parsed == NULL)
     {
-        fprintf(stderr, "Memory allocation for segment failed in file %s at line %d\n", __FILE__, __LINE__);
-        free(rpnArr);
-        free(rpn_expression);
+        fprintf(stderr, "Failed to parse infix expression in file %s at line %d\n", __FILE__, __LINE__);
         return (char *)NULL;
     }
-    int added_rows = 0;
-    // Generate the segment data
-    for (int i = start_row; i < end_row; i++)
-    {
-        // Get the length of the row
-        char *row = generate_infix_row(i, number_of_variables, rpn_expression, rpnArr, expression_length, rpn_length);
-        if (row == NULL)
-        {
-            fprintf(stderr, "Failed to generate row in file %s at line %d\n", __FILE__, __LINE__);
-            free(rpnArr);
-            free(rpn_expression);
-            free(segment);
-            return (char *)NULL;
-        }
-        memcpy(segment + added_rows * row_length, row, row_length);
-        added_rows++;
-        free(row);
-    }
-
-    segment[segment_length] = '\0';
-    free(rpn_expression);
-    free(rpnArr);
-    // Ensure the segment is null-terminated if needed
+    char *segment = generate_parsed_segment(parsed, start_row, end_row, false);
+    free_parsed_expression(parsed);
     return segment;
 }
 
@@ -525,47 +1177,15 @@ char *generate_true_infix_truth_table_segment(const char *rpn_expression, int *i
         return (char *)NULL;
     }
 
-    // Making sure not to overshoot the table
-    if (end_row >= (1 << number_of_variables))
-    {
-        end_row = (1 << number_of_variables);
-    }
-
-    // Debug
-    // printf("start row: %ld end row: %ld\n", start_row, end_row);
-    int number_of_rows = end_row - start_row;
-    int row_length = number_of_variables * 2 + expression_length + 9;
-    int64_t segment_length = (int64_t)number_of_rows * row_length + 1;
-    int added_rows = 0;
-    // Allocating an upper bound for the true rows
-    // Using calloc as I might not use the entire allocated memory space
-    // So want to make sure its not full of garbage
-    char *segment = (char *)calloc(segment_length + 1, sizeof(char));
-    if (segment == NULL)
+    row_formatter *formatter = create_row_formatter(rpn_expression, inf_map, expression_length);
+    if (formatter == NULL || formatter->number_of_variables != number_of_variables || (int)strlen(rpn_expression) != rpn_length)
     {
-        fprintf(stderr, "Memory allocation failed\n");
+        fprintf(stderr, "Failed to generate true segment in file %s at line %d\n", __FILE__, __LINE__);
+        free_row_formatter(formatter);
         return (char *)NULL;
     }
-
-    for (int i = start_row; i < end_row; i++)
-    {
-        char *row = generate_infix_row(i, number_of_variables, rpn_expression, inf_map, expression_length, rpn_length);
-        if (row == NULL)
-        {
-            fprintf(stderr, "Failed to generate row in file %s at line %d\n", __FILE__, __LINE__);
-            free(segment);
-            return (char *)NULL;
-        }
-        if (row[row_length - 2] == '1')
-        {
-            memcpy(segment + (int64_t)added_rows * row_length, row, row_length);
-            added_rows++;
-        }
-        free(row);
-    }
-
-    segment[segment_length] = '\0';
-
+    char *segment = generate_segment_with_formatter(formatter, start_row, end_row, true);
+    free_row_formatter(formatter);
     return segment;
 }
 
@@ -573,12 +1193,17 @@ void *infix_rows_generator(void *arg)
 {
     infix_thread_data *data = (infix_thread_data *)arg;
     // Generate the segment data
-    char *segment = generate_true_infix_truth_table_segment(data->rpn_expression, data->map, data->expression_length, data->rpn_length, data->number_of_variables, data->start_row, data->end_row);
+    char *segment = generate_segment_with_formatter(data->formatter, data->start_row, data->end_row, true);
     if (segment == NULL)
     {
         fprintf(data->file, "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
         exit(EXIT_FAILURE);
     }
+    if (data->segment_true_rows != NULL)
+    {
+        // Recorded before handing the turn over, so every count is there once the last segment is written
+        data->segment_true_rows[data->segment_index] = strlen(segment) / data->formatter->row_length;
+    }
     if (data->start_row == 0 && data->end_row != data->start_row)
     {
         char *header = generate_header(data->expression);
@@ -597,17 +1222,21 @@ void *infix_rows_generator(void *arg)
     pthread_exit(NULL);
 }
 
-void generate_infix_table_body(const char *expression, FILE *file)
+static void write_infix_table_body(const parsed_expression *parsed, FILE *file, int64_t *segment_true_rows)
 {
-    int segment_size = 1000;
-    int *inf_map = infix_map(expression);
-    int number_of_variables = count_unique_variables(expression);
-    char *rpn_expr = shunting_yard(expression);
-    int rpn_length = strlen(rpn_expr);
-    int expression_length = strlen(expression);
-    int number_of_rows = 1 << number_of_variables;
+    int segment_size = TABLE_BODY_SEGMENT_SIZE;
+    const char *expression = parsed->expression;
+    int number_of_rows = 1 << parsed->number_of_variables;
     int number_of_segments = number_of_rows / segment_size + (number_of_rows % segment_size != 0 ? 1 : 0);
 
+    // Compiled once and shared by every segment thread
+    row_formatter *formatter = create_parsed_row_formatter(parsed);
+    if (formatter == NULL)
+    {
+        fprintf(file, "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+
     // Set the number of threads that will run concurrently
     int num_threads = 10;
     if (num_threads > number_of_segments)
@@ -668,14 +1297,11 @@ void generate_infix_table_body(const char *expression, FILE *file)
         thread_data[current_thread_index].semaphore = semaphores;
         thread_data[current_thread_index].num_threads = num_threads;
         thread_data[current_thread_index].thread_id = current_thread_index;
-        thread_data[current_thread_index].expression_length = expression_length;
-        thread_data[current_thread_index].rpn_length = rpn_length;
-        thread_data[current_thread_index].expression = expression;
-        thread_data[current_thread_index].rpn_expression = rpn_expr;
-        thread_data[current_thread_index].map = inf_map;
-        thread_data[current_thread_index].number_of_variables = number_of_variables;
         thread_data[current_thread_index].expression = expression;
+        thread_data[current_thread_index].formatter = formatter;
         thread_data[current_thread_index].creation_semaphore = &creation_semaphore;
+        thread_data[current_thread_index].segment_index = current_segment;
+        thread_data[current_thread_index].segment_true_rows = segment_true_rows;
 
         // Update start_row for the next segment
         start_row = thread_data[current_thread_index].end_row;
@@ -711,6 +1337,13 @@ void generate_infix_table_body(const char *expression, FILE *file)
         current_thread_index = (current_segment) % (num_threads);
     }
 
+    // The detached threads give their slot back last, so once every slot is back none of them
+    // still uses the semaphores or the thread data
+    for (int i = 0; i < num_threads; i++)
+    {
+        sem_wait(&creation_semaphore);
+    }
+
     // Clean up: destroy semaphores
     for (int i = 0; i < num_threads; i++)
     {
@@ -719,8 +1352,92 @@ void generate_infix_table_body(const char *expression, FILE *file)
     sem_destroy(&creation_semaphore);
 
     // Free allocated memory
-    free(inf_map);
-    free(rpn_expr);
+    free_row_formatter(formatter);
+}
+
+void generate_parsed_table_body(const parsed_expression *parsed, FILE *file)
+{
+    generate_parsed_table_body_with_counts(parsed, file, NULL);
+}
+
+void generate_parsed_table_body_with_counts(const parsed_expression *parsed, FILE *file, int64_t *segment_true_rows)
+{
+    if (parsed->is_infix)
+    {
+        write_infix_table_body(parsed, file, segment_true_rows);
+    }
+    else
+    {
+        write_postfix_table_body(parsed, file, segment_true_rows);
+    }
+}
+
+/**
+ * Parses the expression once for the table body, whichever way it is written.
+ * An invalid expression ends the program after writing the usual message to the file.
+ */
+static void parse_and_generate_table_body(const char *expression, FILE *file)
+{
+    parsed_expression *parsed = parse_expression(expression);
+    if (parsed == NULL)
+    {
+        fprintf(file, "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+    generate_parsed_table_body(parsed, file);
+    free_parsed_expression(parsed);
+}
+
+void generate_postfix_table_body(const char *expression, FILE *file)
+{
+    parse_and_generate_table_body(expression, file);
+}
+
+void generate_infix_table_body(const char *expression, FILE *file)
+{
+    parse_and_generate_table_body(expression, file);
+}
+
+char *generate_single_row_table(const char *expression, int row_number)
+{
+    parsed_expression *parsed = parse_expression(expression);
+    if (parsed == NULL)
+    {
+        fprintf(stderr, "Failed to parse expression in file %s at line %d\n", __FILE__, __LINE__);
+        return (char *)NULL;
+    }
+    char *row;
+    if (parsed->is_infix)
+    {
+        row = generate_infix_row(row_number, parsed->number_of_variables, parsed->rpn_expression, parsed->map, parsed->expression_length, parsed->rpn_length);
+    }
+    else
+    {
+        row = generate_postfix_row(row_number, parsed->number_of_variables, expression, parsed->expression_length);
+    }
+    free_parsed_expression(parsed);
+    if (row == NULL)
+    {
+        fprintf(stderr, "Failed to generate row in file %s at line %d\n", __FILE__, __LINE__);
+        return (char *)NULL;
+    }
+
+    char *header = generate_header(expression);
+    char *separator = generate_separator(expression);
+    int length = strlen(header) + strlen(separator) + strlen(row);
+    char *table = (char *)malloc(length + 1);
+    if (table == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed in file %s at line %d\n", __FILE__, __LINE__);
+    }
+    else
+    {
+        snprintf(table, length + 1, "%s%s%s", header, separator, row);
+    }
+    free(header);
+    free(separator);
+    free(row);
+    return table;
 }
 
 char *generate_header(const char *expression)
@@ -774,3 +1491,220 @@ char *generate_separator(const char *expression)
     snprintf(separator + strlen(separator), 2, "%c", '\n');
     return separator;
 }
+
+char *generate_compiled_header(const compiled_expression *compiled, const char *label)
+{
+    int header_length = compiled->number_of_variables * 2 + strlen(label) + 13;
+    char *header = (char *)malloc((header_length + 1) * sizeof(char));
+    if (header == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    int offset = 0;
+    for (int i = 0; i < compiled->number_of_variables; i++)
+    {
+        snprintf(header + offset, header_length - offset, "%c ", compiled->variables[i]);
+        offset += 2;
+    }
+    snprintf(header + offset, header_length - offset, ": %s : Result\n", label);
+    return header;
+}
+
+char *generate_compiled_separator(const compiled_expression *compiled, const char *label)
+{
+    // One '=' under every character of the header
+    int separator_length = compiled->number_of_variables * 2 + strlen(label) + 11;
+    char *separator = (char *)malloc((separator_length + 2) * sizeof(char));
+    if (separator == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(separator, '=', separator_length);
+    separator[separator_length] = '\n';
+    separator[separator_length + 1] = '\0';
+    return separator;
+}
+
+/**
+ * Collects the variables of several expressions in order of first appearance, the first expression first
+ */
+static int collect_multi_variables(parsed_expression **parsed, int number_of_expressions, char *variables)
+{
+    bool present[26] = {0};
+    int number_of_variables = 0;
+    for (int j = 0; j < number_of_expressions; j++)
+    {
+        for (int i = 0; i < parsed[j]->number_of_variables; i++)
+        {
+            char variable = parsed[j]->variables[i];
+            if (!present[variable - 'a'])
+            {
+                present[variable - 'a'] = true;
+                variables[number_of_variables++] = variable;
+            }
+        }
+    }
+    variables[number_of_variables] = '\0';
+    return number_of_variables;
+}
+
+/**
+ * Width of the expression columns of a multi-output table, " : " separating the expressions
+ */
+static int multi_expressions_width(parsed_expression **parsed, int number_of_expressions)
+{
+    int width = 3 * (number_of_expressions - 1);
+    for (int j = 0; j < number_of_expressions; j++)
+    {
+        width += parsed[j]->expression_length;
+    }
+    return width;
+}
+
+row_formatter *create_multi_row_formatter(parsed_expression **parsed, int number_of_expressions)
+{
+    if (number_of_expressions < 1)
+    {
+        return (row_formatter *)NULL;
+    }
+    char variables[27];
+    collect_multi_variables(parsed, number_of_expressions, variables);
+
+    int total_length = 3 * number_of_expressions;
+    for (int j = 0; j < number_of_expressions; j++)
+    {
+        total_length += parsed[j]->rpn_length;
+    }
+    compiled_expression *compiled = (compiled_expression *)calloc(1, sizeof(compiled_expression));
+    int *result_slots = (int *)malloc(number_of_expressions * sizeof(int));
+    if (compiled == NULL || result_slots == NULL ||
+        (compiled->program = (instruction *)malloc(total_length * sizeof(instruction))) == NULL)
+    {
+        fprintf(stderr, "Memory allocation for row formatter failed in file %s at line %d\n", __FILE__, __LINE__);
+        free_compiled_expression(compiled);
+        free(result_slots);
+        return (row_formatter *)NULL;
+    }
+    compiled->number_of_variables = strlen(variables);
+    memcpy(compiled->variables, variables, sizeof(variables));
+
+    // Programs run one after the other over the shared columns, each result staying on the stack
+    for (int j = 0; j < number_of_expressions; j++)
+    {
+        compiled_expression *part = compile_mapped_rpn(parsed[j]->rpn_expression, parsed[j]->map, variables);
+        if (part == NULL)
+        {
+            fprintf(stderr, "Failed to compile expression in file %s at line %d\n", __FILE__, __LINE__);
+            free_compiled_expression(compiled);
+            free(result_slots);
+            return (row_formatter *)NULL;
+        }
+        int base = compiled->program_length;
+        for (int i = 0; i < part->program_length; i++)
+        {
+            instruction current = part->program[i];
+            if (current.op == OP_COPY)
+            {
+                current.operand += base;
+            }
+            compiled->program[compiled->program_length++] = current;
+        }
+
+        // The native code only spills operator results, so a lone variable is read through a double negation
+        instruction last = compiled->program[compiled->program_length - 1];
+        if (last.op == OP_VARIABLE || last.op == OP_COPY)
+        {
+            for (int k = 0; k < 2; k++)
+            {
+                compiled->program[compiled->program_length] = last;
+                compiled->program[compiled->program_length].op = OP_NOT;
+                compiled->program[compiled->program_length++].operand = 0;
+            }
+        }
+        if (j + part->max_stack_depth > compiled->max_stack_depth)
+        {
+            compiled->max_stack_depth = j + part->max_stack_depth;
+        }
+        result_slots[j] = compiled->program_length - 1;
+        free_compiled_expression(part);
+    }
+
+    // The results are or'ed together last, so only_true keeps the rows where any expression is true
+    for (int j = 1; j < number_of_expressions; j++)
+    {
+        instruction *current = &compiled->program[compiled->program_length++];
+        current->op = OP_OR;
+        current->operand = 0;
+        current->rpn_position = -1;
+    }
+    compiled->scratch_words = compiled->max_stack_depth;
+
+    row_formatter *formatter = allocate_row_formatter(compiled, multi_expressions_width(parsed, number_of_expressions));
+    if (formatter == NULL)
+    {
+        free(result_slots);
+        return (row_formatter *)NULL;
+    }
+
+    // Each expression only shows its result, under its main operator
+    int column = formatter->number_of_variables * 2 + 2;
+    for (int j = 0; j < number_of_expressions; j++)
+    {
+        if (j > 0)
+        {
+            formatter->template_row[column - 2] = ':';
+        }
+        int rpn_position = compiled->program[result_slots[j]].rpn_position;
+        int position = parsed[j]->map == NULL ? rpn_position : parsed[j]->map[rpn_position];
+        formatter->value_columns[formatter->number_of_values] = column + position;
+        formatter->value_slots[formatter->number_of_values] = result_slots[j];
+        formatter->number_of_values++;
+        column += parsed[j]->expression_length + 3;
+    }
+    free(result_slots);
+    return formatter;
+}
+
+char *generate_multi_header(parsed_expression **parsed, int number_of_expressions)
+{
+    char variables[27];
+    int number_of_variables = collect_multi_variables(parsed, number_of_expressions, variables);
+    int header_length = number_of_variables * 2 + multi_expressions_width(parsed, number_of_expressions) + 10;
+    char *header = (char *)malloc((header_length + 1) * sizeof(char));
+    if (header == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    int offset = 0;
+    for (int i = 0; i < number_of_variables; i++)
+    {
+        offset += snprintf(header + offset, header_length + 1 - offset, "%c ", variables[i]);
+    }
+    for (int j = 0; j < number_of_expressions; j++)
+    {
+        offset += snprintf(header + offset, header_length + 1 - offset, ": %s ", parsed[j]->expression);
+    }
+    snprintf(header + offset, header_length + 1 - offset, ": Any\n");
+    return header;
+}
+
+char *generate_multi_separator(parsed_expression **parsed, int number_of_expressions)
+{
+    // One '=' under every character of the header
+    char variables[27];
+    int number_of_variables = collect_multi_variables(parsed, number_of_expressions, variables);
+    int separator_length = number_of_variables * 2 + multi_expressions_width(parsed, number_of_expressions) + 8;
+    char *separator = (char *)malloc((separator_length + 2) * sizeof(char));
+    if (separator == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(separator, '=', separator_length);
+    separator[separator_length] = '\n';
+    separator[separator_length + 1] = '\0';
+    return separator;
+}
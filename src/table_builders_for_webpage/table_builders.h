@@ -1,5 +1,46 @@
 #pragma once
 #include <semaphore.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../rpn_evaluator/word_evaluation.h"
+#include "../rpn_evaluator/jit.h"
+#include "../converters/expression_parser.h"
+
+// Number of rows of the segments the table bodies are generated in
+#define TABLE_BODY_SEGMENT_SIZE 1000
+// Number of rows of the segments written straight to their place in a table file, a multiple of 64
+#define POSITIONAL_SEGMENT_SIZE (1 << 16)
+
+/**
+ * Layout of the rows of a table, computed once per expression so rows can be written 64 at a time
+ * from the slots filled in by the word evaluator or its native code
+ */
+typedef struct
+{
+    compiled_expression *compiled;
+    native_expression *native; // NULL when the interpreter is used
+    int number_of_variables;   // Variables enumerated by the rows, fixed variables of a cofactor excluded
+    int row_length;      // Including the new line
+    char *template_row;  // Row with every character that doesn't depend on the row number
+    int number_of_values;
+    int *value_columns;  // Column of each intermediate result in the row
+    int *value_slots;    // Slot holding each intermediate result
+    int result_slot;     // Slot of the final result, -1 if the result column is blank
+    int *variable_columns; // Column of each enumerated variable, NULL when they are every column in order
+    uint64_t *truth_vector; // Results of the rows when the table is read from a truth vector rather than evaluated
+    int result_column;   // Column of the final result in the row
+} row_formatter;
+
+/**
+ * Variables fixed to a constant, so only the rows of the sub-table (cofactor) of the others are generated
+ */
+typedef struct
+{
+    int number_of_fixed;
+    char variables[27]; // Fixed variables, null terminated
+    bool values[26];    // Value of each fixed variable, in the order of variables
+} partial_assignment;
 
 /**
  * Function to generate a header for the table.
@@ -120,6 +161,289 @@ char *generate_true_infix_truth_table_segment(const char *rpn_expression, int *i
  */
 char *generate_true_postfix_truth_table_segment(const char *expression, int expr_length, int number_of_variables, int start_row, int end_row);
 
+/**
+ * Function to generate the header, separator and a single row of the table of an expression,
+ * used to show the row that answers a question about the expression.
+ * Caller is responsible for freeing the memory allocated for the string returned.
+ * @param expression The infix or postfix expression
+ * @param row_number The row of the table
+ * @return The header, separator and row, or NULL if the expression or row is invalid
+ */
+char *generate_single_row_table(const char *expression, int row_number);
+
+/**
+ * Function to compute the layout of the rows of a table and compile the expression for it,
+ * into native code when the JIT is available.
+ * Caller is responsible for freeing the result with free_row_formatter.
+ * @param rpn_expression The rpn expression, which is the expression itself for postfix tables
+ * @param map The infix map of an infix expression, or NULL for postfix tables
+ * @param expression_length The length of the expression shown in the header
+ * @return The row formatter, or NULL if the expression is invalid or memory can't be allocated.
+ * Allocation failures aren't printed, callers report the failure.
+ */
+row_formatter *create_row_formatter(const char *rpn_expression, const int *map, int expression_length);
+
+/**
+ * Function to compute the layout of the rows of the table of a parsed expression
+ * Caller is responsible for freeing the result with free_row_formatter.
+ * @param parsed The parsed expression
+ * @return The row formatter, or NULL if the expression can't be compiled or memory can't be allocated
+ */
+row_formatter *create_parsed_row_formatter(const parsed_expression *parsed);
+
+/**
+ * Function to free a row formatter
+ * @param formatter The row formatter being freed
+ */
+void free_row_formatter(row_formatter *formatter);
+
+/**
+ * Function to evaluate 64 rows of a table into slots, with the native code if there is any
+ * @param formatter The row formatter of the table
+ * @param word_index The index of the word, so rows [64 * word_index, 64 * word_index + 64)
+ * @param variable_words Scratch space for number_of_variables words
+ * @param slots Receives one word per instruction of the compiled expression
+ */
+void evaluate_formatter_word(const row_formatter *formatter, int64_t word_index, uint64_t *variable_words, uint64_t *slots);
+
+/**
+ * Function to write rows of a word once its slots are evaluated
+ * @param formatter The row formatter of the table
+ * @param slots The slots from evaluate_formatter_word
+ * @param word_index The index of the word
+ * @param first_bit The first row of the word to write
+ * @param end_bit The row of the word after the last one to write
+ * @param only_true Whether to skip rows where the expression is false
+ * @param output Where the rows are written, without a null terminator
+ * @return The number of rows written
+ */
+int format_word_rows(const row_formatter *formatter, const uint64_t *slots, int64_t word_index, int first_bit, int end_bit, bool only_true, char *output);
+
+/**
+ * Function to write the rows [start_row, end_row) of a table 64 rows at a time into a buffer
+ * @param formatter The row formatter of the table
+ * @param start_row The first row, at least 0
+ * @param end_row The row after the last row, at most the size of the table
+ * @param only_true Whether to only keep the rows where the expression is true
+ * @param output Where the rows are written, room for end_row - start_row rows and no null terminator
+ * @return The number of rows written, -1 if memory allocation fails
+ */
+int64_t write_formatter_rows(const row_formatter *formatter, int start_row, int end_row, bool only_true, char *output);
+
+/**
+ * Function to generate the rows [start_row, end_row) of a table 64 rows at a time
+ * @param formatter The row formatter of the table
+ * @param start_row The first row of the segment
+ * @param end_row The row after the last row of the segment, clamped to the size of the table
+ * @param only_true Whether to only keep the rows where the expression is true
+ * @return The generated segment
+ */
+char *generate_segment_with_formatter(const row_formatter *formatter, int start_row, int end_row, bool only_true);
+
+/**
+ * Function to generate the rows [start_row, end_row) of the table of a parsed expression,
+ * without converting or validating the expression again
+ * @param parsed The parsed expression
+ * @param start_row The first row of the segment
+ * @param end_row The row after the last row of the segment, clamped to the size of the table
+ * @param only_true Whether to only keep the rows where the expression is true
+ * @return The generated segment, or NULL on failure
+ */
+char *generate_parsed_segment(const parsed_expression *parsed, int start_row, int end_row, bool only_true);
+
+/**
+ * Function to generate the full table body (including header and separator) of a parsed expression,
+ * infix or postfix, followed by writing it to a file
+ * @param parsed The parsed expression
+ * @param file the file where the table body is written
+ */
+void generate_parsed_table_body(const parsed_expression *parsed, FILE *file);
+
+/**
+ * Function to write the true rows of a table like generate_parsed_table_body, recording how many true
+ * rows each segment of TABLE_BODY_SEGMENT_SIZE rows contributed, which tells where any true row is
+ * without reading the file
+ * @param parsed The parsed expression
+ * @param file the file where the table body is written
+ * @param segment_true_rows Receives the count of every segment, room for one per segment of the table
+ */
+void generate_parsed_table_body_with_counts(const parsed_expression *parsed, FILE *file, int64_t *segment_true_rows);
+
+/**
+ * Function to write the true rows of a table to a file with the segment threads of the table body,
+ * for any row formatter, including ones of expressions read from other formats
+ * @param formatter The row formatter of the table
+ * @param header The header written before the rows
+ * @param separator The separator written after the header
+ * @param file the file where the table body is written
+ */
+void generate_formatter_table_body(const row_formatter *formatter, const char *header, const char *separator, FILE *file);
+
+/**
+ * Function called with every segment of a streamed range, in row order
+ * @param segment The rows of the segment
+ * @param context The context given to stream_formatter_segments
+ */
+typedef void (*segment_consumer)(const char *segment, void *context);
+
+/**
+ * Function to generate the rows [start_row, end_row) of a table in segments generated by parallel threads
+ * and handed to a consumer in row order, through a ring of semaphores like the table bodies. A segment
+ * is consumed as soon as it and the ones before it are generated, so the first rows don't wait for the
+ * whole range, and at most one segment per thread is held in memory.
+ * @param formatter The row formatter of the table
+ * @param start_row The first row of the range
+ * @param end_row The row after the last row of the range, clamped to the size of the table
+ * @param only_true Whether to only keep the rows where the expression is true
+ * @param segment_size The number of rows of a segment
+ * @param consumer The function called with each segment, from one thread at a time
+ * @param context Passed to the consumer unchanged
+ */
+void stream_formatter_segments(const row_formatter *formatter, int start_row, int end_row, bool only_true, int segment_size, segment_consumer consumer, void *context);
+
+/**
+ * Function to write the header, separator and every row of a table to a file. The file is allocated
+ * at its full size first, then parallel threads write their segments of POSITIONAL_SEGMENT_SIZE rows
+ * straight to header_length + start_row * row_length, in no particular order and without waiting
+ * for each other, which every row having the same width allows.
+ * @param formatter The row formatter of the table
+ * @param header The header written before the rows
+ * @param separator The separator written after the header
+ * @param fd The descriptor of an empty file opened for writing
+ * @return true if the table was written, false otherwise
+ */
+bool write_full_table_file(const row_formatter *formatter, const char *header, const char *separator, int fd);
+
+/**
+ * Function to write the header, separator and true rows of a table to a file in two passes. Parallel
+ * threads first count the true rows of every segment of TABLE_BODY_SEGMENT_SIZE rows, whose prefix sums
+ * are the offsets of the segments in the file. The file is then allocated at its full size and the
+ * threads write the true rows of their segments straight to those offsets, without waiting for each other.
+ * @param formatter The row formatter of the table
+ * @param header The header written before the rows
+ * @param separator The separator written after the header
+ * @param fd The descriptor of an empty file opened for writing
+ * @param segment_true_rows Receives the true rows of every segment like generate_parsed_table_body_with_counts, may be NULL
+ * @return true if the table was written, false otherwise
+ */
+bool write_true_rows_file(const row_formatter *formatter, const char *header, const char *separator, int fd, int64_t *segment_true_rows);
+
+/**
+ * Function to write the true rows file of a parsed expression, infix or postfix, with write_true_rows_file
+ * @param parsed The parsed expression
+ * @param fd The descriptor of an empty file opened for writing
+ * @param segment_true_rows Receives the true rows of every segment, may be NULL
+ * @return true if the table was written, false if the expression can't be compiled or on failure
+ */
+bool write_parsed_true_rows_file(const parsed_expression *parsed, int fd, int64_t *segment_true_rows);
+
+/**
+ * Function to compute the layout of the rows of a table of an expression that was compiled directly,
+ * such as one read from DIMACS CNF or AIGER. Only the variables and the result are shown,
+ * under a label standing in for the expression.
+ * Caller is responsible for freeing the result with free_row_formatter.
+ * @param compiled The compiled expression, owned by the formatter from then on
+ * @param label The text shown in place of the expression
+ * @return The row formatter, or NULL if allocation fails
+ */
+row_formatter *create_compiled_row_formatter(compiled_expression *compiled, const char *label);
+
+/**
+ * Function to generate the header of the table of an expression that was compiled directly
+ * @param compiled The compiled expression
+ * @param label The text shown in place of the expression
+ * @return The header
+ */
+char *generate_compiled_header(const compiled_expression *compiled, const char *label);
+
+/**
+ * Function to generate the separator of the table of an expression that was compiled directly
+ * @param compiled The compiled expression
+ * @param label The text shown in place of the expression
+ * @return The separator
+ */
+char *generate_compiled_separator(const compiled_expression *compiled, const char *label);
+
+/**
+ * Function to compute the layout of the rows of a table whose results are read from a truth vector,
+ * such as the one of a quantified expression. The table is shown like one compiled directly, with
+ * generate_compiled_header and generate_compiled_separator of formatter->compiled.
+ * Caller is responsible for freeing the result with free_row_formatter.
+ * @param truth_vector The results of the rows, owned by the formatter from then on
+ * @param variables The variables in column order
+ * @param label The text shown in place of the expression
+ * @return The row formatter, or NULL if allocation fails
+ */
+row_formatter *create_truth_vector_row_formatter(uint64_t *truth_vector, const char *variables, const char *label);
+
+/**
+ * Function to compute the layout of a table with a result column per expression, enumerating the
+ * variables of all the expressions once and evaluating every expression on each word of rows.
+ * The last column is true when any expression is, so only_true keeps the rows where one of them is.
+ * Caller is responsible for freeing the result with free_row_formatter.
+ * @param parsed The parsed expressions, in column order
+ * @param number_of_expressions The number of expressions
+ * @return The row formatter, or NULL if an expression can't be compiled
+ */
+row_formatter *create_multi_row_formatter(parsed_expression **parsed, int number_of_expressions);
+
+/**
+ * Function to generate the header of a table with a result column per expression
+ * @param parsed The parsed expressions, in column order
+ * @param number_of_expressions The number of expressions
+ * @return The header
+ */
+char *generate_multi_header(parsed_expression **parsed, int number_of_expressions);
+
+/**
+ * Function to generate the separator of a table with a result column per expression
+ * @param parsed The parsed expressions, in column order
+ * @param number_of_expressions The number of expressions
+ * @return The separator
+ */
+char *generate_multi_separator(parsed_expression **parsed, int number_of_expressions);
+
+/**
+ * Function to read the variables fixed by a partial assignment such as "a=1,c=0"
+ * @param text The assignments, separated by commas
+ * @param assignment Receives the fixed variables
+ * @return true if text is a valid assignment, false otherwise
+ */
+bool parse_partial_assignment(const char *text, partial_assignment *assignment);
+
+/**
+ * Function to compute the layout of the rows of the cofactor of a parsed expression, the table
+ * of the variables that aren't fixed. Rows are numbered within the 2^(n-k) rows of the sub-table,
+ * the fixed variables keep their column and value in every row and are folded into constants.
+ * Caller is responsible for freeing the result with free_row_formatter.
+ * @param parsed The parsed expression
+ * @param fixed The fixed variables, which must all appear in the expression
+ * @return The row formatter, or NULL if a fixed variable isn't in the expression
+ */
+row_formatter *create_cofactor_row_formatter(const parsed_expression *parsed, const partial_assignment *fixed);
+
+/**
+ * Function to generate the rows [start_row, end_row) of the sub-table of a parsed expression with
+ * some of its variables fixed
+ * @param parsed The parsed expression
+ * @param fixed The fixed variables
+ * @param start_row The first row of the segment, within the sub-table
+ * @param end_row The row after the last row of the segment, clamped to the size of the sub-table
+ * @param only_true Whether to only keep the rows where the expression is true
+ * @return The generated segment, or NULL on failure
+ */
+char *generate_cofactor_segment(const parsed_expression *parsed, const partial_assignment *fixed, int start_row, int end_row, bool only_true);
+
+/**
+ * Function to write the header, separator and true rows of the sub-table of a parsed expression with
+ * some of its variables fixed to a file
+ * @param parsed The parsed expression
+ * @param fixed The fixed variables
+ * @param file the file where the table body is written
+ * @return true on success, false if a fixed variable isn't in the expression
+ */
+bool generate_cofactor_table_body(const parsed_expression *parsed, const partial_assignment *fixed, FILE *file);
+
 /**
  * Struct holding data for postfix row generator threads
  */
@@ -131,10 +455,13 @@ typedef struct
     int num_threads;
     int thread_id;
     int number_of_variables;
-    int expression_length;
-    const char *expression;
+    const char *header;    // Written before the first row
+    const char *separator;
+    const row_formatter *formatter;
     int start_row;
     int end_row;
+    int segment_index;
+    int64_t *segment_true_rows; // Receives the number of true rows of each segment, NULL when not recorded
 } postfix_thread_data;
 
 /**
@@ -147,12 +474,10 @@ typedef struct
     sem_t *creation_semaphore;
     int num_threads;
     int thread_id;
-    int number_of_variables;
-    int *map;
-    const char *expression;
-    const char *rpn_expression;
-    int rpn_length;
-    int expression_length;
+    const char *expression; // Its header is written before the first row
+    const row_formatter *formatter;
     int start_row;
     int end_row;
+    int segment_index;
+    int64_t *segment_true_rows; // Receives the number of true rows of each segment, NULL when not recorded
 } infix_thread_data;
\ No newline at end of file
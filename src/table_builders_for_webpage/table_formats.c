@@ -0,0 +1,292 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_lines.h"
+
+#include "table_formats.h"
+
+bool parse_table_format(const char *name, table_format *format)
+{
+    static const struct
+    {
+        const char *name;
+        table_format format;
+    } formats[] = {
+        {"text", TABLE_FORMAT_TEXT},
+        {"json", TABLE_FORMAT_JSON},
+        {"csv", TABLE_FORMAT_CSV},
+        {"markdown", TABLE_FORMAT_MARKDOWN}};
+
+    for (unsigned long i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+    {
+        if (strcmp(name, formats[i].name) == 0)
+        {
+            *format = formats[i].format;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Lays the rows of a text table out again for another format, so the row builders write the rows
+ * of that format directly. JSON rows are the text rows quoted, each one starting with the comma
+ * separating it from the element before it. CSV and Markdown rows only keep the variables and the
+ * result, left blank when the text table leaves it blank.
+ */
+static bool relayout_rows(row_formatter *formatter, table_format format)
+{
+    int number_of_variables = formatter->number_of_variables;
+    int row_length;
+    if (format == TABLE_FORMAT_JSON)
+    {
+        row_length = formatter->row_length + 3;
+    }
+    else if (format == TABLE_FORMAT_CSV)
+    {
+        row_length = 2 * number_of_variables + (formatter->result_slot >= 0 ? 2 : 1);
+    }
+    else
+    {
+        row_length = 4 * number_of_variables + 6;
+    }
+    char *template_row = (char *)malloc(row_length + 1);
+    if (formatter->variable_columns == NULL)
+    {
+        formatter->variable_columns = (int *)malloc((number_of_variables + 1) * sizeof(int));
+        for (int j = 0; formatter->variable_columns != NULL && j < number_of_variables; j++)
+        {
+            formatter->variable_columns[j] = 2 * j;
+        }
+    }
+    if (template_row == NULL || formatter->variable_columns == NULL)
+    {
+        fprintf(stderr, "Memory allocation for row formatter failed in file %s at line %d\n", __FILE__, __LINE__);
+        free(template_row);
+        return false;
+    }
+
+    if (format == TABLE_FORMAT_JSON)
+    {
+        template_row[0] = ',';
+        template_row[1] = '"';
+        memcpy(template_row + 2, formatter->template_row, formatter->row_length - 1);
+        template_row[row_length - 2] = '"';
+        for (int j = 0; j < number_of_variables; j++)
+        {
+            formatter->variable_columns[j] += 2;
+        }
+        for (int v = 0; v < formatter->number_of_values; v++)
+        {
+            formatter->value_columns[v] += 2;
+        }
+        formatter->result_column += 2;
+    }
+    else
+    {
+        // One cell per variable then the result, "0,1,1" or "| 0 | 1 | 1 |"
+        int first_cell = format == TABLE_FORMAT_CSV ? 0 : 2;
+        int cell_width = format == TABLE_FORMAT_CSV ? 2 : 4;
+        memset(template_row, format == TABLE_FORMAT_CSV ? ',' : ' ', row_length);
+        for (int j = 0; format == TABLE_FORMAT_MARKDOWN && j <= number_of_variables + 1; j++)
+        {
+            template_row[j * cell_width] = '|';
+        }
+        for (int j = 0; j < number_of_variables; j++)
+        {
+            formatter->variable_columns[j] = first_cell + j * cell_width;
+        }
+        formatter->number_of_values = 0;
+        formatter->result_column = first_cell + number_of_variables * cell_width;
+    }
+    template_row[row_length - 1] = '\n';
+    template_row[row_length] = '\0';
+    free(formatter->template_row);
+    formatter->template_row = template_row;
+    formatter->row_length = row_length;
+    return true;
+}
+
+/**
+ * Writes the expression as a CSV field, quoted with its quotes doubled
+ */
+static void write_csv_field(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (; *text != '\0'; text++)
+    {
+        if (*text == '"')
+        {
+            fputc('"', file);
+        }
+        fputc(*text, file);
+    }
+    fputc('"', file);
+}
+
+/**
+ * Writes the expression as a Markdown table cell, its pipes escaped so they don't split the cell
+ */
+static void write_markdown_cell(FILE *file, const char *text)
+{
+    for (; *text != '\0'; text++)
+    {
+        if (*text == '|' || *text == '\\')
+        {
+            fputc('\\', file);
+        }
+        fputc(*text, file);
+    }
+}
+
+/**
+ * Renders the header and separator of a table in its format
+ */
+static bool render_header(formatted_table *table, const parsed_expression *parsed)
+{
+    if (table->format == TABLE_FORMAT_TEXT)
+    {
+        table->header = generate_header(parsed->expression);
+        table->separator = generate_separator(parsed->expression);
+        return true;
+    }
+    size_t header_length;
+    size_t separator_length;
+    FILE *header = open_memstream(&table->header, &header_length);
+    FILE *separator = header == NULL ? NULL : open_memstream(&table->separator, &separator_length);
+    if (separator == NULL)
+    {
+        fprintf(stderr, "Failed to open memory stream in %s at line %d\n", __FILE__, __LINE__);
+        if (header != NULL)
+        {
+            fclose(header);
+        }
+        return false;
+    }
+
+    if (table->format == TABLE_FORMAT_JSON)
+    {
+        char *text_header = generate_header(parsed->expression);
+        char *text_separator = generate_separator(parsed->expression);
+        fputc('[', header);
+        write_json_string(header, text_header, strlen(text_header) - 1);
+        fputc('\n', header);
+        fputc(',', separator);
+        write_json_string(separator, text_separator, strlen(text_separator) - 1);
+        fputc('\n', separator);
+        free(text_header);
+        free(text_separator);
+    }
+    else if (table->format == TABLE_FORMAT_CSV)
+    {
+        for (int j = 0; j < parsed->number_of_variables; j++)
+        {
+            fprintf(header, "%c,", parsed->variables[j]);
+        }
+        write_csv_field(header, parsed->expression);
+        fputc('\n', header);
+    }
+    else
+    {
+        fputs("|", header);
+        fputs("|", separator);
+        for (int j = 0; j < parsed->number_of_variables; j++)
+        {
+            fprintf(header, " %c |", parsed->variables[j]);
+            fputs(" --- |", separator);
+        }
+        fputc(' ', header);
+        write_markdown_cell(header, parsed->expression);
+        fputs(" |\n", header);
+        fputs(" --- |\n", separator);
+    }
+    fclose(header);
+    fclose(separator);
+    return true;
+}
+
+formatted_table *create_formatted_table(const parsed_expression *parsed, table_format format)
+{
+    formatted_table *table = (formatted_table *)calloc(1, sizeof(formatted_table));
+    if (table == NULL)
+    {
+        fprintf(stderr, "Memory allocation for formatted table failed in file %s at line %d\n", __FILE__, __LINE__);
+        return (formatted_table *)NULL;
+    }
+    table->format = format;
+    table->formatter = create_parsed_row_formatter(parsed);
+    table->footer = strdup(format == TABLE_FORMAT_JSON ? "]\n" : "");
+    if (table->formatter == NULL || table->footer == NULL ||
+        (format != TABLE_FORMAT_TEXT && !relayout_rows(table->formatter, format)) ||
+        !render_header(table, parsed))
+    {
+        free_formatted_table(table);
+        return (formatted_table *)NULL;
+    }
+    return table;
+}
+
+void free_formatted_table(formatted_table *table)
+{
+    if (table == NULL)
+    {
+        return;
+    }
+    free_row_formatter(table->formatter);
+    free(table->header);
+    free(table->separator);
+    free(table->footer);
+    free(table);
+}
+
+char *generate_formatted_segment(const formatted_table *table, int start_row, int end_row, bool only_true)
+{
+    const row_formatter *formatter = table->formatter;
+    bool with_header = start_row == 0 && start_row != end_row;
+    // Making sure not to overshoot the table
+    if (end_row > (1 << formatter->number_of_variables))
+    {
+        end_row = (1 << formatter->number_of_variables);
+    }
+    if (start_row < 0 || end_row < start_row)
+    {
+        end_row = start_row = 0;
+    }
+
+    // Without the header, the comma starting the first JSON row is replaced by the bracket opening the array
+    bool opens_array = table->format == TABLE_FORMAT_JSON && !with_header;
+    size_t header_length = with_header ? strlen(table->header) : 0;
+    size_t separator_length = with_header ? strlen(table->separator) : 0;
+    size_t footer_length = strlen(table->footer);
+    size_t rows_offset = header_length + separator_length;
+    char *segment = (char *)malloc(rows_offset + (int64_t)(end_row - start_row) * formatter->row_length + footer_length + 2);
+    if (segment == NULL)
+    {
+        fprintf(stderr, "Memory allocation for segment failed in file %s at line %d\n", __FILE__, __LINE__);
+        return (char *)NULL;
+    }
+    memcpy(segment, table->header, header_length);
+    memcpy(segment + header_length, table->separator, separator_length);
+    int64_t written_rows = write_formatter_rows(formatter, start_row, end_row, only_true, segment + rows_offset);
+    if (written_rows < 0)
+    {
+        free(segment);
+        return (char *)NULL;
+    }
+    size_t length = rows_offset + written_rows * formatter->row_length;
+    if (opens_array)
+    {
+        segment[0] = '[';
+        length = length > 0 ? length : 1;
+    }
+    memcpy(segment + length, table->footer, footer_length + 1);
+    return segment;
+}
+
+void generate_formatted_table_body(const formatted_table *table, FILE *file)
+{
+    generate_formatter_table_body(table->formatter, table->header, table->separator, file);
+    fputs(table->footer, file);
+}
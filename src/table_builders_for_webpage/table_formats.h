@@ -0,0 +1,75 @@
+#pragma once
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "../converters/expression_parser.h"
+#include "table_builders.h"
+
+/**
+ * Output formats of a table. TEXT is the aligned table of the rest of the binary, JSON the array of
+ * its lines that server.py sends, CSV and MARKDOWN have one column per variable and one for the result.
+ */
+typedef enum
+{
+    TABLE_FORMAT_TEXT,
+    TABLE_FORMAT_JSON,
+    TABLE_FORMAT_CSV,
+    TABLE_FORMAT_MARKDOWN
+} table_format;
+
+/**
+ * The table of an expression in one output format, the rows laid out by its row formatter and the
+ * constant text around them (quoting, header, separator) rendered once per expression
+ */
+typedef struct
+{
+    table_format format;
+    row_formatter *formatter;
+    char *header;    // Written before the first row of the table
+    char *separator; // Written after the header
+    char *footer;    // Written after the last row of a segment or table
+} formatted_table;
+
+/**
+ * Function to get the output format of its name
+ * @param name text, json, csv or markdown
+ * @param format Receives the format
+ * @return true if the name is a format, false otherwise
+ */
+bool parse_table_format(const char *name, table_format *format);
+
+/**
+ * Function to lay out the table of a parsed expression in an output format.
+ * Caller is responsible for freeing the result with free_formatted_table.
+ * @param parsed The parsed expression
+ * @param format The output format
+ * @return The formatted table, or NULL if the expression can't be compiled
+ */
+formatted_table *create_formatted_table(const parsed_expression *parsed, table_format format);
+
+/**
+ * Function to free a formatted table
+ * @param table The formatted table, may be NULL
+ */
+void free_formatted_table(formatted_table *table);
+
+/**
+ * Function to generate the rows [start_row, end_row) of a table as a whole document of its format,
+ * starting with the header and separator when start_row is 0, like the segments of the text table.
+ * A JSON segment is always a whole array.
+ * Caller is responsible for freeing the memory allocated for the string returned.
+ * @param table The formatted table
+ * @param start_row The first row of the segment
+ * @param end_row The row after the last row of the segment, clamped to the size of the table
+ * @param only_true Whether to only keep the rows where the expression is true
+ * @return The segment, or NULL on failure
+ */
+char *generate_formatted_segment(const formatted_table *table, int start_row, int end_row, bool only_true);
+
+/**
+ * Function to write the header, separator, true rows and footer of a table to a file with the
+ * segment threads of the table body
+ * @param table The formatted table
+ * @param file the file where the table body is written
+ */
+void generate_formatted_table_body(const formatted_table *table, FILE *file);
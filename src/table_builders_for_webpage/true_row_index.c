@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "true_row_index.h"
+
+bool write_true_row_index(const char *file_name, const int64_t *segment_true_rows, int number_of_segments, int segment_size)
+{
+    FILE *file = fopen(file_name, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s in %s at line %d\n", file_name, __FILE__, __LINE__);
+        return false;
+    }
+    int64_t values[2] = {segment_size, number_of_segments};
+    bool written = fwrite(values, sizeof(int64_t), 2, file) == 2;
+    int64_t true_rows_before = 0;
+    for (int i = 0; i <= number_of_segments && written; i++)
+    {
+        written = fwrite(&true_rows_before, sizeof(int64_t), 1, file) == 1;
+        true_rows_before += i < number_of_segments ? segment_true_rows[i] : 0;
+    }
+    return fclose(file) == 0 && written;
+}
+
+true_row_index *open_true_row_index(const char *file_name)
+{
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Failed to open %s in %s at line %d\n", file_name, __FILE__, __LINE__);
+        return (true_row_index *)NULL;
+    }
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size >= 3 * (off_t)sizeof(int64_t))
+    {
+        mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        fprintf(stderr, "Failed to map %s in %s at line %d\n", file_name, __FILE__, __LINE__);
+        return (true_row_index *)NULL;
+    }
+
+    const int64_t *values = (const int64_t *)mapping;
+    true_row_index *index = (true_row_index *)malloc(sizeof(true_row_index));
+    if (index == NULL || values[0] <= 0 || values[1] <= 0 || values[1] > INT32_MAX ||
+        status.st_size != (off_t)((values[1] + 3) * sizeof(int64_t)))
+    {
+        fprintf(stderr, "Invalid true row index %s in %s at line %d\n", file_name, __FILE__, __LINE__);
+        munmap(mapping, status.st_size);
+        free(index);
+        return (true_row_index *)NULL;
+    }
+    index->segment_size = values[0];
+    index->number_of_segments = values[1];
+    index->true_rows_before = values + 2;
+    index->mapping = mapping;
+    index->mapping_length = status.st_size;
+    return index;
+}
+
+void close_true_row_index(true_row_index *index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+    munmap(index->mapping, index->mapping_length);
+    free(index);
+}
+
+/**
+ * Finds the segment holding a true row, the last one with fewer true rows before it
+ */
+static int segment_of_true_row(const true_row_index *index, int64_t true_row)
+{
+    int low = 0;
+    int high = index->number_of_segments - 1;
+    while (low < high)
+    {
+        int middle = low + (high - low + 1) / 2;
+        if (index->true_rows_before[middle] <= true_row)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+char *generate_indexed_true_rows(const row_formatter *formatter, const true_row_index *index, int64_t first_true_row, int count)
+{
+    int number_of_rows = 1 << formatter->number_of_variables;
+    if ((number_of_rows - 1) / index->segment_size + 1 != index->number_of_segments)
+    {
+        fprintf(stderr, "True row index doesn't match the table in %s at line %d\n", __FILE__, __LINE__);
+        return (char *)NULL;
+    }
+    int64_t total = index->true_rows_before[index->number_of_segments];
+    if (first_true_row < 0 || first_true_row >= total || count <= 0)
+    {
+        return strdup("");
+    }
+    if (count > total - first_true_row)
+    {
+        count = total - first_true_row;
+    }
+
+    // Only the segments from the one holding the first row to the one holding the last are generated
+    int first_segment = segment_of_true_row(index, first_true_row);
+    int last_segment = segment_of_true_row(index, first_true_row + count - 1);
+    int end_row = (int64_t)(last_segment + 1) * index->segment_size < number_of_rows ? (last_segment + 1) * index->segment_size : number_of_rows;
+    char *rows = generate_segment_with_formatter(formatter, first_segment * index->segment_size, end_row, true);
+    if (rows == NULL)
+    {
+        return (char *)NULL;
+    }
+    int64_t skipped = first_true_row - index->true_rows_before[first_segment];
+    if ((int64_t)strlen(rows) / formatter->row_length < skipped + count)
+    {
+        fprintf(stderr, "True row index doesn't match the table in %s at line %d\n", __FILE__, __LINE__);
+        free(rows);
+        return (char *)NULL;
+    }
+    memmove(rows, rows + skipped * formatter->row_length, (size_t)count * formatter->row_length);
+    rows[(size_t)count * formatter->row_length] = '\0';
+    return rows;
+}
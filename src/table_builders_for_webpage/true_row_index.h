@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "table_builders.h"
+
+/**
+ * Where the true rows of a table are, as the number of true rows before each segment of its rows,
+ * so the true rows [k, k + count) are found in the segments holding them without counting the others.
+ * Saved as native int64 values: the segment size, the number of segments, then the prefix counts.
+ */
+typedef struct
+{
+    int segment_size;
+    int number_of_segments;
+    const int64_t *true_rows_before; // number_of_segments + 1 counts, the last one being every true row
+    void *mapping;                   // The mapped index file
+    size_t mapping_length;
+} true_row_index;
+
+/**
+ * Function to save the index of the true rows of a table from the true rows of each of its segments
+ * @param file_name The file the index is written to
+ * @param segment_true_rows The number of true rows of each segment
+ * @param number_of_segments The number of segments
+ * @param segment_size The number of rows of a segment
+ * @return true if the index was written, false otherwise
+ */
+bool write_true_row_index(const char *file_name, const int64_t *segment_true_rows, int number_of_segments, int segment_size);
+
+/**
+ * Function to map an index saved by write_true_row_index.
+ * Caller is responsible for freeing the result with close_true_row_index.
+ * @param file_name The index file
+ * @return The index, or NULL if the file isn't a valid index
+ */
+true_row_index *open_true_row_index(const char *file_name);
+
+/**
+ * Function to unmap and free an index
+ * @param index The index, may be NULL
+ */
+void close_true_row_index(true_row_index *index);
+
+/**
+ * Function to generate the true rows [first_true_row, first_true_row + count) of a table, only
+ * generating the segments that hold them
+ * Caller is responsible for freeing the memory allocated for the string returned.
+ * @param formatter The row formatter of the table
+ * @param index The index of the true rows of the same table
+ * @param first_true_row The number of true rows before the first one generated
+ * @param count The number of true rows generated at most
+ * @return The rows, or NULL if the index doesn't match the table or on failure
+ */
+char *generate_indexed_true_rows(const row_formatter *formatter, const true_row_index *index, int64_t first_true_row, int count);
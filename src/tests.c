@@ -2,6 +2,11 @@
 #include <CUnit/Basic.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 #include "converters/binary_converter.h"
 #include "converters/shunting_yard.h"
@@ -10,6 +15,22 @@
 #include "rpn_evaluator/evaluation.h"
 #include "table_builders_for_webpage/table_builders.h"
 #include "utils/find_nr_of_vars.h"
+#include "rpn_evaluator/word_evaluation.h"
+#include "rpn_evaluator/jit.h"
+#include "analysis/equivalence.h"
+#include "analysis/satisfiability.h"
+#include "analysis/transforms.h"
+#include "analysis/sampling.h"
+#include "library/truthtable.h"
+#include "converters/c_emitter.h"
+#include "converters/expression_parser.h"
+#include "converters/input_formats.h"
+#include "table_builders_for_webpage/batch.h"
+#include "table_builders_for_webpage/expression_cache.h"
+#include "table_builders_for_webpage/http_server.h"
+#include "table_builders_for_webpage/json_lines.h"
+#include "table_builders_for_webpage/table_formats.h"
+#include "table_builders_for_webpage/true_row_index.h"
 
 // Tests for int_to_binary_string function
 void test_int_to_binary_string_invalid_input(void)
@@ -124,6 +145,17 @@ void test_shunting_yard_invalid_input(void)
     res = shunting_yard("A");
     CU_ASSERT_PTR_NULL(res);
 
+    // Upper case letters aren't variables, the same as for parse_expression
+    res = shunting_yard("A&b");
+    CU_ASSERT_PTR_NULL(res);
+    CU_ASSERT_FALSE(is_valid_infix("A&b"));
+    CU_ASSERT_PTR_NULL(infix_map("A&b"));
+
+    // Valid postfix isn't valid infix
+    res = shunting_yard("ab&");
+    CU_ASSERT_PTR_NULL(res);
+    CU_ASSERT_FALSE(is_valid_infix("ab&"));
+
     res = shunting_yard("|a");
     CU_ASSERT_PTR_NULL(res);
 
@@ -168,6 +200,47 @@ void test_infix_map(void)
     }
 }
 
+// Tests for parse_expression function
+void test_parse_expression(void)
+{
+    parsed_expression *parsed = parse_expression("a|-b&c");
+    CU_ASSERT_PTR_NOT_NULL(parsed);
+    CU_ASSERT_TRUE(parsed->is_infix);
+    CU_ASSERT_STRING_EQUAL(parsed->rpn_expression, "ab-c&|");
+    CU_ASSERT_EQUAL(parsed->rpn_length, 6);
+    CU_ASSERT_STRING_EQUAL(parsed->variables, "abc");
+    CU_ASSERT_EQUAL(parsed->row_length, 21);
+    int *expected_map = infix_map("a|-b&c");
+    for (int i = 0; i < parsed->expression_length; i++)
+    {
+        CU_ASSERT_EQUAL(parsed->map[i], expected_map[i]);
+    }
+    free(expected_map);
+    free_parsed_expression(parsed);
+
+    parsed = parse_expression("(a & b) | (c > a)");
+    CU_ASSERT_PTR_NOT_NULL(parsed);
+    CU_ASSERT_TRUE(parsed->is_infix);
+    char *expected_rpn = shunting_yard("(a & b) | (c > a)");
+    CU_ASSERT_STRING_EQUAL(parsed->rpn_expression, expected_rpn);
+    free(expected_rpn);
+    free_parsed_expression(parsed);
+
+    parsed = parse_expression("ba&c|");
+    CU_ASSERT_PTR_NOT_NULL(parsed);
+    CU_ASSERT_FALSE(parsed->is_infix);
+    CU_ASSERT_PTR_NULL(parsed->map);
+    CU_ASSERT_STRING_EQUAL(parsed->rpn_expression, "ba&c|");
+    CU_ASSERT_STRING_EQUAL(parsed->variables, "bac");
+    free_parsed_expression(parsed);
+
+    CU_ASSERT_PTR_NULL(parse_expression(""));
+    CU_ASSERT_PTR_NULL(parse_expression("a&"));
+    CU_ASSERT_PTR_NULL(parse_expression("(a&b"));
+    CU_ASSERT_PTR_NULL(parse_expression("A&b"));
+    CU_ASSERT_PTR_NULL(parse_expression("ab&&"));
+}
+
 // Test function for IntStack
 void test_int_stack_operations(void)
 {
@@ -194,10 +267,10 @@ void test_int_stack_operations(void)
     CU_ASSERT_TRUE(stack.top == -1); // Stack should be empty
 
     // Check underflow
-    CU_ASSERT_PTR_NULL(int_stack_pop(&stack)); // Should return NULL on underflow
+    CU_ASSERT_EQUAL(int_stack_pop(&stack), INT_STACK_EMPTY); // Should return the empty sentinel on underflow
 
     // Check peek on empty stack
-    CU_ASSERT_PTR_NULL(int_stack_peek(&stack)); // Should return NULL when empty
+    CU_ASSERT_EQUAL(int_stack_peek(&stack), INT_STACK_EMPTY); // Should return the empty sentinel when empty
 }
 
 void test_stack_operations(void)
@@ -227,10 +300,73 @@ void test_stack_operations(void)
     CU_ASSERT_TRUE(is_empty(&stack)); // Stack should be empty
 
     // Check underflow
-    CU_ASSERT_PTR_NULL(pop(&stack)); // Should return NULL on underflow
+    CU_ASSERT_EQUAL(pop(&stack), STACK_EMPTY); // Should return the empty sentinel on underflow
 
     // Check peek on empty stack
     CU_ASSERT_TRUE(is_empty(&stack));
+
+    // Grows past any fixed size
+    bool pushed = true;
+    for (int i = 0; i < 5000; i++)
+    {
+        pushed = pushed && push(&stack, 'a' + i % 26);
+    }
+    CU_ASSERT_TRUE(pushed);
+    CU_ASSERT_EQUAL(peek(&stack), 'a' + 4999 % 26);
+    free_stack(&stack);
+
+    // Storage given by the caller is moved to the heap once it is full, keeping its values
+    char buffer[4];
+    init_stack_with_buffer(&stack, buffer, 4);
+    for (char i = 'a'; i <= 'd'; i++)
+    {
+        push(&stack, i);
+    }
+    CU_ASSERT_PTR_EQUAL(stack.data, buffer);
+    CU_ASSERT_TRUE(push(&stack, 'e'));
+    CU_ASSERT_PTR_NOT_EQUAL(stack.data, buffer);
+    for (char i = 'e'; i >= 'a'; i--)
+    {
+        CU_ASSERT_EQUAL(pop(&stack), i);
+    }
+    CU_ASSERT_TRUE(is_empty(&stack));
+    free_stack(&stack);
+}
+
+void test_large_expressions(void)
+{
+    // 3000 nested parentheses, deeper than the old fixed size stacks
+    int depth = 3000;
+    char *nested = (char *)malloc(2 * depth + 4);
+    memset(nested, '(', depth);
+    memcpy(nested + depth, "a&b", 3);
+    memset(nested + depth + 3, ')', depth);
+    nested[2 * depth + 3] = '\0';
+    char *rpn = shunting_yard(nested);
+    CU_ASSERT_STRING_EQUAL(rpn, "ab&");
+    free(rpn);
+    int *map = infix_map(nested);
+    CU_ASSERT_EQUAL(map[2], depth + 1);
+    free(map);
+    free(nested);
+
+    // 100001 tokens of postfix, with a stack 50001 constants deep
+    int constants = 50001;
+    char *postfix = (char *)malloc(2 * constants);
+    memset(postfix, '1', constants);
+    memset(postfix + constants, '&', constants - 1);
+    postfix[2 * constants - 1] = '\0';
+    char *evaluated = evaluate_expr(postfix);
+    CU_ASSERT_PTR_NOT_NULL(evaluated);
+    CU_ASSERT_EQUAL(evaluated[2 * constants - 2], '1');
+    free(evaluated);
+    compiled_expression *compiled = compile_rpn(postfix, NULL);
+    CU_ASSERT_EQUAL(compiled->max_stack_depth, constants);
+    free_compiled_expression(compiled);
+    char *segment = generate_postfix_truth_table_segment(postfix, 0, 1);
+    CU_ASSERT_EQUAL(segment[strlen(segment) - 2], '1');
+    free(segment);
+    free(postfix);
 }
 
 void test_evaluate_expr(void)
@@ -281,9 +417,31 @@ void test_evaluate_expr(void)
     result = evaluate_expr("1 |");
     CU_ASSERT_PTR_NULL(result); // Should return NULL for bad expression
 
+    result = evaluate_expr("1 0 M");
+    CU_ASSERT_PTR_NULL(result); // Should return NULL for a MUX missing an operand
+
+    result = evaluate_expr("1 V");
+    CU_ASSERT_PTR_NULL(result); // Should return NULL for a majority missing operands
+
     // Test empty expression
     result = evaluate_expr("");
     CU_ASSERT_PTR_NULL(result); // Should return NULL for empty expression
+
+    // Deeper than the stack evaluate_expr keeps on its frame: 1 1 1 ... 1 followed by as many ANDs
+    char deep[2 * 300 + 1];
+    for (int i = 0; i < 300; i++)
+    {
+        deep[i] = '1';
+        deep[300 + i] = i == 0 ? '-' : '&';
+    }
+    deep[600] = '\0';
+    result = evaluate_expr(deep);
+    CU_ASSERT_PTR_NOT_NULL(result);
+    if (result != NULL)
+    {
+        CU_ASSERT_EQUAL(result[599], '0'); // NOT of the top 1, then ANDed with every other 1
+        free(result);
+    }
 }
 
 void test_generate_postfix_row(void)
@@ -454,6 +612,1229 @@ void test_count_unique_variables(void) {
     CU_ASSERT_EQUAL(count_unique_variables("aAbBcC"), 3);
 }
 
+void test_evaluate_word(void)
+{
+    uint64_t stack[8];
+    compiled_expression *compiled;
+
+    // Rows 0-3 of a b: a = 0011, b = 0101
+    compiled = compile_rpn("ab&", NULL);
+    CU_ASSERT_PTR_NOT_NULL(compiled);
+    CU_ASSERT_EQUAL(compiled->number_of_variables, 2);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & valid_rows_mask(2), 0x8);
+    free_compiled_expression(compiled);
+
+    compiled = compile_rpn("ab|", NULL);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & valid_rows_mask(2), 0xE);
+    free_compiled_expression(compiled);
+
+    // Same rows as the table generated by evaluate_expr
+    compiled = compile_rpn("ab>", NULL);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & valid_rows_mask(2), 0xD);
+    free_compiled_expression(compiled);
+
+    // Shared column order puts b first
+    compiled = compile_expression("a&-b", "ba");
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & valid_rows_mask(2), 0x2);
+    free_compiled_expression(compiled);
+
+    // Variables above the sixth column come from the word index
+    compiled = compile_rpn("a", "abcdefg");
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack), 0);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 1, stack), ~0ULL);
+    free_compiled_expression(compiled);
+
+    CU_ASSERT_PTR_NULL(compile_rpn("ab", NULL));
+    CU_ASSERT_PTR_NULL(compile_rpn("a&", NULL));
+    CU_ASSERT_PTR_NULL(compile_rpn("ab&", "a"));
+}
+
+void test_check_equivalence(void)
+{
+    equivalence_result *result;
+    char *counterexample;
+
+    result = check_equivalence("-(a&b)", "-a|-b");
+    CU_ASSERT_PTR_NOT_NULL(result);
+    CU_ASSERT_TRUE(result->equivalent);
+    CU_ASSERT_EQUAL(result->first_difference, -1);
+    CU_ASSERT_PTR_NULL(generate_counterexample("-(a&b)", "-a|-b", result));
+    free(result);
+
+    // Postfix and infix forms of the same expression
+    result = check_equivalence("ab|c&", "(a|b)&c");
+    CU_ASSERT_TRUE(result->equivalent);
+    free(result);
+
+    // Differ only once the unified variable c is 1
+    result = check_equivalence("a|b", "a|b|(c&a&-a)|(c&-a&-b)");
+    CU_ASSERT_FALSE(result->equivalent);
+    CU_ASSERT_STRING_EQUAL(result->variables, "abc");
+    CU_ASSERT_EQUAL(result->first_difference, 1);
+    counterexample = generate_counterexample("a|b", "a|b|(c&a&-a)|(c&-a&-b)", result);
+    CU_ASSERT_PTR_NOT_NULL(counterexample);
+    CU_ASSERT_PTR_NOT_NULL(strstr(counterexample, "0 0 :  0  :   0\n"));
+    free(counterexample);
+    free(result);
+
+    // A difference deep in a 20 variable table
+    result = check_equivalence("a&b&c&d&e&f&g&h&i&j&k&l&m&n&o&p&q&r&s&t", "0");
+    CU_ASSERT_FALSE(result->equivalent);
+    CU_ASSERT_EQUAL(result->first_difference, (1 << 20) - 1);
+    free(result);
+
+    CU_ASSERT_PTR_NULL(check_equivalence("a&", "a"));
+
+    CU_ASSERT_EQUAL(project_row(5, "abc", "ca"), 3);
+    CU_ASSERT_EQUAL(project_row(5, "abc", "d"), -1);
+}
+
+void test_first_true_and_false_rows(void)
+{
+    CU_ASSERT_EQUAL(find_first_true_row("a&b"), 3);
+    CU_ASSERT_EQUAL(find_first_true_row("a&-a"), -1);
+    CU_ASSERT_EQUAL(find_first_true_row("ab|"), 1);
+    CU_ASSERT_EQUAL(find_first_true_row("a&"), -2);
+
+    CU_ASSERT_EQUAL(find_first_false_row("a|-a"), -1);
+    CU_ASSERT_EQUAL(find_first_false_row("a|b"), 0);
+    CU_ASSERT_EQUAL(find_first_false_row("a>b"), 1);
+
+    // The only false row is the last row of a 22 variable table
+    CU_ASSERT_EQUAL(find_first_false_row("-(a&b&c&d&e&f&g&h&i&j&k&l&m&n&o&p&q&r&s&t&u&v)"), (1 << 22) - 1);
+}
+
+void test_generate_single_row_table(void)
+{
+    char *result;
+
+    result = generate_single_row_table("a&b", 3);
+    CU_ASSERT_STRING_EQUAL(result, "a b : a&b : Result\n==================\n1 1 :  1  :   1\n");
+    free(result);
+
+    result = generate_single_row_table("ab|", 2);
+    CU_ASSERT_STRING_EQUAL(result, "a b : ab| : Result\n==================\n1 0 :   1 :   1\n");
+    free(result);
+
+    CU_ASSERT_PTR_NULL(generate_single_row_table("a&b", 4));
+}
+
+void test_mobius_transform(void)
+{
+    compiled_expression *compiled;
+    uint64_t *coefficients;
+
+    // a|b = a # b # a&b, bits 01, 10 and 11
+    compiled = compile_expression("a|b", NULL);
+    coefficients = generate_truth_vector(compiled);
+    mobius_transform(coefficients, 2);
+    CU_ASSERT_EQUAL(coefficients[0], 0xE);
+    free(coefficients);
+    free_compiled_expression(compiled);
+
+    // a=b = 1 # a # b
+    compiled = compile_expression("a=b", NULL);
+    coefficients = generate_truth_vector(compiled);
+    mobius_transform(coefficients, 2);
+    CU_ASSERT_EQUAL(coefficients[0], 0x7);
+    free(coefficients);
+    free_compiled_expression(compiled);
+
+    // A single monomial over 16 variables has one coefficient, at its last row
+    compiled = compile_expression("a&b&c&d&e&f&g&h&i&j&k&l&m&n&o&p", NULL);
+    coefficients = generate_truth_vector(compiled);
+    mobius_transform(coefficients, 16);
+    int set_bits = 0;
+    for (int64_t w = 0; w < number_of_words(16); w++)
+    {
+        set_bits += __builtin_popcountll(coefficients[w]);
+    }
+    CU_ASSERT_EQUAL(set_bits, 1);
+    CU_ASSERT_EQUAL(coefficients[number_of_words(16) - 1], 1ULL << 63);
+    free(coefficients);
+    free_compiled_expression(compiled);
+
+    // XOR of variables above and below the sixth column
+    compiled = compile_expression("a#h", "abcdefgh");
+    coefficients = generate_truth_vector(compiled);
+    mobius_transform(coefficients, 8);
+    CU_ASSERT_EQUAL(coefficients[0], 0x2);
+    CU_ASSERT_EQUAL(coefficients[1], 0);
+    CU_ASSERT_EQUAL(coefficients[2], 1);
+    CU_ASSERT_EQUAL(coefficients[3], 0);
+    free(coefficients);
+    free_compiled_expression(compiled);
+}
+
+void test_walsh_hadamard_spectrum(void)
+{
+    compiled_expression *compiled;
+    uint64_t *truth_vector;
+    int32_t *spectrum;
+
+    // a&b over rows 00 01 10 11
+    compiled = compile_expression("a&b", NULL);
+    truth_vector = generate_truth_vector(compiled);
+    spectrum = walsh_hadamard_spectrum(truth_vector, 2);
+    CU_ASSERT_EQUAL(spectrum[0], 2);
+    CU_ASSERT_EQUAL(spectrum[1], 2);
+    CU_ASSERT_EQUAL(spectrum[2], 2);
+    CU_ASSERT_EQUAL(spectrum[3], -2);
+    free(spectrum);
+    free(truth_vector);
+    free_compiled_expression(compiled);
+
+    // The parity of 16 variables only correlates with the all ones mask
+    compiled = compile_expression("a#b#c#d#e#f#g#h#i#j#k#l#m#n#o#p", NULL);
+    truth_vector = generate_truth_vector(compiled);
+    spectrum = walsh_hadamard_spectrum(truth_vector, 16);
+    CU_ASSERT_EQUAL(spectrum[0], 0);
+    CU_ASSERT_EQUAL(spectrum[12345], 0);
+    CU_ASSERT_EQUAL(spectrum[(1 << 16) - 1], 1 << 16);
+    free(spectrum);
+    free(truth_vector);
+    free_compiled_expression(compiled);
+}
+
+void test_compile_native(void)
+{
+    const char *expressions[] = {"ab&c|-", "ab>", "ba>", "abc>>", "ab=c#d-&", "a1|0&", "a", "ab&ab&|", "a-b-c-&&-"};
+    uint64_t variable_words[8];
+    uint64_t interpreted[16];
+    uint64_t native_slots[16];
+
+    for (int e = 0; e < 9; e++)
+    {
+        compiled_expression *compiled = compile_rpn(expressions[e], "abcdefgh");
+        native_expression *native = compile_native(compiled);
+#if defined(__x86_64__) && !defined(NO_JIT)
+        CU_ASSERT_PTR_NOT_NULL(native);
+#endif
+        for (int64_t word = 0; word < 4 && native != NULL; word++)
+        {
+            fill_variable_words(8, word, variable_words);
+            evaluate_word_slots(compiled, variable_words, interpreted);
+            native->function(variable_words, native_slots);
+            // Every operator slot and the final result match the interpreter
+            for (int i = 0; i < compiled->program_length; i++)
+            {
+                if (compiled->program[i].op != OP_VARIABLE || i == compiled->program_length - 1)
+                {
+                    CU_ASSERT_EQUAL(native_slots[i], interpreted[i]);
+                }
+            }
+        }
+        free_native_expression(native);
+        free_compiled_expression(compiled);
+    }
+}
+
+void test_generate_segment_with_formatter(void)
+{
+    char *result;
+    int *expression_map = infix_map("a&(b|c)");
+    row_formatter *formatter = create_row_formatter("abc|&", expression_map, 7);
+    CU_ASSERT_PTR_NOT_NULL(formatter);
+
+    result = generate_segment_with_formatter(formatter, 5, 7, false);
+    CU_ASSERT_STRING_EQUAL(result, "1 0 1 :  1  1   :   1\n1 1 0 :  1  1   :   1\n");
+    free(result);
+
+    result = generate_segment_with_formatter(formatter, 0, 100, true);
+    CU_ASSERT_STRING_EQUAL(result, "1 0 1 :  1  1   :   1\n1 1 0 :  1  1   :   1\n1 1 1 :  1  1   :   1\n");
+    free(result);
+
+    // Past the end of the table
+    result = generate_segment_with_formatter(formatter, 9, 12, false);
+    CU_ASSERT_STRING_EQUAL(result, "");
+    free(result);
+
+    free_row_formatter(formatter);
+    free(expression_map);
+
+    CU_ASSERT_PTR_NULL(create_row_formatter("a&", NULL, 2));
+}
+
+void test_emit_c_kernels(void)
+{
+    char *source = NULL;
+    size_t source_size = 0;
+    FILE *file = open_memstream(&source, &source_size);
+    CU_ASSERT_TRUE(emit_c_kernels(file, "a&(b|c)", "rule"));
+    fclose(file);
+    CU_ASSERT_PTR_NOT_NULL(strstr(source, "#define RULE_NUMBER_OF_VARIABLES 3\n"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(source, "#define RULE_ROW_LENGTH 22\n"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(source, "static char rule_template_row[] = \"      :         :    \\n\";"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(source, "    .result_slot = 4,\n    .result_column = 20,\n};"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(source, "slots[3] = slots[1] | slots[2];"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(source, "return s4;"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(source, "int64_t rule_count_true(int64_t start_row, int64_t end_row)"));
+    free(source);
+
+    file = open_memstream(&source, &source_size);
+    CU_ASSERT_FALSE(emit_c_kernels(file, "a&(b|c)", "2rule"));
+    CU_ASSERT_FALSE(emit_c_kernels(file, "a&", "rule"));
+    fclose(file);
+    free(source);
+}
+
+static compiled_expression *read_from_string(const char *text, size_t length, bool aiger)
+{
+    FILE *file = fmemopen((void *)text, length, "rb");
+    compiled_expression *compiled = aiger ? read_aiger(file) : read_dimacs_cnf(file);
+    fclose(file);
+    return compiled;
+}
+
+void test_read_dimacs_cnf(void)
+{
+    uint64_t stack[16];
+    const char *cnf = "c (a|-c)&(b|c|-a)\np cnf 3 2\n1 -3 0\n2 3\n-1 0\n";
+    compiled_expression *compiled = read_from_string(cnf, strlen(cnf), false);
+    CU_ASSERT_PTR_NOT_NULL(compiled);
+    CU_ASSERT_STRING_EQUAL(compiled->variables, "abc");
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & valid_rows_mask(3), 0xE5);
+
+    char *header = generate_compiled_header(compiled, "cnf");
+    char *separator = generate_compiled_separator(compiled, "cnf");
+    CU_ASSERT_STRING_EQUAL(header, "a b c : cnf : Result\n");
+    CU_ASSERT_EQUAL(strlen(separator), strlen(header));
+    free(header);
+    free(separator);
+
+    row_formatter *formatter = create_compiled_row_formatter(compiled, "cnf");
+    char *segment = generate_segment_with_formatter(formatter, 4, 6, false);
+    CU_ASSERT_STRING_EQUAL(segment, "1 0 0 :     :   0\n1 0 1 :     :   1\n");
+    free(segment);
+    free_row_formatter(formatter);
+
+    // No clauses is true, the empty clause is false
+    compiled = read_from_string("p cnf 1 0\n", 10, false);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & valid_rows_mask(1), 0x3);
+    free_compiled_expression(compiled);
+    compiled = read_from_string("p cnf 1 2\n1 0\n0\n", 16, false);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & valid_rows_mask(1), 0);
+    free_compiled_expression(compiled);
+
+    CU_ASSERT_PTR_NULL(read_from_string("1 2 0\n", 6, false));
+    CU_ASSERT_PTR_NULL(read_from_string("p cnf 2 1\n1 3 0\n", 16, false));
+    CU_ASSERT_PTR_NULL(read_from_string("p cnf 27 0\n", 11, false));
+}
+
+void test_read_aiger(void)
+{
+    uint64_t scratch[32];
+    uint64_t variable_words[2];
+    uint64_t slots[32];
+
+    // ~(a&~b) & ~(a&b), sharing the gate a&b
+    const char *shared = "aag 5 2 0 1 3\n2\n4\n10\n6 2 4\n8 7 2\n10 9 7\n";
+    compiled_expression *compiled = read_from_string(shared, strlen(shared), true);
+    CU_ASSERT_PTR_NOT_NULL(compiled);
+    bool copies = false;
+    for (int i = 0; i < compiled->program_length; i++)
+    {
+        copies = copies || compiled->program[i].op == OP_COPY;
+    }
+    CU_ASSERT_TRUE(copies);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, scratch) & valid_rows_mask(2), 0x3);
+    fill_variable_words(2, 0, variable_words);
+    evaluate_word_slots(compiled, variable_words, slots);
+    CU_ASSERT_EQUAL(slots[compiled->program_length - 1] & valid_rows_mask(2), 0x3);
+    native_expression *native = compile_native(compiled);
+    if (native != NULL)
+    {
+        memset(slots, 0, sizeof(slots));
+        native->function(variable_words, slots);
+        CU_ASSERT_EQUAL(slots[compiled->program_length - 1] & valid_rows_mask(2), 0x3);
+        free_native_expression(native);
+    }
+    free_compiled_expression(compiled);
+
+    // a xor b in the binary format
+    const char binary[] = "aig 5 2 0 1 3\n10\n\x02\x02\x03\x02\x01\x02";
+    compiled = read_from_string(binary, sizeof(binary) - 1, true);
+    CU_ASSERT_PTR_NOT_NULL(compiled);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, scratch) & valid_rows_mask(2), 0x6);
+    free_compiled_expression(compiled);
+
+    // Latches and cycles aren't supported
+    CU_ASSERT_PTR_NULL(read_from_string("aag 1 0 1 0 0\n2 3\n", 19, true));
+    CU_ASSERT_PTR_NULL(read_from_string("aag 3 1 0 1 2\n2\n4\n4 6 2\n6 4 2\n", 29, true));
+}
+
+void test_batch(void)
+{
+    const char *batch = "# comment\nsegment 0 2 a&b\n\ntrue (a|b)\nsegment 3 4 ab&\ntrue a&\nfalse a\n";
+    FILE *file = fmemopen((void *)batch, strlen(batch), "r");
+    int number_of_jobs;
+    batch_job *jobs = read_batch_jobs(file, &number_of_jobs);
+    fclose(file);
+    CU_ASSERT_PTR_NOT_NULL(jobs);
+    CU_ASSERT_EQUAL(number_of_jobs, 5);
+    CU_ASSERT_EQUAL(jobs[0].line_number, 2);
+    CU_ASSERT_EQUAL(jobs[0].mode, BATCH_SEGMENT);
+    CU_ASSERT_EQUAL(jobs[0].end_row, 2);
+    CU_ASSERT_STRING_EQUAL(jobs[1].expression, "(a|b)");
+    CU_ASSERT_EQUAL(jobs[1].mode, BATCH_TRUE_ROWS);
+    CU_ASSERT_EQUAL(jobs[4].mode, BATCH_INVALID);
+
+    char *output = NULL;
+    size_t output_size = 0;
+    FILE *stream = open_memstream(&output, &output_size);
+    CU_ASSERT_EQUAL(run_batch(jobs, number_of_jobs, stream, NULL), 0);
+    fclose(stream);
+
+    // Outputs stay in the order of the file, tagged with their line and size
+    const char *expected =
+        "#2 70\n"
+        "a b : a&b : Result\n"
+        "==================\n"
+        "0 0 :  0  :   0\n"
+        "0 1 :  0  :   0\n"
+        "#4 96\n"
+        "a b : (a|b) : Result\n"
+        "====================\n"
+        "0 1 :   1   :   1\n"
+        "1 0 :   1   :   1\n"
+        "1 1 :   1   :   1\n"
+        "#5 16\n"
+        "1 1 :   1 :   1\n";
+    CU_ASSERT_EQUAL(strncmp(output, expected, strlen(expected)), 0);
+    CU_ASSERT_PTR_NOT_NULL(strstr(output, "#6 "));
+    CU_ASSERT_PTR_NOT_NULL(strstr(output, "#7 "));
+    free(output);
+    free_batch_jobs(jobs, number_of_jobs);
+
+    // Jobs of many segments, split over the workers, are joined back like the single expression modes
+    const char *big_batch = "segment 0 300000 a|b&c|d&e|f&g|h&i|j&k|l&m|n&o|p&q|r\ntrue a & b | c&d&e&f&g&h&i&j&k&l&m&n&o&p&q&r\nsegment 5 6 a\n";
+    file = fmemopen((void *)big_batch, strlen(big_batch), "r");
+    jobs = read_batch_jobs(file, &number_of_jobs);
+    fclose(file);
+    stream = open_memstream(&output, &output_size);
+    CU_ASSERT_EQUAL(run_batch(jobs, number_of_jobs, stream, NULL), 0);
+    fclose(stream);
+    char *cursor = output;
+    for (int i = 0; i < 2; i++)
+    {
+        parsed_expression *parsed = parse_expression(jobs[i].expression);
+        char *header = generate_header(jobs[i].expression);
+        char *separator = generate_separator(jobs[i].expression);
+        char *rows = generate_parsed_segment(parsed, 0, 1 << 18, i == 1);
+        size_t length = strlen(header) + strlen(separator) + strlen(rows);
+        char tag[32];
+        snprintf(tag, sizeof(tag), "#%d %zu\n", i + 1, length);
+        CU_ASSERT_EQUAL(strncmp(cursor, tag, strlen(tag)), 0);
+        cursor += strlen(tag);
+        CU_ASSERT_EQUAL(strncmp(cursor, header, strlen(header)), 0);
+        cursor += strlen(header);
+        CU_ASSERT_EQUAL(strncmp(cursor, separator, strlen(separator)), 0);
+        cursor += strlen(separator);
+        CU_ASSERT_EQUAL(strncmp(cursor, rows, strlen(rows)), 0);
+        cursor += strlen(rows);
+        free(rows);
+        free(separator);
+        free(header);
+        free_parsed_expression(parsed);
+    }
+    CU_ASSERT_STRING_EQUAL(cursor, "#3 0\n");
+    free(output);
+    free_batch_jobs(jobs, number_of_jobs);
+}
+
+void test_multi_output(void)
+{
+    parsed_expression *parsed[3] = {parse_expression("a&b"), parse_expression("cb|"), parse_expression("b")};
+    row_formatter *formatter = create_multi_row_formatter(parsed, 3);
+    CU_ASSERT_PTR_NOT_NULL(formatter);
+    CU_ASSERT_EQUAL(formatter->number_of_variables, 3);
+
+    char *header = generate_multi_header(parsed, 3);
+    char *separator = generate_multi_separator(parsed, 3);
+    CU_ASSERT_STRING_EQUAL(header, "a b c : a&b : cb| : b : Any\n");
+    CU_ASSERT_EQUAL(strlen(separator), strlen(header));
+    free(header);
+    free(separator);
+
+    char *segment = generate_segment_with_formatter(formatter, 0, 8, false);
+    CU_ASSERT_STRING_EQUAL(segment,
+                           "0 0 0 :  0  :   0 : 0 :   0\n"
+                           "0 0 1 :  0  :   1 : 0 :   1\n"
+                           "0 1 0 :  0  :   1 : 1 :   1\n"
+                           "0 1 1 :  0  :   1 : 1 :   1\n"
+                           "1 0 0 :  0  :   0 : 0 :   0\n"
+                           "1 0 1 :  0  :   1 : 0 :   1\n"
+                           "1 1 0 :  1  :   1 : 1 :   1\n"
+                           "1 1 1 :  1  :   1 : 1 :   1\n");
+    free(segment);
+
+    // Only rows where one of the expressions is true
+    segment = generate_segment_with_formatter(formatter, 0, 8, true);
+    CU_ASSERT_EQUAL((int)strlen(segment), 6 * formatter->row_length);
+    free(segment);
+    free_row_formatter(formatter);
+    for (int j = 0; j < 3; j++)
+    {
+        free_parsed_expression(parsed[j]);
+    }
+}
+
+void test_expression_cache(void)
+{
+    expression_cache *cache = create_expression_cache(2);
+    CU_ASSERT_PTR_NOT_NULL(cache);
+
+    const cached_expression *first = acquire_cached_expression(cache, "a&b");
+    CU_ASSERT_PTR_NOT_NULL(first);
+    CU_ASSERT_STRING_EQUAL(first->key, "a&b");
+    CU_ASSERT_STRING_EQUAL(first->header, "a b : a&b : Result\n");
+    CU_ASSERT_STRING_EQUAL(first->separator, "==================\n");
+
+    const cached_expression *again = acquire_cached_expression(cache, "a&b");
+    CU_ASSERT_PTR_EQUAL(first, again);
+    CU_ASSERT_EQUAL(cache->hits, 1);
+    CU_ASSERT_EQUAL(cache->misses, 1);
+    CU_ASSERT_PTR_NULL(acquire_cached_expression(cache, "a&"));
+
+    // Spaced expressions are entries of their own, with the same table as the command line
+    const cached_expression *spaced = acquire_cached_expression(cache, "a | b");
+    CU_ASSERT_PTR_NOT_EQUAL(spaced, first);
+    CU_ASSERT_STRING_EQUAL(spaced->key, "a | b");
+    char *header = generate_header("a | b");
+    CU_ASSERT_STRING_EQUAL(spaced->header, header);
+    CU_ASSERT_STRING_EQUAL(spaced->header, "a b : a | b : Result\n");
+    parsed_expression *parsed = parse_expression("a | b");
+    char *expected = generate_parsed_segment(parsed, 0, 4, false);
+    char *rows = generate_segment_with_formatter(spaced->formatter, 0, 4, false);
+    CU_ASSERT_STRING_EQUAL(rows, expected);
+    free(rows);
+    free(expected);
+    free(header);
+    free_parsed_expression(parsed);
+    release_cached_expression(cache, spaced);
+
+    // Held entries stay usable after eviction
+    const cached_expression *second = acquire_cached_expression(cache, "ab|");
+    const cached_expression *third = acquire_cached_expression(cache, "-c");
+    CU_ASSERT_EQUAL(cache->size, 2);
+    CU_ASSERT_TRUE(first->evicted);
+    char *segment = generate_segment_with_formatter(first->formatter, 3, 4, false);
+    CU_ASSERT_STRING_EQUAL(segment, "1 1 :  1  :   1\n");
+    free(segment);
+    release_cached_expression(cache, first);
+    release_cached_expression(cache, again);
+    release_cached_expression(cache, second);
+    release_cached_expression(cache, third);
+
+    // Recently used entries are kept over older ones
+    release_cached_expression(cache, acquire_cached_expression(cache, "ab|"));
+    release_cached_expression(cache, acquire_cached_expression(cache, "a"));
+    long misses = cache->misses;
+    release_cached_expression(cache, acquire_cached_expression(cache, "ab|"));
+    CU_ASSERT_EQUAL(cache->misses, misses);
+    release_cached_expression(cache, acquire_cached_expression(cache, "-c"));
+    CU_ASSERT_EQUAL(cache->misses, misses + 1);
+    free_expression_cache(cache);
+}
+
+void test_functions(void)
+{
+    // Infix calls become single tokens, a XOR of k arguments being k - 1 tokens
+    const char *expression = "MUX(s, a&b, -c) | XOR(a,b,c)";
+    CU_ASSERT_TRUE(is_valid_infix(expression));
+    char *rpn = shunting_yard(expression);
+    CU_ASSERT_STRING_EQUAL(rpn, "sab&c-MabcXX|");
+    int *map = infix_map(expression);
+    parsed_expression *parsed = parse_expression(expression);
+    CU_ASSERT_PTR_NOT_NULL(parsed);
+    CU_ASSERT_TRUE(parsed->is_infix);
+    CU_ASSERT_STRING_EQUAL(parsed->rpn_expression, rpn);
+    for (int i = 0; i < parsed->expression_length; i++)
+    {
+        CU_ASSERT_EQUAL(parsed->map[i], map[i]);
+    }
+    CU_ASSERT_EQUAL(map[6], 0);  // MUX
+    CU_ASSERT_EQUAL(map[10], -1); // First XOR token
+    CU_ASSERT_EQUAL(map[11], 18); // Last XOR token
+
+    // Both evaluators and the native code agree on every row
+    row_formatter *formatter = create_parsed_row_formatter(parsed);
+    char *segment = generate_segment_with_formatter(formatter, 0, 16, false);
+    for (int row = 0; row < 16; row++)
+    {
+        char *expected = generate_infix_row(row, 4, rpn, map, parsed->expression_length, parsed->rpn_length);
+        CU_ASSERT_EQUAL(strncmp(segment + row * formatter->row_length, expected, formatter->row_length), 0);
+        free(expected);
+    }
+    free(segment);
+    free_row_formatter(formatter);
+    free(rpn);
+    free(map);
+    free_parsed_expression(parsed);
+
+    // Postfix expressions use the tokens directly, every XOR keeping its column
+    compiled_expression *compiled = compile_rpn("abcdXXX", NULL);
+    CU_ASSERT_EQUAL(compiled->program_length, 7);
+    uint64_t stack[8];
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & 0xFFFF, 0x6996);
+    free_compiled_expression(compiled);
+
+    // The tokens of a single infix call compile into one instruction
+    parsed = parse_expression("XOR(a,b,c,d)");
+    compiled = compile_mapped_rpn(parsed->rpn_expression, parsed->map, NULL);
+    CU_ASSERT_EQUAL(compiled->program_length, 5);
+    CU_ASSERT_EQUAL(compiled->program[4].op, OP_XOR_N);
+    CU_ASSERT_EQUAL(compiled->program[4].operand, 4);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & 0xFFFF, 0x6996);
+    free_compiled_expression(compiled);
+    free_parsed_expression(parsed);
+
+    // Nested calls show their own columns in segments like in the single rows of the row by row evaluator
+    const char *nested[] = {"XOR(a,XOR(b,c))", "abcXX", "XOR(XOR(a,b),c,d)", "XOR(a,b,XOR(c,d))"};
+    for (int e = 0; e < 4; e++)
+    {
+        parsed = parse_expression(nested[e]);
+        formatter = create_parsed_row_formatter(parsed);
+        int number_of_rows = 1 << parsed->number_of_variables;
+        segment = generate_segment_with_formatter(formatter, 0, number_of_rows, false);
+        char *header = generate_header(nested[e]);
+        char *separator = generate_separator(nested[e]);
+        size_t rows_offset = strlen(header) + strlen(separator);
+        for (int row = 0; row < number_of_rows; row++)
+        {
+            char *table = generate_single_row_table(nested[e], row);
+            CU_ASSERT_EQUAL(strncmp(segment + row * formatter->row_length, table + rows_offset, formatter->row_length), 0);
+            free(table);
+        }
+        free(header);
+        free(separator);
+        free(segment);
+        free_row_formatter(formatter);
+        free_parsed_expression(parsed);
+    }
+    compiled = compile_rpn("abcV", NULL);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & 0xFF, 0xE8);
+    free_compiled_expression(compiled);
+    compiled = compile_rpn("abN", NULL);
+    CU_ASSERT_EQUAL(evaluate_word(compiled, 0, stack) & 0xF, 0x7);
+    free_compiled_expression(compiled);
+
+    CU_ASSERT_FALSE(is_valid_infix("MUX(a,b)"));
+    CU_ASSERT_FALSE(is_valid_infix("XOR(a)"));
+    CU_ASSERT_FALSE(is_valid_infix("NAND a,b"));
+    CU_ASSERT_FALSE(is_valid_infix("(a,b)"));
+    CU_ASSERT_PTR_NULL(parse_expression("MAJ(a,b)"));
+    CU_ASSERT_PTR_NULL(parse_expression("NOR(a,b,c)"));
+    CU_ASSERT_PTR_NULL(parse_expression("aM"));
+    CU_ASSERT_PTR_NULL(parse_expression("a NAND(b,c)"));
+}
+
+void test_cofactor(void)
+{
+    partial_assignment fixed;
+    CU_ASSERT_TRUE(parse_partial_assignment("a=1,c=0", &fixed));
+    CU_ASSERT_EQUAL(fixed.number_of_fixed, 2);
+    CU_ASSERT_STRING_EQUAL(fixed.variables, "ac");
+    CU_ASSERT_TRUE(fixed.values[0]);
+    CU_ASSERT_FALSE(fixed.values[1]);
+    CU_ASSERT_FALSE(parse_partial_assignment("a=1,a=0", &fixed));
+    CU_ASSERT_FALSE(parse_partial_assignment("a=2", &fixed));
+    CU_ASSERT_FALSE(parse_partial_assignment("a=1,", &fixed));
+    CU_ASSERT_FALSE(parse_partial_assignment("", &fixed));
+
+    // Each row of the sub-table is the row of the full table with the fixed columns set
+    parsed_expression *parsed = parse_expression("(a>b)&MUX(c,b,d)#c");
+    row_formatter *full = create_parsed_row_formatter(parsed);
+    char *table = generate_segment_with_formatter(full, 0, 16, false);
+    CU_ASSERT_TRUE(parse_partial_assignment("c=1,a=0", &fixed));
+    row_formatter *formatter = create_cofactor_row_formatter(parsed, &fixed);
+    CU_ASSERT_EQUAL(formatter->number_of_variables, 2);
+    CU_ASSERT_EQUAL(formatter->row_length, full->row_length);
+    char *segment = generate_cofactor_segment(parsed, &fixed, 0, 8, false);
+    CU_ASSERT_EQUAL((int)strlen(segment), 4 * full->row_length);
+    for (int row = 0; row < 4; row++)
+    {
+        int full_row = ((row >> 1) << 2) | 2 | (row & 1); // a=0 b c=1 d
+        CU_ASSERT_EQUAL(strncmp(segment + row * full->row_length, table + full_row * full->row_length, full->row_length), 0);
+    }
+    free(segment);
+    segment = generate_cofactor_segment(parsed, &fixed, 1, 3, true);
+    char *expected = generate_segment_with_formatter(formatter, 1, 3, true);
+    CU_ASSERT_STRING_EQUAL(segment, expected);
+    free(segment);
+    free(expected);
+    free_row_formatter(formatter);
+
+    // Fixed variables must be in the expression
+    CU_ASSERT_TRUE(parse_partial_assignment("e=1", &fixed));
+    CU_ASSERT_PTR_NULL(create_cofactor_row_formatter(parsed, &fixed));
+    free(table);
+    free_row_formatter(full);
+    free_parsed_expression(parsed);
+}
+
+void test_sampling(void)
+{
+    // Same seed, same rows, all inside the table
+    int64_t *rows = sample_rows(5, 100, 42);
+    int64_t *again = sample_rows(5, 100, 42);
+    for (int i = 0; i < 100; i++)
+    {
+        CU_ASSERT_TRUE(rows[i] >= 0 && rows[i] < 32);
+        CU_ASSERT_EQUAL(rows[i], again[i]);
+    }
+    free(rows);
+    free(again);
+
+    // Every true row drawn is true, and every true row of a sparse table gets drawn
+    compiled_expression *compiled = compile_expression("a&b&c&d&e&f&g&h&(i#j)&-k&l|-a&m&n&o&p&q&r&l&k", NULL);
+    int64_t number_of_true_rows = 0;
+    rows = sample_true_rows(compiled, 20000, 7, &number_of_true_rows);
+    CU_ASSERT_EQUAL(number_of_true_rows, 2 * 64 + 512);
+    uint64_t stack[64];
+    bool *drawn = (bool *)calloc(1 << 18, sizeof(bool));
+    int distinct = 0;
+    int true_rows = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        true_rows += (evaluate_word(compiled, rows[i] / 64, stack) >> (rows[i] % 64)) & 1;
+        distinct += !drawn[rows[i]];
+        drawn[rows[i]] = true;
+    }
+    CU_ASSERT_EQUAL(true_rows, 20000);
+    CU_ASSERT_EQUAL(distinct, number_of_true_rows);
+    free(drawn);
+    free(rows);
+    free_compiled_expression(compiled);
+
+    // Tables smaller than a word only draw rows of the table
+    compiled = compile_expression("a|b", NULL);
+    rows = sample_true_rows(compiled, 50, 1, &number_of_true_rows);
+    CU_ASSERT_EQUAL(number_of_true_rows, 3);
+    for (int i = 0; i < 50; i++)
+    {
+        CU_ASSERT_TRUE(rows[i] >= 1 && rows[i] <= 3);
+    }
+    free(rows);
+    free_compiled_expression(compiled);
+
+    compiled = compile_expression("a&-a", NULL);
+    rows = sample_true_rows(compiled, 10, 1, &number_of_true_rows);
+    CU_ASSERT_PTR_NOT_NULL(rows);
+    CU_ASSERT_EQUAL(number_of_true_rows, 0);
+    free(rows);
+    free_compiled_expression(compiled);
+}
+
+void test_quantification(void)
+{
+    // Every choice of quantified variables agrees with combining the rows of the full table one by one
+    compiled_expression *compiled = compile_expression("(a#h)&(b|-i)>(c=g)&MAJ(d,e,f)|-(b&h)#a&j", NULL);
+    uint64_t *truth_vector = generate_truth_vector(compiled);
+    const char *choices[] = {"a", "j", "f", "e", "a,j", "b,h", "c,d,e,f,g,h,i,j", "e,f,g,h,i,j", "a,b,c,d"};
+    for (int choice = 0; choice < 9; choice++)
+    {
+        for (int universal = 0; universal < 2; universal++)
+        {
+            char quantified[27] = "";
+            int64_t quantified_rows = 0;
+            for (int i = 0; choices[choice][i] != '\0'; i++)
+            {
+                if (choices[choice][i] == ',')
+                {
+                    continue;
+                }
+                strncat(quantified, &choices[choice][i], 1);
+                quantified_rows |= 1 << (9 - (strchr(compiled->variables, choices[choice][i]) - compiled->variables));
+            }
+            char remaining[27];
+            uint64_t *result = quantify_truth_vector(truth_vector, compiled->variables, quantified, universal, remaining);
+            CU_ASSERT_EQUAL((int)strlen(remaining), 10 - (int)strlen(quantified));
+            int mismatches = 0;
+            int64_t row = 0;
+            for (int64_t quantified_row = 0; quantified_row < 1 << strlen(remaining); quantified_row++)
+            {
+                bool expected = universal;
+                for (int64_t other = 0; other < 1024; other++)
+                {
+                    if ((other & ~quantified_rows) == 0)
+                    {
+                        bool value = (truth_vector[(row | other) / 64] >> ((row | other) % 64)) & 1;
+                        expected = universal ? expected && value : expected || value;
+                    }
+                }
+                mismatches += expected != (bool)((result[quantified_row / 64] >> (quantified_row % 64)) & 1);
+                row = ((row | quantified_rows) + 1) & ~quantified_rows;
+            }
+            CU_ASSERT_EQUAL(mismatches, 0);
+            free(result);
+        }
+    }
+    char remaining[27];
+    CU_ASSERT_PTR_NULL(quantify_truth_vector(truth_vector, compiled->variables, "z", false, remaining));
+
+    // The quantified table reads its results from the truth vector
+    uint64_t *result = quantify_truth_vector(truth_vector, compiled->variables, "bcdefghij", false, remaining);
+    row_formatter *formatter = create_truth_vector_row_formatter(result, remaining, "exists");
+    char *segment = generate_segment_with_formatter(formatter, 0, 2, false);
+    CU_ASSERT_STRING_EQUAL(segment, "0 :        :   1\n1 :        :   1\n");
+    free(segment);
+    free_row_formatter(formatter);
+    free(truth_vector);
+    free_compiled_expression(compiled);
+}
+
+void test_truthtable_library(void)
+{
+    truthtable_expression *compiled = NULL;
+    CU_ASSERT_EQUAL(truthtable_compile("a&&", &compiled), TRUTHTABLE_INVALID_EXPRESSION);
+    CU_ASSERT_PTR_NULL(compiled);
+    CU_ASSERT_EQUAL(truthtable_compile("(a#b)&c|MAJ(d,e,-g)>f", &compiled), TRUTHTABLE_OK);
+    CU_ASSERT_EQUAL(truthtable_number_of_variables(compiled), 7);
+    int row_length = truthtable_row_length(compiled);
+
+    char header[128];
+    size_t written;
+    CU_ASSERT_EQUAL(truthtable_header(compiled, header, 10, &written), TRUTHTABLE_BUFFER_TOO_SMALL);
+    CU_ASSERT_EQUAL(truthtable_header(compiled, header, sizeof(header), &written), TRUTHTABLE_OK);
+    char *expected_header = generate_header("(a#b)&c|MAJ(d,e,-g)>f");
+    char *expected_separator = generate_separator("(a#b)&c|MAJ(d,e,-g)>f");
+    CU_ASSERT_EQUAL(strncmp(header, expected_header, strlen(expected_header)), 0);
+    CU_ASSERT_STRING_EQUAL(header + strlen(expected_header), expected_separator);
+    CU_ASSERT_EQUAL(written, strlen(expected_header) + strlen(expected_separator));
+    free(expected_header);
+    free(expected_separator);
+
+    // Same rows as the command line
+    parsed_expression *parsed = parse_expression("(a#b)&c|MAJ(d,e,-g)>f");
+    char *expected = generate_parsed_segment(parsed, 5, 100, false);
+    char buffer[128 * 128];
+    CU_ASSERT_EQUAL(truthtable_segment(compiled, 5, 100, buffer, 95 * row_length, &written), TRUTHTABLE_BUFFER_TOO_SMALL);
+    CU_ASSERT_EQUAL(written, (size_t)95 * row_length);
+    CU_ASSERT_EQUAL(truthtable_segment(compiled, 5, 100, buffer, sizeof(buffer), &written), TRUTHTABLE_OK);
+    CU_ASSERT_STRING_EQUAL(buffer, expected);
+    free(expected);
+    CU_ASSERT_EQUAL(truthtable_segment(compiled, 120, 1000, buffer, sizeof(buffer), &written), TRUTHTABLE_OK);
+    CU_ASSERT_EQUAL(written, (size_t)8 * row_length);
+    CU_ASSERT_EQUAL(truthtable_segment(compiled, -1, 4, buffer, sizeof(buffer), &written), TRUTHTABLE_INVALID_ARGUMENT);
+
+    // Iterating with a buffer of 3 rows gives every true row once
+    expected = generate_parsed_segment(parsed, 0, 128, true);
+    char rows[128 * 128] = "";
+    int64_t cursor = 0;
+    int calls = 0;
+    char small[3 * 64];
+    CU_ASSERT_EQUAL(truthtable_next_true_rows(compiled, &cursor, small, row_length, &written), TRUTHTABLE_BUFFER_TOO_SMALL);
+    do
+    {
+        CU_ASSERT_EQUAL(truthtable_next_true_rows(compiled, &cursor, small, 3 * row_length + 1, &written), TRUTHTABLE_OK);
+        CU_ASSERT_TRUE(written <= (size_t)3 * row_length);
+        strcat(rows, small);
+        calls++;
+    } while (written > 0);
+    CU_ASSERT_STRING_EQUAL(rows, expected);
+    CU_ASSERT_EQUAL(cursor, 128);
+    int64_t count = 0;
+    CU_ASSERT_EQUAL(truthtable_count_true_rows(compiled, &count), TRUTHTABLE_OK);
+    CU_ASSERT_EQUAL(count * row_length, (int64_t)strlen(expected));
+    CU_ASSERT_EQUAL(calls, (count + 2) / 3 + 1);
+    free(expected);
+    free_parsed_expression(parsed);
+    truthtable_free(compiled);
+
+    CU_ASSERT_EQUAL(truthtable_compile("a&b&c&d&e&f&g&h&i&j&k&l&m&n&o&p&q&r&s|t", &compiled), TRUTHTABLE_OK);
+    CU_ASSERT_EQUAL(truthtable_count_true_rows(compiled, &count), TRUTHTABLE_OK);
+    CU_ASSERT_EQUAL(count, (1 << 19) + 1);
+    truthtable_free(compiled);
+    CU_ASSERT_STRING_EQUAL(truthtable_status_message(TRUTHTABLE_BUFFER_TOO_SMALL), "Buffer too small");
+}
+
+static void *serve_in_thread(void *server)
+{
+    run_http_server((http_server *)server);
+    return NULL;
+}
+
+void test_http_server(void)
+{
+    // Same lines as the segment mode prints, and as the lines of the true rows file
+    expression_cache *cache = create_expression_cache(4);
+    char *body;
+    size_t body_length;
+    CU_ASSERT_EQUAL(answer_generate_request(cache, "expression=a%26b%7Cc&start=0&end=2", &body, &body_length), 200);
+    CU_ASSERT_STRING_EQUAL(body, "[\"a b c : a&b|c : Result\",\"======================\",\"0 0 0 :  0 0  :   0\",\"0 0 1 :  0 1  :   1\"]\n");
+    CU_ASSERT_EQUAL(body_length, strlen(body));
+    free(body);
+    CU_ASSERT_EQUAL(answer_generate_request(cache, "expression=a%26b%7Cc&start=3&mode=true_rows&session_id=1", &body, &body_length), 200);
+    CU_ASSERT_STRING_EQUAL(body, "[\"0 1 1 :  0 1  :   1\\n\",\"1 0 1 :  0 1  :   1\\n\",\"1 1 0 :  1 1  :   1\\n\",\"1 1 1 :  1 1  :   1\\n\"]\n");
+    free(body);
+    CU_ASSERT_EQUAL(answer_generate_request(cache, "expression=a+%26%26&start=0", &body, &body_length), 200);
+    CU_ASSERT_EQUAL(strncmp(body, "[\"Variables must be a-z lowercase.\",", 36), 0);
+    free(body);
+    CU_ASSERT_EQUAL(answer_generate_request(cache, "expression=a&start=2", &body, &body_length), 200);
+    CU_ASSERT_STRING_EQUAL(body, "[]\n");
+    free(body);
+    CU_ASSERT_EQUAL(answer_generate_request(cache, "start=2", &body, &body_length), 400);
+    free(body);
+    CU_ASSERT_EQUAL(answer_generate_request(cache, "expression=a&mode=other", &body, &body_length), 400);
+    free(body);
+
+    // Pages of 100 true rows skip whole words of rows
+    CU_ASSERT_EQUAL(answer_generate_request(cache, "expression=a%7Cb%7Cc%7Cd%7Ce%7Cf%7Cg%7Ch&start=200&mode=true_rows", &body, &body_length), 200);
+    parsed_expression *parsed = parse_expression("a|b|c|d|e|f|g|h");
+    char *expected = generate_parsed_segment(parsed, 0, 256, true);
+    int row_length = strchr(expected, '\n') - expected + 1;
+    CU_ASSERT_EQUAL(strncmp(body + 2, expected + 198 * row_length, row_length - 1), 0);
+    int lines = 0;
+    for (char *comma = body; (comma = strstr(comma, "\",\"")) != NULL; comma++)
+    {
+        lines++;
+    }
+    CU_ASSERT_EQUAL(lines, 255 - 198 - 1);
+    free_parsed_expression(parsed);
+    free(expected);
+    free(body);
+    free_expression_cache(cache);
+
+    // Two requests on one connection through the event loop
+    http_server *server = create_http_server(0);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(server);
+    pthread_t thread;
+    pthread_create(&thread, NULL, serve_in_thread, server);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = {.sin_family = AF_INET, .sin_port = htons(http_server_port(server))};
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CU_ASSERT_EQUAL(connect(fd, (struct sockaddr *)&address, sizeof(address)), 0);
+    const char *requests = "GET /generate?expression=a&end=1 HTTP/1.1\r\n\r\nGET /other HTTP/1.1\r\nConnection: close\r\n\r\n";
+    CU_ASSERT_EQUAL(write(fd, requests, strlen(requests)), (ssize_t)strlen(requests));
+    char response[1024];
+    size_t response_length = 0;
+    ssize_t received;
+    while ((received = read(fd, response + response_length, sizeof(response) - 1 - response_length)) > 0)
+    {
+        response_length += received;
+    }
+    response[response_length] = '\0';
+    close(fd);
+    CU_ASSERT_PTR_NOT_NULL(strstr(response, "HTTP/1.1 200 OK\r\n"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(response, "\r\n\r\n[\"a : a : Result\",\"==============\",\"0 :   :   0\"]\n"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(response, "HTTP/1.1 404 Not Found\r\n"));
+
+    // Clients hanging up right after their request, so responses and hang ups share batches of events
+    int clients[16];
+    const char *request = "GET /generate?expression=a%26b&end=4 HTTP/1.1\r\nConnection: close\r\n\r\n";
+    for (int i = 0; i < 16; i++)
+    {
+        clients[i] = socket(AF_INET, SOCK_STREAM, 0);
+        CU_ASSERT_EQUAL(connect(clients[i], (struct sockaddr *)&address, sizeof(address)), 0);
+        CU_ASSERT_EQUAL(write(clients[i], request, strlen(request)), (ssize_t)strlen(request));
+        shutdown(clients[i], SHUT_WR);
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        response_length = 0;
+        while ((received = read(clients[i], response + response_length, sizeof(response) - 1 - response_length)) > 0)
+        {
+            response_length += received;
+        }
+        response[response_length] = '\0';
+        close(clients[i]);
+        CU_ASSERT_PTR_NOT_NULL(strstr(response, "HTTP/1.1 200 OK\r\n"));
+    }
+    stop_http_server(server);
+    pthread_join(thread, NULL);
+    free_http_server(server);
+}
+
+/**
+ * Joins the frames of a stream, checking each one is announced with its size
+ */
+static char *join_frames(const char *stream, int *number_of_frames)
+{
+    char *joined = (char *)calloc(strlen(stream) + 1, 1);
+    size_t length = 0;
+    *number_of_frames = 0;
+    while (*stream != '\0')
+    {
+        char *payload;
+        size_t size = strtoul(stream, &payload, 10);
+        if (*payload != '\n' || strlen(payload + 1) < size)
+        {
+            free(joined);
+            return NULL;
+        }
+        memcpy(joined + length, payload + 1, size);
+        length += size;
+        stream = payload + 1 + size;
+        (*number_of_frames)++;
+    }
+    return joined;
+}
+
+void test_stream_json_segment(void)
+{
+    // Frames joined are the body of the same request to the server, whatever the number of segments
+    // Expression, start, end and the expression percent encoded
+    const char *queries[][4] = {{"a|b&-c", "0", "8", "a%7Cb%26-c"}, {"a|b&-c", "3", "100", "a%7Cb%26-c"},
+                                {"abcdefghijklmn&&&&&&&&&&&&&", "0", "10000", "abcdefghijklmn%26%26%26%26%26%26%26%26%26%26%26%26%26"},
+                                {"abcdefghijklmn&&&&&&&&&&&&&", "5000", "20000", "abcdefghijklmn%26%26%26%26%26%26%26%26%26%26%26%26%26"},
+                                {"a", "2", "4", "a"}, {"a &&", "0", "4", "a+%26%26"}, {"a", "-1", "4", "a"},
+                                {"a | b", "0", "4", "a%20%7C+b"}, {"a|b", "0", "4", "a%7Cb"}};
+    expression_cache *cache = create_expression_cache(4);
+    for (int i = 0; i < 9; i++)
+    {
+        parsed_expression *parsed = parse_expression(queries[i][0]);
+        row_formatter *formatter = parsed == NULL ? NULL : create_parsed_row_formatter(parsed);
+        char *header = generate_header(queries[i][0]);
+        char *separator = generate_separator(queries[i][0]);
+        char *stream;
+        size_t stream_length;
+        FILE *file = open_memstream(&stream, &stream_length);
+        stream_json_segment(formatter, header, separator, atoi(queries[i][1]), atoi(queries[i][2]), file);
+        fclose(file);
+
+        int number_of_frames;
+        char *joined = join_frames(stream, &number_of_frames);
+        char query[128];
+        snprintf(query, sizeof(query), "expression=%s&start=%s&end=%s", queries[i][3], queries[i][1], queries[i][2]);
+        char *body;
+        size_t body_length;
+        answer_generate_request(cache, query, &body, &body_length);
+        CU_ASSERT_STRING_EQUAL(joined, body);
+        // Ended by an empty frame, segments of 4096 rows in frames of their own
+        CU_ASSERT(stream_length >= 2 && strcmp(stream + stream_length - 2, "0\n") == 0);
+        if (i == 2)
+        {
+            // Header, separator, 3 segments, closing bracket and the empty frame
+            CU_ASSERT_EQUAL(number_of_frames, 7);
+        }
+        if (i == 7)
+        {
+            // Laid out on the spacing of the expression, as server.py forwards it
+            CU_ASSERT_EQUAL(strncmp(body, "[\"a b : a | b : Result\",\"====================\"", 46), 0);
+        }
+        free(body);
+        free(joined);
+        free(stream);
+        free(header);
+        free(separator);
+        free_row_formatter(formatter);
+        free_parsed_expression(parsed);
+    }
+    free_expression_cache(cache);
+}
+
+/**
+ * Removes the new lines of a JSON document, the ones between the elements of its arrays
+ */
+static void remove_new_lines(char *text)
+{
+    char *out = text;
+    for (; *text != '\0'; text++)
+    {
+        if (*text != '\n')
+        {
+            *out++ = *text;
+        }
+    }
+    *out = '\0';
+}
+
+void test_table_formats(void)
+{
+    table_format format;
+    CU_ASSERT_TRUE(parse_table_format("markdown", &format));
+    CU_ASSERT_EQUAL(format, TABLE_FORMAT_MARKDOWN);
+    CU_ASSERT_FALSE(parse_table_format("xml", &format));
+
+    parsed_expression *parsed = parse_expression("a|b&-c");
+    const char *expected[][2] = {{"a,b,c,\"a|b&-c\"\n0,0,0,0\n0,0,1,0\n", "0,1,0,1\n0,1,1,0\n"},
+                                 {"| a | b | c | a\\|b&-c |\n| --- | --- | --- | --- |\n| 0 | 0 | 0 | 0 |\n| 0 | 0 | 1 | 0 |\n", "| 0 | 1 | 0 | 1 |\n| 0 | 1 | 1 | 0 |\n"}};
+    for (int i = 0; i < 2; i++)
+    {
+        formatted_table *table = create_formatted_table(parsed, i == 0 ? TABLE_FORMAT_CSV : TABLE_FORMAT_MARKDOWN);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+        char *segment = generate_formatted_segment(table, 0, 2, false);
+        CU_ASSERT_STRING_EQUAL(segment, expected[i][0]);
+        free(segment);
+        segment = generate_formatted_segment(table, 2, 4, false);
+        CU_ASSERT_STRING_EQUAL(segment, expected[i][1]);
+        free(segment);
+        free_formatted_table(table);
+    }
+
+    // JSON segments are the arrays the server answers, whatever rows they start at
+    formatted_table *table = create_formatted_table(parsed, TABLE_FORMAT_JSON);
+    expression_cache *cache = create_expression_cache(1);
+    int ranges[][2] = {{0, 8}, {3, 5}, {7, 8}, {0, 0}, {8, 9}};
+    for (int i = 0; i < 5; i++)
+    {
+        char query[64];
+        snprintf(query, sizeof(query), "expression=a%%7Cb%%26-c&start=%d&end=%d", ranges[i][0], ranges[i][1]);
+        char *body;
+        size_t body_length;
+        answer_generate_request(cache, query, &body, &body_length);
+        char *segment = generate_formatted_segment(table, ranges[i][0], ranges[i][1], false);
+        remove_new_lines(body);
+        remove_new_lines(segment);
+        CU_ASSERT_STRING_EQUAL(segment, body);
+        free(segment);
+        free(body);
+    }
+    free_expression_cache(cache);
+
+    // The file has the header, the 5 true rows and the footer
+    FILE *file = tmpfile();
+    generate_formatted_table_body(table, file);
+    long length = ftell(file);
+    char *written = (char *)calloc(length + 1, 1);
+    rewind(file);
+    CU_ASSERT_EQUAL(fread(written, 1, length, file), (size_t)length);
+    fclose(file);
+    CU_ASSERT(strncmp(written, "[\"a b c : a|b&-c : Result\"\n,\"=======================\"\n,\"0 1 0 :  1 11  :   1\"\n", 69) == 0);
+    CU_ASSERT_EQUAL(length, 27 + 27 + 5 * 24 + 2);
+    CU_ASSERT_STRING_EQUAL(written + length - 26, ",\"1 1 1 :  1 00  :   1\"\n]\n");
+    free(written);
+    free_formatted_table(table);
+    free_parsed_expression(parsed);
+}
+
+void test_true_row_index(void)
+{
+    // An infix and a postfix expression, both written by the segment threads of the table body
+    const char *expressions[] = {"(a|b)&(c#d)&-(e&f&g)&(h|i|j|k)", "abcdefghijk||||||||||"};
+    for (int e = 0; e < 2; e++)
+    {
+        parsed_expression *parsed = parse_expression(expressions[e]);
+        int number_of_segments = ((1 << parsed->number_of_variables) - 1) / TABLE_BODY_SEGMENT_SIZE + 1;
+        int64_t *segment_true_rows = (int64_t *)calloc(number_of_segments, sizeof(int64_t));
+        FILE *file = tmpfile();
+        generate_parsed_table_body_with_counts(parsed, file, segment_true_rows);
+        fclose(file);
+
+        row_formatter *formatter = create_parsed_row_formatter(parsed);
+        bool counted = true;
+        for (int i = 0; i < number_of_segments; i++)
+        {
+            char *segment = generate_segment_with_formatter(formatter, i * TABLE_BODY_SEGMENT_SIZE, (i + 1) * TABLE_BODY_SEGMENT_SIZE, true);
+            counted = counted && (int64_t)strlen(segment) == segment_true_rows[i] * formatter->row_length;
+            free(segment);
+        }
+        CU_ASSERT_TRUE(counted);
+
+        // Pages generated from the index are the slices of every true row
+        char index_name[] = "/tmp/true_row_index_XXXXXX";
+        close(mkstemp(index_name));
+        CU_ASSERT_TRUE(write_true_row_index(index_name, segment_true_rows, number_of_segments, TABLE_BODY_SEGMENT_SIZE));
+        true_row_index *index = open_true_row_index(index_name);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(index);
+        char *true_rows = generate_segment_with_formatter(formatter, 0, 1 << parsed->number_of_variables, true);
+        int64_t total = strlen(true_rows) / formatter->row_length;
+        CU_ASSERT_EQUAL(index->true_rows_before[number_of_segments], total);
+        int64_t starts[] = {0, 1, 99, total / 2, total - 50, total - 1, total, total + 5};
+        for (int i = 0; i < 8; i++)
+        {
+            char *page = generate_indexed_true_rows(formatter, index, starts[i], 100);
+            int64_t expected_rows = starts[i] >= total ? 0 : total - starts[i] < 100 ? total - starts[i] : 100;
+            CU_ASSERT_EQUAL((int64_t)strlen(page), expected_rows * formatter->row_length);
+            CU_ASSERT(strncmp(page, true_rows + (starts[i] < total ? starts[i] : 0) * formatter->row_length, strlen(page)) == 0);
+            free(page);
+        }
+        close_true_row_index(index);
+        unlink(index_name);
+
+        // An index of another table is refused
+        int64_t other_counts[1] = {0};
+        close(mkstemp(index_name));
+        write_true_row_index(index_name, other_counts, 1, TABLE_BODY_SEGMENT_SIZE);
+        index = open_true_row_index(index_name);
+        CU_ASSERT_PTR_NULL(generate_indexed_true_rows(formatter, index, 0, 100));
+        close_true_row_index(index);
+        unlink(index_name);
+
+        free(true_rows);
+        free(segment_true_rows);
+        free_row_formatter(formatter);
+        free_parsed_expression(parsed);
+    }
+}
+
+void test_full_table_file(void)
+{
+    // Tables of one segment and of several, the last one shorter, infix and postfix
+    const char *expressions[] = {"a&(b|c)", "(a|b)&(c#d)&-(e&f&g)&(h|i|j|k|l|m|n|o|p|q)", "abcdefghijklmnopq||||||||||||||||"};
+    for (int e = 0; e < 3; e++)
+    {
+        parsed_expression *parsed = parse_expression(expressions[e]);
+        row_formatter *formatter = create_parsed_row_formatter(parsed);
+        char *header = generate_header(parsed->expression);
+        char *separator = generate_separator(parsed->expression);
+        char file_name[] = "/tmp/full_table_XXXXXX";
+        int fd = mkstemp(file_name);
+        CU_ASSERT_TRUE(write_full_table_file(formatter, header, separator, fd));
+        close(fd);
+
+        // The file holds the header, separator and every row in order, and nothing more
+        char *rows = generate_segment_with_formatter(formatter, 0, 1 << parsed->number_of_variables, false);
+        size_t expected_length = strlen(header) + strlen(separator) + strlen(rows);
+        char *expected = (char *)malloc(expected_length + 1);
+        sprintf(expected, "%s%s%s", header, separator, rows);
+        FILE *file = fopen(file_name, "r");
+        char *written = (char *)malloc(expected_length + 2);
+        size_t written_length = fread(written, 1, expected_length + 1, file);
+        fclose(file);
+        CU_ASSERT_EQUAL(written_length, expected_length);
+        CU_ASSERT(memcmp(written, expected, expected_length) == 0);
+        unlink(file_name);
+
+        free(written);
+        free(expected);
+        free(rows);
+        free(header);
+        free(separator);
+        free_row_formatter(formatter);
+        free_parsed_expression(parsed);
+    }
+}
+
+void test_true_rows_file(void)
+{
+    // Infix and postfix, with segments of no true row, and tables smaller and larger than a write
+    const char *expressions[] = {"a&(b|c)", "(a|b)&(c#d)&-(e&f&g)&(h|i|j|k|l|m|n|o|p|q)", "abcdefghijklmnopq&&&&&&&&&&&&&&&&", "abcdefghijklmnopq||||||||||||||||"};
+    for (int e = 0; e < 4; e++)
+    {
+        parsed_expression *parsed = parse_expression(expressions[e]);
+        int number_of_segments = ((1 << parsed->number_of_variables) - 1) / TABLE_BODY_SEGMENT_SIZE + 1;
+        int64_t *segment_true_rows = (int64_t *)calloc(number_of_segments, sizeof(int64_t));
+        int64_t *expected_counts = (int64_t *)calloc(number_of_segments, sizeof(int64_t));
+        char file_name[] = "/tmp/true_rows_XXXXXX";
+        int fd = mkstemp(file_name);
+        CU_ASSERT_TRUE(write_parsed_true_rows_file(parsed, fd, segment_true_rows));
+        close(fd);
+
+        // Same file and counts as the segment threads of the table body
+        char *expected;
+        size_t expected_length;
+        FILE *expected_file = open_memstream(&expected, &expected_length);
+        generate_parsed_table_body_with_counts(parsed, expected_file, expected_counts);
+        fclose(expected_file);
+        FILE *file = fopen(file_name, "r");
+        char *written = (char *)malloc(expected_length + 2);
+        size_t written_length = fread(written, 1, expected_length + 1, file);
+        fclose(file);
+        CU_ASSERT_EQUAL(written_length, expected_length);
+        CU_ASSERT(memcmp(written, expected, expected_length) == 0);
+        CU_ASSERT(memcmp(segment_true_rows, expected_counts, number_of_segments * sizeof(int64_t)) == 0);
+        unlink(file_name);
+
+        free(written);
+        free(expected);
+        free(expected_counts);
+        free(segment_true_rows);
+        free_parsed_expression(parsed);
+    }
+}
+
 // Main method to run the tests
 int main()
 {
@@ -516,6 +1897,59 @@ int main()
     CU_pSuite suite15 = CU_add_suite("Test find_nr_of_vars", 0, 0);
     CU_add_test(suite15, "Test find_nr_of_vars", test_count_unique_variables);
 
+    CU_pSuite suite16 = CU_add_suite("Test word evaluation", 0, 0);
+    CU_add_test(suite16, "Test evaluate_word", test_evaluate_word);
+
+    CU_pSuite suite17 = CU_add_suite("Test equivalence", 0, 0);
+    CU_add_test(suite17, "Test check_equivalence", test_check_equivalence);
+    CU_pSuite suite18 = CU_add_suite("Test satisfiability", 0, 0);
+    CU_add_test(suite18, "Test first true and false rows", test_first_true_and_false_rows);
+    CU_add_test(suite18, "Test generate_single_row_table", test_generate_single_row_table);
+    CU_pSuite suite19 = CU_add_suite("Test transforms", 0, 0);
+    CU_add_test(suite19, "Test mobius_transform", test_mobius_transform);
+    CU_add_test(suite19, "Test walsh_hadamard_spectrum", test_walsh_hadamard_spectrum);
+    CU_pSuite suite20 = CU_add_suite("Test jit", 0, 0);
+    CU_add_test(suite20, "Test compile_native", test_compile_native);
+    CU_add_test(suite20, "Test generate_segment_with_formatter", test_generate_segment_with_formatter);
+    CU_pSuite suite21 = CU_add_suite("Test c_emitter", 0, 0);
+    CU_add_test(suite21, "Test emit_c_kernels", test_emit_c_kernels);
+    CU_pSuite suite22 = CU_add_suite("Test expression_parser", 0, 0);
+    CU_add_test(suite22, "Test parse_expression", test_parse_expression);
+    CU_add_test(suite22, "Test large expressions", test_large_expressions);
+    CU_pSuite suite23 = CU_add_suite("Test input_formats", 0, 0);
+    CU_add_test(suite23, "Test read_dimacs_cnf", test_read_dimacs_cnf);
+    CU_add_test(suite23, "Test read_aiger", test_read_aiger);
+    CU_pSuite suite24 = CU_add_suite("Test batch", 0, 0);
+    CU_add_test(suite24, "Test read_batch_jobs and run_batch", test_batch);
+    CU_pSuite suite25 = CU_add_suite("Test multi output", 0, 0);
+    CU_add_test(suite25, "Test create_multi_row_formatter", test_multi_output);
+    CU_pSuite suite26 = CU_add_suite("Test expression_cache", 0, 0);
+    CU_add_test(suite26, "Test acquire_cached_expression", test_expression_cache);
+    CU_pSuite suite27 = CU_add_suite("Test functions", 0, 0);
+    CU_add_test(suite27, "Test NAND, NOR, MUX, MAJ and XOR", test_functions);
+    CU_pSuite suite28 = CU_add_suite("Test cofactor", 0, 0);
+    CU_add_test(suite28, "Test create_cofactor_row_formatter", test_cofactor);
+    CU_pSuite suite29 = CU_add_suite("Test sampling", 0, 0);
+    CU_add_test(suite29, "Test sample_rows and sample_true_rows", test_sampling);
+    CU_pSuite suite30 = CU_add_suite("Test quantification", 0, 0);
+    CU_add_test(suite30, "Test quantify_truth_vector", test_quantification);
+    CU_pSuite suite31 = CU_add_suite("Test truthtable library", 0, 0);
+    CU_add_test(suite31, "Test the libtruthtable API", test_truthtable_library);
+    CU_pSuite suite32 = CU_add_suite("Test http_server", 0, 0);
+    CU_add_test(suite32, "Test answer_generate_request and the event loop", test_http_server);
+
+    CU_pSuite suite33 = CU_add_suite("Test json_lines", 0, 0);
+    CU_add_test(suite33, "Test stream_json_segment", test_stream_json_segment);
+
+    CU_pSuite suite34 = CU_add_suite("Test table_formats", 0, 0);
+    CU_add_test(suite34, "Test JSON, CSV and Markdown tables", test_table_formats);
+
+    CU_pSuite suite35 = CU_add_suite("Test true_row_index", 0, 0);
+    CU_add_test(suite35, "Test true row counts and indexed pages", test_true_row_index);
+
+    CU_pSuite suite36 = CU_add_suite("Test positional table files", 0, 0);
+    CU_add_test(suite36, "Test positional writes of a full table", test_full_table_file);
+    CU_add_test(suite36, "Test two-pass writes of the true rows", test_true_rows_file);
 
     // Run all tests using CUnit Basic interface
     CU_basic_set_mode(CU_BRM_VERBOSE);
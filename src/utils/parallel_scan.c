@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../rpn_evaluator/word_evaluation.h"
+
+#include "parallel_scan.h"
+
+// Number of words a thread claims at a time (16384 rows)
+#define SCAN_BLOCK_WORDS 256
+
+/**
+ * State shared by all threads of a scan
+ */
+typedef struct
+{
+    word_scanner scanner;
+    const void *context;
+    int scratch_size;
+    uint64_t mask;
+    int64_t total_words;
+    int64_t total_blocks;
+    atomic_llong next_block;
+    atomic_llong first_row; // INT64_MAX while nothing was found
+} scan_state;
+
+static void record_row(scan_state *state, int64_t row)
+{
+    long long current = atomic_load(&state->first_row);
+    while (row < current && !atomic_compare_exchange_weak(&state->first_row, &current, row))
+    {
+    }
+}
+
+static void *scan_worker(void *arg)
+{
+    scan_state *state = (scan_state *)arg;
+    uint64_t *scratch = (uint64_t *)malloc((state->scratch_size + 1) * sizeof(uint64_t));
+    if (scratch == NULL)
+    {
+        fprintf(stderr, "Failed to allocate scratch space in %s at line %d\n", __FILE__, __LINE__);
+        exit(EXIT_FAILURE);
+    }
+
+    while (1)
+    {
+        int64_t block = atomic_fetch_add(&state->next_block, 1);
+        int64_t first_word = block * SCAN_BLOCK_WORDS;
+        // Blocks after an already found row can't hold the first match
+        if (block >= state->total_blocks || first_word * 64 >= atomic_load(&state->first_row))
+        {
+            break;
+        }
+        int64_t last_word = first_word + SCAN_BLOCK_WORDS;
+        if (last_word > state->total_words)
+        {
+            last_word = state->total_words;
+        }
+
+        for (int64_t word = first_word; word < last_word; word++)
+        {
+            // Another thread found an earlier row, the rest of this block is not needed
+            if ((word & 15) == 0 && word * 64 >= atomic_load(&state->first_row))
+            {
+                break;
+            }
+            uint64_t matches = state->scanner(state->context, word, scratch) & state->mask;
+            if (matches != 0)
+            {
+                record_row(state, word * 64 + __builtin_ctzll(matches));
+                break;
+            }
+        }
+    }
+
+    free(scratch);
+    return NULL;
+}
+
+int number_of_scan_threads(void)
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? (int)processors : 1;
+}
+
+int64_t parallel_find_first_row(int number_of_variables, word_scanner scanner, const void *context, int scratch_size)
+{
+    if (number_of_variables < 0 || number_of_variables > 26)
+    {
+        fprintf(stderr, "Invalid number of variables %d in %s at line %d\n", number_of_variables, __FILE__, __LINE__);
+        return -2;
+    }
+
+    scan_state state;
+    state.scanner = scanner;
+    state.context = context;
+    state.scratch_size = scratch_size;
+    state.mask = valid_rows_mask(number_of_variables);
+    state.total_words = number_of_words(number_of_variables);
+    state.total_blocks = (state.total_words + SCAN_BLOCK_WORDS - 1) / SCAN_BLOCK_WORDS;
+    atomic_init(&state.next_block, 0);
+    atomic_init(&state.first_row, INT64_MAX);
+
+    int num_threads = number_of_scan_threads();
+    if (num_threads > state.total_blocks)
+    {
+        num_threads = state.total_blocks; // Cap it at the total number of blocks if smaller
+    }
+
+    // Small tables are not worth starting threads for
+    if (num_threads <= 1)
+    {
+        scan_worker(&state);
+    }
+    else
+    {
+        pthread_t threads[num_threads];
+        for (int i = 0; i < num_threads; i++)
+        {
+            int rc = pthread_create(&threads[i], NULL, scan_worker, &state);
+            if (rc)
+            {
+                fprintf(stderr, "Error creating thread %d: %d\n", i, rc);
+                exit(EXIT_FAILURE);
+            }
+        }
+        for (int i = 0; i < num_threads; i++)
+        {
+            if (pthread_join(threads[i], NULL) != 0)
+            {
+                fprintf(stderr, "Failed to join thread in file %s at line %d\n", __FILE__, __LINE__);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    int64_t first_row = atomic_load(&state.first_row);
+    return first_row == INT64_MAX ? -1 : first_row;
+}
+
+/**
+ * A chunk of a parallel_for_range call handed to a thread
+ */
+typedef struct
+{
+    range_task task;
+    void *context;
+    int64_t start;
+    int64_t end;
+} range_chunk;
+
+static void *range_worker(void *arg)
+{
+    range_chunk *chunk = (range_chunk *)arg;
+    chunk->task(chunk->context, chunk->start, chunk->end);
+    return NULL;
+}
+
+void parallel_for_range(int64_t count, int64_t grain, range_task task, void *context)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    if (grain < 1)
+    {
+        grain = 1;
+    }
+
+    int64_t num_threads = number_of_scan_threads();
+    if (num_threads > count / grain)
+    {
+        num_threads = count / grain; // Don't split into chunks smaller than the grain
+    }
+    if (num_threads <= 1)
+    {
+        task(context, 0, count);
+        return;
+    }
+
+    pthread_t threads[num_threads];
+    range_chunk chunks[num_threads];
+    for (int64_t i = 0; i < num_threads; i++)
+    {
+        chunks[i].task = task;
+        chunks[i].context = context;
+        chunks[i].start = count * i / num_threads;
+        chunks[i].end = count * (i + 1) / num_threads;
+        int rc = pthread_create(&threads[i], NULL, range_worker, &chunks[i]);
+        if (rc)
+        {
+            fprintf(stderr, "Error creating thread %ld: %d\n", (long)i, rc);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int64_t i = 0; i < num_threads; i++)
+    {
+        if (pthread_join(threads[i], NULL) != 0)
+        {
+            fprintf(stderr, "Failed to join thread in file %s at line %d\n", __FILE__, __LINE__);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
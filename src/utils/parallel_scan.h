@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Function called by the scanning threads for every word of the truth table.
+ * @param context The context given to parallel_find_first_row
+ * @param word_index The index of the word, so rows [64 * word_index, 64 * word_index + 64)
+ * @param scratch Scratch space owned by the calling thread
+ * @return A word with a bit set for every row the scan is looking for
+ */
+typedef uint64_t (*word_scanner)(const void *context, int64_t word_index, uint64_t *scratch);
+
+/**
+ * Function to find the first row of a truth table matched by a scanner, splitting the table
+ * into blocks of words that are scanned by parallel threads. Threads stop claiming blocks
+ * as soon as a match is found before them, so the scan ends early when the answer is known.
+ * @param number_of_variables The number of variables of the truth table
+ * @param scanner The function marking the matching rows of a word
+ * @param context Passed to the scanner unchanged
+ * @param scratch_size The number of words of scratch space each thread needs
+ * @return The first matching row, -1 if no row matches, or -2 if the scan could not run
+ */
+int64_t parallel_find_first_row(int number_of_variables, word_scanner scanner, const void *context, int scratch_size);
+
+/**
+ * Function to get the number of scanning threads to use, one per online processor
+ * @return The number of threads
+ */
+int number_of_scan_threads(void);
+
+/**
+ * Function called by parallel_for_range for each chunk of the range
+ * @param context The context given to parallel_for_range
+ * @param start The first index of the chunk
+ * @param end The index after the last index of the chunk
+ */
+typedef void (*range_task)(void *context, int64_t start, int64_t end);
+
+/**
+ * Function to split the range [0, count) into one contiguous chunk per thread and run a task on
+ * every chunk in parallel, returning once all chunks are done.
+ * @param count The size of the range
+ * @param grain The smallest chunk worth giving to a thread, smaller ranges run on the calling thread
+ * @param task The function run on each chunk
+ * @param context Passed to the task unchanged
+ */
+void parallel_for_range(int64_t count, int64_t grain, range_task task, void *context);
@@ -1,37 +1,813 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
 
 #include "table_builders_for_webpage/table_builders.h"
-#include "converters/shunting_yard.h"
-#include "utils/find_nr_of_vars.h"
+#include "converters/expression_parser.h"
+#include "analysis/equivalence.h"
+#include "analysis/satisfiability.h"
+#include "analysis/transforms.h"
+#include "analysis/sampling.h"
+#include "converters/c_emitter.h"
+#include "converters/input_formats.h"
+#include "table_builders_for_webpage/batch.h"
+#include "table_builders_for_webpage/http_server.h"
+#include "table_builders_for_webpage/json_lines.h"
+#include "table_builders_for_webpage/table_formats.h"
+#include "table_builders_for_webpage/true_row_index.h"
+
+/**
+ * Opens the file a table is written to, exiting if it can't be opened
+ */
+static FILE *open_output_file(const char *file_name)
+{
+    FILE *file = fopen(file_name, "w");
+    if (file == NULL)
+    {
+        printf("Failed to open %s\n", file_name);
+        exit(EXIT_FAILURE);
+    }
+    return file;
+}
+
+/**
+ * Closes the file a table was written to, exiting if it couldn't be written
+ */
+static void close_output_file(FILE *file)
+{
+    if (fclose(file) != 0)
+    {
+        fprintf(stderr, "Error closing file\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Reads the <start> <end> arguments of a segment, exiting if start is outside a table with number_of_variables variables
+ */
+static void read_segment_range(char *arguments[], int number_of_variables, long *start, long *end)
+{
+    *start = strtol(arguments[0], NULL, 10);
+    *end = strtol(arguments[1], NULL, 10);
+    if (*start < 0 || *start >= 1 << number_of_variables)
+    {
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Writes the true rows of the table of a formatter to the file given as the one argument (<file_name>),
+ * or prints the segment given by two arguments (<start> <end>) with the header and separator before row 0
+ */
+static void write_formatter_output(const row_formatter *formatter, const char *header, const char *separator, int number_of_arguments, char *arguments[])
+{
+    if (number_of_arguments == 1)
+    {
+        FILE *file = open_output_file(arguments[0]);
+        generate_formatter_table_body(formatter, header, separator, file);
+        close_output_file(file);
+        return;
+    }
+    long start;
+    long end;
+    read_segment_range(arguments, formatter->number_of_variables, &start, &end);
+    char *segment = generate_segment_with_formatter(formatter, start, end, false);
+    if (segment == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    if (start == 0 && start != end)
+    {
+        printf("%s%s", header, separator);
+    }
+    printf("%s", segment);
+    free(segment);
+}
+
+/**
+ * Checks whether two expressions are equivalent, printing the first differing row otherwise
+ */
+static int run_equivalence_check(const char *first_expression, const char *second_expression)
+{
+    equivalence_result *result = check_equivalence(first_expression, second_expression);
+    if (result == NULL)
+    {
+        printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (result->equivalent)
+    {
+        printf("Equivalent\n");
+    }
+    else
+    {
+        char *counterexample = generate_counterexample(first_expression, second_expression, result);
+        if (counterexample == NULL)
+        {
+            free(result);
+            exit(EXIT_FAILURE);
+        }
+        printf("Not equivalent, first differing row %ld over variables %s\n", (long)result->first_difference, result->variables);
+        printf("%s", counterexample);
+        free(counterexample);
+    }
+    free(result);
+    return 0;
+}
+
+/**
+ * Answers --is-tautology, --is-satisfiable and --first-true, each scan stopping at the first row that settles it
+ */
+static int run_row_search(const char *mode, const char *expression)
+{
+    bool looking_for_false = strcmp(mode, "--is-tautology") == 0;
+    int64_t row = looking_for_false ? find_first_false_row(expression) : find_first_true_row(expression);
+    if (row < -1)
+    {
+        printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (strcmp(mode, "--is-satisfiable") == 0)
+    {
+        printf("%s\n", row == -1 ? "Unsatisfiable" : "Satisfiable");
+        return 0;
+    }
+    if (row == -1)
+    {
+        printf("%s\n", looking_for_false ? "Tautology" : "No true rows");
+        return 0;
+    }
+
+    char *table = generate_single_row_table(expression, row);
+    if (table == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    if (looking_for_false)
+    {
+        printf("Not a tautology, first false row %ld\n", (long)row);
+    }
+    printf("%s", table);
+    free(table);
+    return 0;
+}
+
+/**
+ * Writes the algebraic normal form (--anf) or Walsh-Hadamard spectrum (--walsh) of an expression
+ */
+static int run_transform(const char *mode, const char *expression)
+{
+    compiled_expression *compiled = compile_expression(expression, NULL);
+    if (compiled == NULL)
+    {
+        printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t *truth_vector = generate_truth_vector(compiled);
+    if (truth_vector == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    if (strcmp(mode, "--anf") == 0)
+    {
+        mobius_transform(truth_vector, compiled->number_of_variables);
+        write_algebraic_normal_form(stdout, truth_vector, compiled->variables);
+    }
+    else
+    {
+        int32_t *spectrum = walsh_hadamard_spectrum(truth_vector, compiled->number_of_variables);
+        if (spectrum == NULL)
+        {
+            exit(EXIT_FAILURE);
+        }
+        write_walsh_spectrum(stdout, spectrum, compiled->variables);
+        free(spectrum);
+    }
+    free(truth_vector);
+    free_compiled_expression(compiled);
+    return 0;
+}
+
+/**
+ * Writes the true rows (--cnf|--aiger <input> <file_name>) or prints a segment (--cnf|--aiger <input> <start> <end>)
+ * of the table of a DIMACS CNF formula or AIGER graph, compiled without going through an expression string
+ */
+static int run_input_format(const char *mode, const char *input_name, int argc, char *argv[])
+{
+    FILE *input = fopen(input_name, "rb");
+    if (input == NULL)
+    {
+        printf("Failed to open %s\n", input_name);
+        exit(EXIT_FAILURE);
+    }
+    compiled_expression *compiled = strcmp(mode, "--cnf") == 0 ? read_dimacs_cnf(input) : read_aiger(input);
+    fclose(input);
+    if (compiled == NULL)
+    {
+        printf("%s is not a valid %s file\n", input_name, strcmp(mode, "--cnf") == 0 ? "DIMACS CNF" : "AIGER");
+        exit(EXIT_FAILURE);
+    }
+
+    char *header = generate_compiled_header(compiled, input_name);
+    char *separator = generate_compiled_separator(compiled, input_name);
+    row_formatter *formatter = create_compiled_row_formatter(compiled, input_name);
+    if (formatter == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    write_formatter_output(formatter, header, separator, argc - 3, argv + 3);
+    free(header);
+    free(separator);
+    free_row_formatter(formatter);
+    return 0;
+}
+
+/**
+ * Runs every expression of a batch file (--batch <batch_file> [output_directory]) with one shared pool of threads,
+ * printing the tagged outputs in order or writing one file per expression to the directory
+ */
+static int run_batch_file(const char *batch_name, const char *output_directory)
+{
+    FILE *batch_file = fopen(batch_name, "r");
+    if (batch_file == NULL)
+    {
+        printf("Failed to open %s\n", batch_name);
+        exit(EXIT_FAILURE);
+    }
+    int number_of_jobs;
+    batch_job *jobs = read_batch_jobs(batch_file, &number_of_jobs);
+    fclose(batch_file);
+    if (jobs == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    int status = run_batch(jobs, number_of_jobs, stdout, output_directory);
+    free_batch_jobs(jobs, number_of_jobs);
+    return status;
+}
+
+/**
+ * Writes the rows where any expression is true (--multi <file_name> <expression>...) or prints a segment
+ * (--multi-segment <start> <end> <expression>...) of one table with a result column per expression
+ */
+static int run_multi_output(int argc, char *argv[])
+{
+    bool segment_mode = strcmp(argv[1], "--multi-segment") == 0;
+    int first_expression = segment_mode ? 4 : 3;
+    int number_of_expressions = argc - first_expression;
+    parsed_expression *parsed[number_of_expressions];
+    for (int j = 0; j < number_of_expressions; j++)
+    {
+        parsed[j] = parse_expression(argv[first_expression + j]);
+        if (parsed[j] == NULL)
+        {
+            printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    row_formatter *formatter = create_multi_row_formatter(parsed, number_of_expressions);
+    if (formatter == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    char *header = generate_multi_header(parsed, number_of_expressions);
+    char *separator = generate_multi_separator(parsed, number_of_expressions);
+
+    write_formatter_output(formatter, header, separator, segment_mode ? 2 : 1, argv + 2);
+    free(header);
+    free(separator);
+    free_row_formatter(formatter);
+    for (int j = 0; j < number_of_expressions; j++)
+    {
+        free_parsed_expression(parsed[j]);
+    }
+    return 0;
+}
+
+/**
+ * Writes the true rows (--fix <assignment> <expression> <file_name>) or prints a segment
+ * (--fix <assignment> <expression> <start> <end>) of the sub-table where some variables are fixed, such as a=1,c=0
+ */
+static int run_cofactor(int argc, char *argv[])
+{
+    partial_assignment fixed;
+    if (!parse_partial_assignment(argv[2], &fixed))
+    {
+        printf("Fixed variables must be given as a=1,c=0\n");
+        exit(EXIT_FAILURE);
+    }
+    parsed_expression *parsed = parse_expression(argv[3]);
+    if (parsed == NULL)
+    {
+        printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+
+    row_formatter *formatter = create_cofactor_row_formatter(parsed, &fixed);
+    if (formatter == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    // The header of the full table, with the fixed variables still in their columns
+    char *header = generate_header(parsed->expression);
+    char *separator = generate_separator(parsed->expression);
+    write_formatter_output(formatter, header, separator, argc - 4, argv + 4);
+    free(header);
+    free(separator);
+    free_row_formatter(formatter);
+    free_parsed_expression(parsed);
+    return 0;
+}
+
+/**
+ * Writes the table of an expression as JSON, CSV or Markdown rather than text,
+ * --format <format> <expression> <file_name> for the true rows, or <start> <end> for a segment
+ */
+static int run_format(int argc, char *argv[])
+{
+    table_format format;
+    if (!parse_table_format(argv[2], &format))
+    {
+        printf("Formats are text, json, csv and markdown\n");
+        exit(EXIT_FAILURE);
+    }
+    parsed_expression *parsed = parse_expression(argv[3]);
+    if (parsed == NULL)
+    {
+        printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+    formatted_table *table = create_formatted_table(parsed, format);
+    if (table == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    if (argc == 5)
+    {
+        FILE *file = open_output_file(argv[4]);
+        generate_formatted_table_body(table, file);
+        close_output_file(file);
+    }
+    else
+    {
+        long start;
+        long end;
+        read_segment_range(argv + 4, parsed->number_of_variables, &start, &end);
+        char *segment = generate_formatted_segment(table, start, end, false);
+        if (segment == NULL)
+        {
+            exit(EXIT_FAILURE);
+        }
+        printf("%s", segment);
+        free(segment);
+    }
+    free_formatted_table(table);
+    free_parsed_expression(parsed);
+    return 0;
+}
+
+/**
+ * Writes the true rows file of an expression and the index of its true rows,
+ * --true-rows <expression> <file_name> <index_file>
+ */
+static int run_indexed_true_rows(const char *expression, const char *file_name, const char *index_name)
+{
+    int fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        printf("Failed to open %s\n", file_name);
+        exit(EXIT_FAILURE);
+    }
+    parsed_expression *parsed = parse_expression(expression);
+    if (parsed == NULL)
+    {
+        dprintf(fd, "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+    int number_of_segments = ((1 << parsed->number_of_variables) - 1) / TABLE_BODY_SEGMENT_SIZE + 1;
+    int64_t *segment_true_rows = (int64_t *)calloc(number_of_segments, sizeof(int64_t));
+    if (segment_true_rows == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed in file %s at line %d\n", __FILE__, __LINE__);
+        exit(EXIT_FAILURE);
+    }
+    // The counts of the first pass of the file are the index
+    bool written = write_parsed_true_rows_file(parsed, fd, segment_true_rows);
+    if (close(fd) != 0 || !written || !write_true_row_index(index_name, segment_true_rows, number_of_segments, TABLE_BODY_SEGMENT_SIZE))
+    {
+        fprintf(stderr, "Error closing file\n");
+        exit(EXIT_FAILURE);
+    }
+    free(segment_true_rows);
+    free_parsed_expression(parsed);
+    return 0;
+}
+
+/**
+ * Writes every row of the table of an expression to a file, each thread writing its segments at their
+ * own offset (--full <expression> <file_name>)
+ */
+static int run_full_table(const char *expression, const char *file_name)
+{
+    int fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        printf("Failed to open %s\n", file_name);
+        exit(EXIT_FAILURE);
+    }
+    parsed_expression *parsed = parse_expression(expression);
+    row_formatter *formatter = parsed == NULL ? NULL : create_parsed_row_formatter(parsed);
+    if (formatter == NULL)
+    {
+        dprintf(fd, "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+    char *header = generate_header(parsed->expression);
+    char *separator = generate_separator(parsed->expression);
+    bool written = write_full_table_file(formatter, header, separator, fd);
+    if (close(fd) != 0 || !written)
+    {
+        fprintf(stderr, "Error writing file\n");
+        exit(EXIT_FAILURE);
+    }
+    free(header);
+    free(separator);
+    free_row_formatter(formatter);
+    free_parsed_expression(parsed);
+    return 0;
+}
+
+/**
+ * Prints the lines [start, start + count) of the true rows file of an expression, header and separator
+ * included, generating only the segments holding them (--true-page <expression> <index_file> <start> <count>)
+ */
+static int run_true_page(const char *expression, const char *index_name, long start, long count)
+{
+    parsed_expression *parsed = parse_expression(expression);
+    if (parsed == NULL)
+    {
+        // The lines of the file written for an invalid expression
+        const char *lines[] = {"Variables must be a-z lowercase.\n", "Operators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n"};
+        for (long line = start < 0 ? 0 : start; line < 2 && line < start + count; line++)
+        {
+            printf("%s", lines[line]);
+        }
+        return 0;
+    }
+    row_formatter *formatter = create_parsed_row_formatter(parsed);
+    true_row_index *index = formatter == NULL ? NULL : open_true_row_index(index_name);
+    if (index == NULL || start < 0)
+    {
+        exit(EXIT_FAILURE);
+    }
+    if (start < 2 && count > 0)
+    {
+        char *header = generate_header(expression);
+        char *separator = generate_separator(expression);
+        printf("%s", start == 0 ? header : "");
+        printf("%s", count > 1 - start ? separator : "");
+        free(header);
+        free(separator);
+    }
+    long first_true_row = start < 2 ? 0 : start - 2;
+    long true_rows = count - (first_true_row + 2 - start);
+    char *rows = generate_indexed_true_rows(formatter, index, first_true_row, true_rows < INT32_MAX ? true_rows : INT32_MAX);
+    if (rows == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    printf("%s", rows);
+    free(rows);
+    close_true_row_index(index);
+    free_row_formatter(formatter);
+    free_parsed_expression(parsed);
+    return 0;
+}
+
+/**
+ * Prints uniformly random rows (--sample) or true rows (--sample-true) of the table of an expression,
+ * --sample[-true] <count> <expression> [seed], without generating the rest of the table
+ */
+static int run_sampling(int argc, char *argv[])
+{
+    bool only_true = strcmp(argv[1], "--sample-true") == 0;
+    long number_of_samples = strtol(argv[2], NULL, 10);
+    if (number_of_samples < 0 || number_of_samples > 1 << 24)
+    {
+        printf("The number of samples must be between 0 and %d\n", 1 << 24);
+        exit(EXIT_FAILURE);
+    }
+    uint64_t seed = argc == 5 ? strtoull(argv[4], NULL, 10) : (uint64_t)time(NULL) * 1000003 + getpid();
+    parsed_expression *parsed = parse_expression(argv[3]);
+    row_formatter *formatter = parsed == NULL ? NULL : create_parsed_row_formatter(parsed);
+    if (formatter == NULL)
+    {
+        printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int64_t number_of_true_rows = 0;
+    int64_t *rows = only_true ? sample_true_rows(formatter->compiled, number_of_samples, seed, &number_of_true_rows)
+                              : sample_rows(formatter->number_of_variables, number_of_samples, seed);
+    if (rows == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    if (only_true && number_of_true_rows == 0)
+    {
+        printf("No true rows\n");
+    }
+    else
+    {
+        char *header = generate_header(parsed->expression);
+        char *separator = generate_separator(parsed->expression);
+        printf("%s%s", header, separator);
+        for (long i = 0; i < number_of_samples; i++)
+        {
+            char *row = generate_segment_with_formatter(formatter, rows[i], rows[i] + 1, false);
+            if (row == NULL)
+            {
+                exit(EXIT_FAILURE);
+            }
+            printf("%s", row);
+            free(row);
+        }
+        free(header);
+        free(separator);
+    }
+    free(rows);
+    free_row_formatter(formatter);
+    free_parsed_expression(parsed);
+    return 0;
+}
+
+/**
+ * Writes the true rows (--exists|--forall <variables> <expression> <file_name>) or prints a segment
+ * (--exists|--forall <variables> <expression> <start> <end>) of the table of an expression with variables such as b,c
+ * quantified away, computed on its truth vector
+ */
+static int run_quantification(int argc, char *argv[])
+{
+    bool universal = strcmp(argv[1], "--forall") == 0;
+    char quantified[27] = "";
+    int number_quantified = 0;
+    for (int i = 0; argv[2][i] != '\0'; i += argv[2][i + 1] == ',' && argv[2][i + 2] != '\0' ? 2 : 1)
+    {
+        if (!islower(argv[2][i]) || strchr(quantified, argv[2][i]) != NULL || (argv[2][i + 1] != ',' && argv[2][i + 1] != '\0'))
+        {
+            printf("Quantified variables must be given as b,c\n");
+            exit(EXIT_FAILURE);
+        }
+        quantified[number_quantified++] = argv[2][i];
+    }
+    compiled_expression *compiled = compile_expression(argv[3], NULL);
+    if (compiled == NULL)
+    {
+        printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t *truth_vector = generate_truth_vector(compiled);
+    if (truth_vector == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    char remaining_variables[27];
+    uint64_t *quantified_vector = quantify_truth_vector(truth_vector, compiled->variables, quantified, universal, remaining_variables);
+    free(truth_vector);
+    free_compiled_expression(compiled);
+    if (quantified_vector == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    size_t label_length = strlen(argv[2]) + strlen(argv[3]) + 10;
+    char label[label_length];
+    snprintf(label, label_length, "%s %s: %s", universal ? "forall" : "exists", argv[2], argv[3]);
+    row_formatter *formatter = create_truth_vector_row_formatter(quantified_vector, remaining_variables, label);
+    if (formatter == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    char *header = generate_compiled_header(formatter->compiled, label);
+    char *separator = generate_compiled_separator(formatter->compiled, label);
+
+    write_formatter_output(formatter, header, separator, argc - 4, argv + 4);
+    free(header);
+    free(separator);
+    free_row_formatter(formatter);
+    return 0;
+}
+
+/**
+ * Streams the JSON array of the lines of a segment in frames (--stream <expression> <start> <end>),
+ * for server.py to forward as they are generated
+ */
+static int run_stream(const char *expression, const char *start, const char *end)
+{
+    parsed_expression *parsed = parse_expression(expression);
+    row_formatter *formatter = parsed == NULL ? NULL : create_parsed_row_formatter(parsed);
+    char *header = formatter == NULL ? NULL : generate_header(expression);
+    char *separator = formatter == NULL ? NULL : generate_separator(expression);
+    stream_json_segment(formatter, header, separator, strtol(start, NULL, 10), strtol(end, NULL, 10), stdout);
+    free(header);
+    free(separator);
+    free_row_formatter(formatter);
+    free_parsed_expression(parsed);
+    return 0;
+}
+
+// Server stopped by SIGINT and SIGTERM
+static http_server *running_server = NULL;
+
+static void stop_running_server(int signal_number)
+{
+    (void)signal_number;
+    if (running_server != NULL)
+    {
+        stop_http_server(running_server);
+    }
+}
+
+/**
+ * Serves the /generate API of server.py over HTTP (--serve <port>) until interrupted
+ */
+static int run_server(const char *port)
+{
+    running_server = create_http_server(strtol(port, NULL, 10));
+    if (running_server == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop_running_server;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    printf("Serving /generate on port %d\n", http_server_port(running_server));
+    fflush(stdout);
+    int status = run_http_server(running_server);
+    free_http_server(running_server);
+    running_server = NULL;
+    return status;
+}
 
 int main(int argc, char *argv[])
 {
+    // Case where binary is being called to build one table for several expressions
+    if ((argc >= 4 && strcmp(argv[1], "--multi") == 0) || (argc >= 5 && strcmp(argv[1], "--multi-segment") == 0))
+    {
+        return run_multi_output(argc, argv);
+    }
 
-    if (argc > 4)
+    // Case where binary is being called for a segment streamed to the website as it is generated
+    if (argc == 5 && strcmp(argv[1], "--stream") == 0)
     {
-        printf("Usage: %s <expression> <file_name> for writing to a file\nvalid variables: a-z\nvalid operators: not −; or |; and &; xor #; implication >; equivalence =; brackets for infix ();\n", argv[0]);
+        return run_stream(argv[2], argv[3], argv[4]);
+    }
+
+    // Case where binary is being called to answer the website's requests itself
+    if (argc == 3 && strcmp(argv[1], "--serve") == 0)
+    {
+        return run_server(argv[2]);
+    }
+
+    // Case where binary is being called for the table of an expression with variables quantified away
+    if ((argc == 5 || argc == 6) && (strcmp(argv[1], "--exists") == 0 || strcmp(argv[1], "--forall") == 0))
+    {
+        return run_quantification(argc, argv);
+    }
+
+    // Case where binary is being called for random rows of a table
+    if ((argc == 4 || argc == 5) && (strcmp(argv[1], "--sample") == 0 || strcmp(argv[1], "--sample-true") == 0))
+    {
+        return run_sampling(argc, argv);
+    }
+
+    // Case where binary is being called for a true rows file that pages can be found in without reading it
+    if (argc == 5 && strcmp(argv[1], "--true-rows") == 0)
+    {
+        return run_indexed_true_rows(argv[2], argv[3], argv[4]);
+    }
+
+    // Case where binary is being called for every row of a table, written in parallel to a file
+    if (argc == 4 && strcmp(argv[1], "--full") == 0)
+    {
+        return run_full_table(argv[2], argv[3]);
+    }
+
+    // Case where binary is being called for a page of true rows, with the index of a true rows file
+    if (argc == 6 && strcmp(argv[1], "--true-page") == 0)
+    {
+        return run_true_page(argv[2], argv[3], strtol(argv[4], NULL, 10), strtol(argv[5], NULL, 10));
+    }
+
+    // Case where binary is being called for a table in another output format
+    if ((argc == 5 || argc == 6) && strcmp(argv[1], "--format") == 0)
+    {
+        return run_format(argc, argv);
+    }
+
+    // Case where binary is being called for the sub-table of some variables fixed to a value
+    if ((argc == 5 || argc == 6) && strcmp(argv[1], "--fix") == 0)
+    {
+        return run_cofactor(argc, argv);
+    }
+
+    // Case where binary is being called with many expressions at once
+    if ((argc == 3 || argc == 4) && strcmp(argv[1], "--batch") == 0)
+    {
+        return run_batch_file(argv[2], argc == 4 ? argv[3] : NULL);
+    }
+
+    // Case where binary is being called with a formula or graph from another tool
+    if ((argc == 4 || argc == 5) && (strcmp(argv[1], "--cnf") == 0 || strcmp(argv[1], "--aiger") == 0))
+    {
+        return run_input_format(argv[1], argv[2], argc, argv);
+    }
+
+    if (argc > 4 || argc < 3)
+    {
+        printf("Usage: %s <expression> <file_name> for writing to a file\nvalid variables: a-z\nvalid operators: not −; or |; and &; xor #; implication >; equivalence =; brackets for infix ();\nvalid functions: NAND(a,b); NOR(a,b); MUX(s,a,b); MAJ(a,b,c); XOR(a,b,...), tokens N O M V X in postfix\n", argv[0]);
         printf("For generating segments, use %s <expression> <start> <end>\n", argv[0]);
+        printf("For checking two expressions are equivalent, use %s --equivalent <expression> <expression>\n", argv[0]);
+        printf("For finding the first false or true row, use %s --is-tautology|--is-satisfiable|--first-true <expression>\n", argv[0]);
+        printf("For the algebraic normal form or Walsh spectrum, use %s --anf|--walsh <expression>\n", argv[0]);
+        printf("For a C file with kernels specialised to an expression, use %s --emit-c <expression> [prefix]\n", argv[0]);
+        printf("For DIMACS CNF or AIGER input, use %s --cnf|--aiger <input_file> <file_name> or <start> <end>\n", argv[0]);
+        printf("For one table with a result column per expression, use %s --multi <file_name> <expression>... or --multi-segment <start> <end> <expression>...\n", argv[0]);
+        printf("For a segment as a JSON array of lines streamed in frames, use %s --stream <expression> <start> <end>\n", argv[0]);
+        printf("For serving /generate?expression=&start=&end=&mode= over HTTP, use %s --serve <port>\n", argv[0]);
+        printf("For quantifying variables away, use %s --exists|--forall <b,c> <expression> <file_name> or <start> <end>\n", argv[0]);
+        printf("For uniformly random rows or true rows, use %s --sample|--sample-true <count> <expression> [seed]\n", argv[0]);
+        printf("For the sub-table with some variables fixed, use %s --fix <a=1,c=0> <expression> <file_name> or <start> <end>\n", argv[0]);
+        printf("For JSON, CSV or Markdown tables, use %s --format <text|json|csv|markdown> <expression> <file_name> or <start> <end>\n", argv[0]);
+        printf("For a true rows file and the index of its true rows, use %s --true-rows <expression> <file_name> <index_file>\n", argv[0]);
+        printf("For the lines [start, start + count) of that file from its index alone, use %s --true-page <expression> <index_file> <start> <count>\n", argv[0]);
+        printf("For every row of a table, not only the true ones, written by parallel threads, use %s --full <expression> <file_name>\n", argv[0]);
+        printf("For many expressions at once, use %s --batch <batch_file> [output_directory], with lines segment <start> <end> <expression> or true <expression>\n", argv[0]);
         return 1; // Exit with an error code
     }
+
+    // Case where binary is being called to compare two expressions
+    if (argc == 4 && strcmp(argv[1], "--equivalent") == 0)
+    {
+        return run_equivalence_check(argv[2], argv[3]);
+    }
+
+    // Case where binary is being called to answer a question about a single expression
+    if (argc == 3 && (strcmp(argv[1], "--is-tautology") == 0 || strcmp(argv[1], "--is-satisfiable") == 0 ||
+                      strcmp(argv[1], "--first-true") == 0))
+    {
+        return run_row_search(argv[1], argv[2]);
+    }
+
+    // Case where binary is being called to transform the truth vector of an expression
+    if (argc == 3 && (strcmp(argv[1], "--anf") == 0 || strcmp(argv[1], "--walsh") == 0))
+    {
+        return run_transform(argv[1], argv[2]);
+    }
+
+    // Case where binary is being called to write specialised C code for an expression
+    if (strcmp(argv[1], "--emit-c") == 0)
+    {
+        if (!emit_c_kernels(stdout, argv[2], argc == 4 ? argv[3] : "expression"))
+        {
+            printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+            exit(EXIT_FAILURE);
+        }
+        return 0;
+    }
+
     const char *expression = argv[1];
 
+    // Validated, converted and scanned for variables once, for whichever table is generated
+    parsed_expression *parsed = parse_expression(expression);
+
     // Case where binary is being called to generate a full table
     if (argc == 3)
     {
 
         char *file_name = argv[2];
-        FILE *file = fopen(file_name, "w");
-        if (is_valid_infix(expression))
-        {
-            generate_infix_table_body(expression, file);
-        }
-        else
+        int fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (parsed == NULL)
         {
-            generate_postfix_table_body(expression, file);
+            dprintf(fd, "Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+            exit(EXIT_FAILURE);
         }
-        if (fclose(file) != 0)
+        // Counted first, then written by every thread at once at the offsets the counts give
+        bool written = write_parsed_true_rows_file(parsed, fd, NULL);
+        if (close(fd) != 0 || !written)
         {
             fprintf(stderr,"Error closing file\n");
             exit(EXIT_FAILURE);
@@ -42,53 +818,29 @@ int main(int argc, char *argv[])
         long start = strtol(argv[2], NULL, 10);
         long end = strtol(argv[3], NULL, 10);
 
-        if (start >= 1 << count_unique_variables(expression))
+        if (parsed != NULL && start >= 1 << parsed->number_of_variables)
         {
             exit(EXIT_FAILURE);
         }
-        if (is_valid_infix(expression))
+        char *segment = (parsed == NULL || start < 0) ? NULL : generate_parsed_segment(parsed, start, end, false);
+        if (segment == NULL)
         {
-            char *header = generate_header(expression);
-            char *separator = generate_separator(expression);
-            char *segment = generate_infix_truth_table_segment(expression, start, end);
-
-            if (segment == NULL)
-            {
-                printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
-                exit(EXIT_FAILURE);
-            }
-
-            if (start == 0 && start != end)
-            {
-                printf("%s", header);
-                printf("%s", separator);
-                free(header);
-                free(separator);
-            }
-
-            printf("%s", segment);
-            free(segment);
+            printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
+            exit(EXIT_FAILURE);
         }
-        else
+
+        if (start == 0 && start != end)
         {
             char *header = generate_header(expression);
             char *separator = generate_separator(expression);
-            char *segment = generate_postfix_truth_table_segment(expression, start, end);
-            if (segment == NULL)
-            {
-                printf("Variables must be a-z lowercase.\nOperators are | OR; & AND; # XOR; > IMPLICATION; = IFF; - NOT\n");
-                exit(EXIT_FAILURE);
-            }
-            if (start == 0 && start != end)
-            {
-                printf("%s", header);
-                printf("%s", separator);
-                free(header);
-                free(separator);
-            }
-            printf("%s", segment);
-            free(segment);
+            printf("%s", header);
+            printf("%s", separator);
+            free(header);
+            free(separator);
         }
+        printf("%s", segment);
+        free(segment);
     }
+    free_parsed_expression(parsed);
     return 0;
 }
\ No newline at end of file
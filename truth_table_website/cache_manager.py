@@ -0,0 +1,184 @@
+import hashlib
+import os
+import threading
+import time
+import uuid
+from collections import OrderedDict
+
+
+# On-disk cache of the files written by website_binary_ttable, bounded in bytes.
+# Entries are evicted least recently used first once the budget is exceeded, and
+# once they have not been read for ttl seconds. Files are written under a temporary
+# name and renamed into place, so a reader never sees a partly written file.
+class CacheManager:
+    def __init__(self, directory, max_bytes, ttl, cleanup_interval=60):
+        self.directory = directory
+        self.max_bytes = max_bytes
+        self.ttl = ttl
+        self.lock = threading.Lock()
+        self.entries = OrderedDict()  # file name -> [size, last access], least recently used first
+        self.sessions = {}  # session id -> file names the session read
+        self.total_bytes = 0
+        self.hits = 0
+        self.misses = 0
+        self.populations = 0
+        self.evictions = {'budget': 0, 'ttl': 0, 'cleared': 0}
+        os.makedirs(directory, exist_ok=True)
+        self._index_existing_files()
+        self.stopped = threading.Event()
+        self.cleaner = threading.Thread(target=self._clean_periodically, args=(cleanup_interval,), daemon=True)
+        self.cleaner.start()
+
+    # Function to get the file name of a key, keys being any string such as an expression
+    def file_name(self, key):
+        return hashlib.sha256(key.encode()).hexdigest()[:32] + '.cache'
+
+    # Function to open the cached file of a key in binary mode, None if it isn't cached
+    def open(self, key, session_id=None):
+        name = self.file_name(key)
+        with self.lock:
+            entry = self.entries.get(name)
+            if entry is None:
+                self.misses += 1
+                return None
+            try:
+                # Opened under the lock, so an eviction can't remove the file in between
+                file = open(os.path.join(self.directory, name), 'rb')
+            except OSError:
+                self._remove(name)
+                self.misses += 1
+                return None
+            self.hits += 1
+            entry[1] = time.monotonic()
+            self.entries.move_to_end(name)
+            self._bind(session_id, name)
+            return file
+
+    # Function to check whether a key is cached, without counting a lookup or refreshing its entry
+    def contains(self, key):
+        with self.lock:
+            return self.file_name(key) in self.entries
+
+    # Function to cache the file of a key, written by write(path) to a temporary path,
+    # then open it. Other entries are evicted to fit the budget.
+    def populate(self, key, write, session_id=None):
+        file = self.create(key)
+        file.close()
+        try:
+            write(file.name)
+            return self.commit(key, file, session_id)
+        finally:
+            self.discard(file)
+
+    # Function to open a temporary file in binary mode for the file of a key to be written to as it
+    # is generated, cached by commit, or removed by discard if it can't be completed
+    def create(self, key):
+        return open(os.path.join(self.directory, f'{self.file_name(key)}.{uuid.uuid4().hex}.tmp'), 'wb')
+
+    # Function to cache a file from create once it is complete, then open it like populate
+    def commit(self, key, file, session_id=None):
+        file.close()
+        name = self.file_name(key)
+        path = os.path.join(self.directory, name)
+        size = os.path.getsize(file.name)
+        with self.lock:
+            os.replace(file.name, path)
+            if name in self.entries:
+                self.total_bytes -= self.entries[name][0]
+            self.entries[name] = [size, time.monotonic()]
+            self.entries.move_to_end(name)
+            self.total_bytes += size
+            self.populations += 1
+            cached = open(path, 'rb')
+            self._bind(session_id, name)
+            self._evict_to_budget(keep=name)
+            return cached
+
+    # Function to remove a file from create that wasn't committed
+    def discard(self, file):
+        file.close()
+        if os.path.exists(file.name):
+            os.remove(file.name)
+
+    # Function to drop the entries a session read, unless another session read them too
+    def release_session(self, session_id):
+        with self.lock:
+            names = self.sessions.pop(session_id, None)
+            if names is None:
+                return False
+            held = set().union(*self.sessions.values())
+            for name in names - held:
+                if name in self.entries:
+                    self._remove(name)
+                    self.evictions['cleared'] += 1
+            return True
+
+    # Function to get the hit rate and occupancy of the cache
+    def metrics(self):
+        with self.lock:
+            lookups = self.hits + self.misses
+            return {
+                'entries': len(self.entries),
+                'bytes': self.total_bytes,
+                'max_bytes': self.max_bytes,
+                'occupancy': self.total_bytes / self.max_bytes if self.max_bytes else 0,
+                'hits': self.hits,
+                'misses': self.misses,
+                'hit_rate': self.hits / lookups if lookups else 0,
+                'populations': self.populations,
+                'evictions': dict(self.evictions),
+                'sessions': len(self.sessions),
+            }
+
+    # Function to evict the expired entries and the ones over the budget
+    def clean(self):
+        with self.lock:
+            deadline = time.monotonic() - self.ttl
+            for name in [name for name, (size, last_access) in self.entries.items() if last_access < deadline]:
+                self._remove(name)
+                self.evictions['ttl'] += 1
+            self._evict_to_budget()
+            # Sessions that only read evicted entries are forgotten
+            self.sessions = {session_id: names & self.entries.keys()
+                             for session_id, names in self.sessions.items() if names & self.entries.keys()}
+
+    # Function to stop the background cleanup
+    def stop(self):
+        self.stopped.set()
+
+    def _clean_periodically(self, interval):
+        while not self.stopped.wait(interval):
+            self.clean()
+
+    # Files left by a previous run are indexed as just used, the temporary ones removed
+    def _index_existing_files(self):
+        now = time.monotonic()
+        for name in sorted(os.listdir(self.directory)):
+            path = os.path.join(self.directory, name)
+            if name.endswith('.cache'):
+                size = os.path.getsize(path)
+                self.entries[name] = [size, now]
+                self.total_bytes += size
+            else:
+                os.remove(path)
+
+    def _bind(self, session_id, name):
+        if session_id is not None:
+            self.sessions.setdefault(session_id, set()).add(name)
+
+    def _evict_to_budget(self, keep=None):
+        for name in list(self.entries):
+            if self.total_bytes <= self.max_bytes:
+                break
+            if name != keep:
+                self._remove(name)
+                self.evictions['budget'] += 1
+
+    def _remove(self, name):
+        size, _ = self.entries.pop(name)
+        self.total_bytes -= size
+        try:
+            # Readers that already opened the file keep reading it
+            os.remove(os.path.join(self.directory, name))
+        except FileNotFoundError:
+            pass
@@ -0,0 +1,162 @@
+import threading
+import weakref
+from concurrent.futures import ThreadPoolExecutor
+
+
+# Raised when a job can't be admitted because the queue of jobs waiting for a worker is full
+class JobRejected(Exception):
+    pass
+
+
+# A job in flight, with the window of items it produced that its followers haven't all read yet
+# and its result once done
+class Job:
+    def __init__(self):
+        self.condition = threading.Condition()
+        self.items = []
+        self.first = 0  # Number of items produced before items[0]
+        self.positions = {}  # follower -> number of items it has read
+        self.done = False
+        self.result = None
+        self.error = None
+
+
+# Runs the generation jobs on a bounded pool of workers. Requests for a key that already has a
+# job in flight wait for that job instead of starting another one, so a burst of identical
+# requests costs a single run. Jobs of new keys are rejected once max_queued of them wait for a worker.
+# Streamed jobs hold at most window items, the ones some follower hasn't read yet.
+class JobCoordinator:
+    def __init__(self, max_workers, max_queued, window):
+        self.executor = ThreadPoolExecutor(max_workers=max_workers, thread_name_prefix='job')
+        self.max_workers = max_workers
+        self.max_queued = max_queued
+        self.window = window
+        self.lock = threading.Lock()
+        self.jobs = {}  # key -> job in flight
+        self.queued = 0
+        self.running = 0
+        self.submitted = 0
+        self.merged = 0
+        self.rejected = 0
+
+    # Function to get the result of compute(), computed once for every caller of the same key meanwhile
+    def run(self, key, compute):
+        job = self._submit(key, lambda job: compute(), None)
+        with job.condition:
+            job.condition.wait_for(lambda: job.done)
+        if job.error is not None:
+            raise job.error
+        return job.result
+
+    # Function to iterate over the items of produce(), produced once for every caller of the same key
+    # meanwhile. Callers join a job as long as it still holds its first item, later ones restart
+    # produce() in a job of their own. Once window items are held, produce() waits for the slowest follower.
+    def stream(self, key, produce):
+        follower = object()
+        job = self._submit(key, lambda job: self._publish(job, produce()), follower)
+        items = self._follow(job, follower)
+        # Followers dropped without being read to the end, or even started, don't hold the job back
+        weakref.finalize(items, self._detach, job, follower)
+        return items
+
+    # Function to check whether a job submitted now would start right away
+    def has_idle_worker(self):
+        with self.lock:
+            return self.running + self.queued < self.max_workers
+
+    # Function to get the load of the workers and how many requests were merged or rejected
+    def metrics(self):
+        with self.lock:
+            return {
+                'workers': self.max_workers,
+                'running': self.running,
+                'queued': self.queued,
+                'max_queued': self.max_queued,
+                'submitted': self.submitted,
+                'merged': self.merged,
+                'rejected': self.rejected,
+            }
+
+    # Function to stop the workers once the jobs already admitted are done
+    def stop(self):
+        self.executor.shutdown(wait=False)
+
+    def _submit(self, key, work, follower):
+        with self.lock:
+            job = self.jobs.get(key)
+            if job is not None and self._attach(job, follower):
+                self.merged += 1
+                return job
+            if self.queued >= self.max_queued:
+                self.rejected += 1
+                raise JobRejected(f'{self.queued} jobs are already waiting for a worker')
+            job = self.jobs[key] = Job()
+            self._attach(job, follower)
+            self.queued += 1
+            self.submitted += 1
+        self.executor.submit(self._execute, key, job, work)
+        return job
+
+    def _execute(self, key, job, work):
+        with self.lock:
+            self.queued -= 1
+            self.running += 1
+        try:
+            result, error = work(job), None
+        except Exception as e:
+            result, error = None, e
+        with self.lock:
+            self.running -= 1
+            # Requests from now on start a new job, seeing what this one wrote to the cache
+            if self.jobs.get(key) is job:
+                del self.jobs[key]
+        with job.condition:
+            job.result, job.error, job.done = result, error, True
+            job.condition.notify_all()
+
+    # Function to add a follower to a job, which it can only join while the job holds its first item
+    def _attach(self, job, follower):
+        if follower is None:
+            return True
+        with job.condition:
+            if job.first > 0:
+                return False
+            job.positions[follower] = 0
+            return True
+
+    def _detach(self, job, follower):
+        with job.condition:
+            job.positions.pop(follower, None)
+            self._trim(job)
+
+    # Function to drop the items every follower has read, all of them once no follower is left
+    def _trim(self, job):
+        read = min(job.positions.values(), default=job.first + len(job.items))
+        del job.items[:read - job.first]
+        job.first = read
+        job.condition.notify_all()
+
+    def _publish(self, job, items):
+        for item in items:
+            with job.condition:
+                job.condition.wait_for(lambda: len(job.items) < self.window)
+                job.items.append(item)
+                self._trim(job)
+
+    def _follow(self, job, follower):
+        try:
+            position = 0
+            while True:
+                with job.condition:
+                    job.condition.wait_for(lambda: position < job.first + len(job.items) or job.done)
+                    items = job.items[position - job.first:]
+                    position += len(items)
+                    job.positions[follower] = position
+                    self._trim(job)
+                if not items:
+                    if job.error is not None:
+                        raise job.error
+                    return
+                yield from items
+        finally:
+            self._detach(job, follower)
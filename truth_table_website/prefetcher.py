@@ -0,0 +1,97 @@
+import threading
+import time
+
+
+# What a session is reading, and how far ahead of it its pages were generated
+class SessionPrefetch:
+    def __init__(self, expression, page_size):
+        self.expression = expression
+        self.page_size = page_size
+        self.next_start = 0
+        self.target = 0
+        self.last_visit = time.monotonic()
+        self.cancelled = threading.Event()
+        self.worker = None
+
+
+# Generates the pages after the ones a session reads in the background, so a session scrolling
+# steadily reads them from the cache. Pages are only generated while the session keeps reading:
+# one idle for idle_timeout seconds, reading another expression or released stops its prefetch.
+# fetch(session_id, expression, start, end) generates a page into the cache and returns its number
+# of rows, the prefetch stopping at the first short page. Pages are only generated while can_run().
+class Prefetcher:
+    def __init__(self, fetch, pages_ahead, idle_timeout, can_run=lambda: True):
+        self.fetch = fetch
+        self.pages_ahead = pages_ahead
+        self.idle_timeout = idle_timeout
+        self.can_run = can_run
+        self.lock = threading.Lock()
+        self.sessions = {}  # session id -> SessionPrefetch
+        self.prefetched = 0
+        self.cancelled = 0
+
+    # Function to record that a session read the rows [start, end) of an expression,
+    # generating the next pages_ahead pages of the same size in the background
+    def visit(self, session_id, expression, start, end):
+        if session_id is None or end <= start or self.pages_ahead <= 0:
+            return
+        with self.lock:
+            self._forget_idle_sessions()
+            state = self.sessions.get(session_id)
+            if state is None or state.expression != expression or state.page_size != end - start:
+                if state is not None:
+                    self._cancel(state)
+                state = self.sessions[session_id] = SessionPrefetch(expression, end - start)
+            state.last_visit = time.monotonic()
+            state.next_start = max(state.next_start, end)
+            state.target = end + self.pages_ahead * state.page_size
+            if state.worker is None:
+                state.worker = threading.Thread(target=self._prefetch, args=(session_id, state), daemon=True)
+                state.worker.start()
+
+    # Function to stop the prefetch of a session, when it leaves
+    def release_session(self, session_id):
+        with self.lock:
+            state = self.sessions.pop(session_id, None)
+            if state is not None:
+                self._cancel(state)
+
+    # Function to get the number of pages prefetched and of prefetches cancelled
+    def metrics(self):
+        with self.lock:
+            return {
+                'sessions': len(self.sessions),
+                'prefetching': sum(state.worker is not None for state in self.sessions.values()),
+                'pages_prefetched': self.prefetched,
+                'cancelled': self.cancelled,
+            }
+
+    def _prefetch(self, session_id, state):
+        while True:
+            with self.lock:
+                if time.monotonic() - state.last_visit > self.idle_timeout:
+                    self._cancel(state)
+                if state.cancelled.is_set() or state.next_start >= state.target or not self.can_run():
+                    state.worker = None
+                    return
+                start = state.next_start
+                state.next_start += state.page_size
+            try:
+                rows = self.fetch(session_id, state.expression, start, start + state.page_size)
+            except Exception:
+                rows = 0
+            with self.lock:
+                self.prefetched += 1
+                if rows < state.page_size:
+                    # Past the last page, or generation failed: nothing more to prefetch
+                    state.target = state.next_start
+
+    def _cancel(self, state):
+        if not state.cancelled.is_set():
+            state.cancelled.set()
+            self.cancelled += 1
+
+    def _forget_idle_sessions(self):
+        deadline = time.monotonic() - self.idle_timeout
+        for session_id in [session_id for session_id, state in self.sessions.items() if state.last_visit < deadline]:
+            self._cancel(self.sessions.pop(session_id))
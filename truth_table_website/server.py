@@ -1,20 +1,117 @@
-from flask import Flask, request, render_template, jsonify, session
+from flask import Flask, request, render_template, jsonify, session, Response, stream_with_context
 import subprocess
 import os
-import glob
 import shutil  
 import atexit  
+import itertools
+import uuid
+import json
+
+from cache_manager import CacheManager
+from job_coordinator import JobCoordinator, JobRejected
+from prefetcher import Prefetcher
 
 app = Flask(__name__)
 
 CACHE_DIR = 'cache_files'
-os.makedirs(CACHE_DIR, exist_ok=True)
-
-# Function to get the file path based on the session id
-def get_cache_file_path(session_id):
-    # Generate the cache file name based on the session id
-    return os.path.join(CACHE_DIR, f'{session_id}.cache')
-
+# Bytes of true rows files kept on disk, and seconds an unread file is kept
+CACHE_MAX_BYTES = int(os.environ.get('CACHE_MAX_BYTES', 2 * 1024 ** 3))
+CACHE_TTL = int(os.environ.get('CACHE_TTL', 30 * 60))
+cache = CacheManager(CACHE_DIR, CACHE_MAX_BYTES, CACHE_TTL)
+# Runs of the binary at once, each one using every core, and runs of other requests left waiting
+# for one before new ones are turned away. Identical requests in flight share a single run.
+JOB_WORKERS = int(os.environ.get('JOB_WORKERS', 2))
+JOB_QUEUE = int(os.environ.get('JOB_QUEUE', 32))
+# Frames of a streamed page held for its slowest request, requests coming once the first frame
+# is gone generate the page again
+JOB_WINDOW = int(os.environ.get('JOB_WINDOW', 64))
+jobs = JobCoordinator(JOB_WORKERS, JOB_QUEUE, JOB_WINDOW)
+
+# Formats of truth_table segments other than the default JSON array of lines
+FORMAT_MIMETYPES = {'csv': 'text/csv', 'markdown': 'text/markdown'}
+
+# Lines of a true rows page, and the cache key prefix of the index of a true rows file
+PAGE_LINES = 100
+INDEX_KEY = 'index:'
+
+# Function to write the true rows file of an expression, caching the index of its true rows too
+def write_true_rows(expression, path):
+    index_path = os.path.join(CACHE_DIR, f'{uuid.uuid4().hex}.index.tmp')
+    try:
+        subprocess.run(['./website_binary_ttable', '--true-rows', expression, path, index_path], text=True)
+        if os.path.exists(index_path):
+            cache.populate(INDEX_KEY + expression, lambda index_cache_path: os.replace(index_path, index_cache_path)).close()
+    finally:
+        if os.path.exists(index_path):
+            os.remove(index_path)
+
+# Function to cache and open the true rows file of an expression, written once for every session asking for it meanwhile
+def populate_true_rows(expression, session_id):
+    jobs.run(('true_rows', expression), lambda: cache.populate(expression, lambda path: write_true_rows(expression, path)).close())
+    file = cache.open(expression, session_id)
+    if file is None:
+        raise RuntimeError('The true rows file was evicted before it could be read')
+    return file
+
+# Function to read the lines [start, start + PAGE_LINES) of a true rows file,
+# going straight to the first one since every row has the same length
+def read_page(file, start):
+    header = [file.readline(), file.readline()]
+    rows_offset = file.tell()
+    row_length = len(file.readline())
+    lines = [line for line in header[start:] if line]
+    file.seek(rows_offset + max(start - 2, 0) * row_length)
+    lines += itertools.islice(file, PAGE_LINES - len(lines))
+    return [line.decode() for line in lines]
+
+# Function to generate the lines [start, start + PAGE_LINES) of a true rows file that is no longer
+# cached, from the index of its true rows, which only generates the segments holding them
+def generate_page(expression, index, start):
+    command = ['./website_binary_ttable', '--true-page', expression, f'/dev/fd/{index.fileno()}', str(start), str(PAGE_LINES)]
+    result = subprocess.run(command, capture_output=True, text=True, pass_fds=(index.fileno(),))
+    return result.stdout.splitlines(keepends=True)
+
+# Function to get the cache and job key of the rows [start, end) of the truth table of an expression
+def page_key(expression, start, end):
+    return f'page:{start}:{end}:{expression}'
+
+# Rows of the largest page cached, bigger ones are only streamed
+CACHE_PAGE_ROWS = int(os.environ.get('CACHE_PAGE_ROWS', 1000))
+
+# Function to yield the frames of the rows [start, end) of the truth table of an expression,
+# writing them to the cache as they pass and caching the page once it has been generated
+def generate_table_page(expression, start, end, session_id):
+    command = ['./website_binary_ttable', '--stream', expression, str(start), str(end)]
+    key = page_key(expression, start, end)
+    file = cache.create(key) if end - start <= CACHE_PAGE_ROWS else None
+    try:
+        for frame in read_frames(subprocess.Popen(command, stdout=subprocess.PIPE)):
+            if file is not None:
+                file.write(frame)
+            yield frame
+        if file is not None:
+            cache.commit(key, file, session_id).close()
+    finally:
+        if file is not None:
+            cache.discard(file)
+
+# Function to generate a page of the truth table of an expression into the cache ahead of a session
+# reading it, merged with the session's request if it asks for the page meanwhile
+def prefetch_table_page(session_id, expression, start, end):
+    key = page_key(expression, start, end)
+    if end - start > CACHE_PAGE_ROWS:
+        # Pages too big to be cached can't be generated ahead
+        return 0
+    if cache.contains(key):
+        return end - start
+    rows = json.loads(b''.join(jobs.stream(key, lambda: generate_table_page(expression, start, end, session_id))))
+    return len(rows)
+
+# Pages of the truth table generated ahead of a session reading them, and seconds after its
+# last request a session stops being prefetched for. Pages are only prefetched on idle workers.
+PREFETCH_PAGES = int(os.environ.get('PREFETCH_PAGES', 3))
+PREFETCH_IDLE = int(os.environ.get('PREFETCH_IDLE', 30))
+prefetcher = Prefetcher(prefetch_table_page, PREFETCH_PAGES, PREFETCH_IDLE, jobs.has_idle_worker)
 
 # Function to delete the entire cache dir on unload
 def cleanup_cache():
@@ -30,23 +127,23 @@ def clear_cache():
     if not session_id:
         return jsonify({'error': 'No session ID provided'}), 400
     
-    # Find all cache files for the given session_id
-    # Given no bugs, should only be one
-    # Cache files should consist of the session id followed by cache
-    cache_files = glob.glob(os.path.join(CACHE_DIR, f'{session_id}*.cache'))
-
-    if not cache_files:
+    # Files other sessions read too are kept, the others are deleted
+    prefetcher.release_session(session_id)
+    if not cache.release_session(session_id):
         return jsonify({'error': 'No cache files found for the provided session ID'}), 404
-    
-    # Delete all found cache files
-    for cache_file in cache_files:
-        try:
-            os.remove(cache_file)
-        except OSError as e:
-            return jsonify({'error': f'Error deleting cache file: {str(e)}'}), 500
 
     return jsonify({'message': 'Cache cleared successfully'}), 200
 
+# Function to report the hit rate and occupancy of the cache
+@app.route('/cache_metrics', methods=['GET'])
+def cache_metrics():
+    return jsonify(cache.metrics())
+
+# Function to report the load of the generation jobs and the pages prefetched
+@app.route('/job_metrics', methods=['GET'])
+def job_metrics():
+    return jsonify({**jobs.metrics(), 'prefetch': prefetcher.metrics()})
+
 # Function to render the webpage whenever a request occurs
 @app.route('/', methods=['GET', 'POST'])
 def index():
@@ -59,67 +156,77 @@ def generate_rows():
     start = int(request.args.get('start', 0))
     end = int(request.args.get('end', 100))
     mode = request.args.get('mode', 'truth_table')  # Default to 'truth_table'
+    output_format = request.args.get('format', 'json')  # csv and markdown for truth_table mode
     session_id = request.args.get('session_id')
-    cache_file_path = get_cache_file_path(session_id)
 
     
     if mode == 'true_rows':
         # This will be the case when calls are made from scrolling.
-        # Simply read until we get 100 1 lines from the file
-        if os.path.exists(cache_file_path):
-            # Reading from existing cache file
-            extracted_lines = []
-            current_line_number = 0
-
-            with open(cache_file_path, 'r') as file:
-                for line in file:
-                    if current_line_number < start:
-                        current_line_number += 1
-                        continue
-
-                    if len(extracted_lines) >= 100:
-                        break
-                    current_line_number += 1
-                    extracted_lines.append(line)
-
-            return jsonify(extracted_lines)
-
-        else:
-            # Run the command and create the cache file
-            command = ['./website_binary_ttable', expression, cache_file_path]
-            try:
-                # Run truth table to write to the cache file 
-                subprocess.run(command, text=True)
-                extracted_lines = []
-                current_line_number = 0
-                with open(cache_file_path, 'r') as file:
-                    for line in file:
-                       
-                        extracted_lines.append(line)
-                        current_line_number += 1
-                        if current_line_number == 100:
-                            break
-                return jsonify(extracted_lines)
-
-            except subprocess.CalledProcessError as e:
-                return jsonify({'error': str(e)}), 500
-            except Exception as e:
-                return jsonify({'error': str(e)}), 500
-        
+        # The true rows file of the expression is shared by every session
+        try:
+            file = cache.open(expression, session_id)
+            if file is None:
+                index = cache.open(INDEX_KEY + expression, session_id)
+                if index is not None:
+                    with index:
+                        return jsonify(jobs.run(('true_page', expression, start), lambda: generate_page(expression, index, start)))
+                # Run truth table to write the file, renamed into the cache once complete
+                file = populate_true_rows(expression, session_id)
+            with file:
+                return jsonify(read_page(file, start))
+        except JobRejected as e:
+            return busy(e)
+        except Exception as e:
+            return jsonify({'error': str(e)}), 500
 
-    elif mode == 'truth_table':
-        command = ['./website_binary_ttable', expression, str(start), str(end)]
+    elif mode == 'truth_table' and output_format in FORMAT_MIMETYPES:
+        # The binary writes the table in the format itself, header included at row 0
+        command = ['./website_binary_ttable', '--format', output_format, expression, str(start), str(end)]
         try:
-            # When I only need to generate a segment, no need for caching.
-            # Just capture the output from stdout
-            result = subprocess.run(command, capture_output=True, text=True)
-            ttable_output = result.stdout.splitlines()
-            return jsonify(ttable_output)
-        except subprocess.CalledProcessError as e:
+            result = jobs.run((mode, output_format, expression, start, end), lambda: subprocess.run(command, capture_output=True, text=True).stdout)
+            return Response(result, mimetype=FORMAT_MIMETYPES[output_format])
+        except JobRejected as e:
+            return busy(e)
+        except Exception as e:
             return jsonify({'error': str(e)}), 500
+
+    elif mode == 'truth_table':
+        key = page_key(expression, start, end)
+        try:
+            file = cache.open(key, session_id)
+            if file is not None:
+                with file:
+                    page = file.read()
+                prefetcher.visit(session_id, expression, start, end)
+                return Response(page, mimetype='application/json')
+            # The binary writes the JSON array in frames as the rows are generated,
+            # which are forwarded as they come with chunked transfer encoding
+            frames = jobs.stream(key, lambda: generate_table_page(expression, start, end, session_id))
+            # The next pages are generated while this one is read
+            prefetcher.visit(session_id, expression, start, end)
+            return Response(stream_with_context(frames), mimetype='application/json')
+        except JobRejected as e:
+            return busy(e)
         except Exception as e:
             return jsonify({'error': str(e)}), 500
 
+# Function to turn a request away while the job queue is full, telling the client when to try again
+def busy(rejection):
+    return jsonify({'error': str(rejection)}), 503, {'Retry-After': '1'}
+
+# Function to yield the frames of the binary's --stream mode, a line with the size of
+# the frame then its bytes, until the empty frame ending the stream
+def read_frames(process):
+    try:
+        while True:
+            size = process.stdout.readline()
+            if not size or int(size) == 0:
+                break
+            yield process.stdout.read(int(size))
+    finally:
+        process.stdout.close()
+        process.wait()
+
 if __name__ == '__main__':
 
     app.run(host="0.0.0.0", port=5000)
\ No newline at end of file